@@ -0,0 +1,36 @@
+﻿using System;
+using BenchmarkDotNet.Attributes;
+using RealtimePlottingApp.Services.CAN;
+using RealtimePlottingApp.Services.ConfigParsers;
+
+namespace RealtimePlottingApp.Benchmarks;
+
+/// <summary>
+/// Extraction of variables from CAN payloads: parsing the mask per frame (ConfigParser.ParseCanDataMask)
+/// against the plan compiled once per connection that CanDataChannel uses.
+/// </summary>
+[MemoryDiagnoser]
+public class CanMaskBenchmarks
+{
+    private const string Mask = "11:11:22:2_:_3:33:44:44";
+    private readonly ConfigParser _parser = new();
+    private readonly byte[] _data = [0x12, 0x34, 0x56, 0x78, 0x9A, 0xBC, 0xDE, 0xF0];
+    private readonly double[] _values = new double[4];
+    private CanPayloadPlan _plan = null!;
+
+    [GlobalSetup]
+    public void Setup()
+    {
+        _plan = _parser.CompileCanDataMask(Mask, 0);
+    }
+
+    [Benchmark(Baseline = true)]
+    public int ParsePerFrame() => _parser.ParseCanDataMask(Mask, _data).Count;
+
+    [Benchmark]
+    public double CompiledPlan()
+    {
+        _plan.TryDecode(_data, _values);
+        return _values[3];
+    }
+}
\ No newline at end of file
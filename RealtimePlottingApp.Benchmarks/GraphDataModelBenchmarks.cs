@@ -0,0 +1,70 @@
+﻿using System.Threading;
+using BenchmarkDotNet.Attributes;
+using RealtimePlottingApp.Models;
+
+namespace RealtimePlottingApp.Benchmarks;
+
+/// <summary>
+/// Storing samples in the graph data model (GraphDataModel.AddPoint), with and without bounded retention,
+/// and with a reader taking snapshots of it meanwhile, which must not slow ingest down.
+/// </summary>
+[MemoryDiagnoser]
+public class GraphDataModelBenchmarks
+{
+    private const int Samples = 1_000_000;
+    private GraphDataModel _model = null!;
+
+    [Params(1, 4)]
+    public int Variables { get; set; }
+
+    [Params(false, true)]
+    public bool BoundedRetention { get; set; }
+
+    [IterationSetup]
+    public void Setup()
+    {
+        _model = new GraphDataModel(Variables)
+        {
+            Retention = BoundedRetention ? RetentionPolicy.LastSamples(100_000) : RetentionPolicy.Unlimited
+        };
+    }
+
+    // Adds a million interleaved samples, committing in batches like the data channels do.
+    [Benchmark(OperationsPerInvoke = Samples)]
+    public void AddPoint()
+    {
+        lock (_model)
+        {
+            for (uint i = 0; i < Samples; i++)
+            {
+                _model.AddPoint((int)(i % (uint)Variables), i / (uint)Variables, i & 0xFF);
+                if ((i & 255) == 255)
+                    _model.CommitSamples();
+            }
+        }
+    }
+
+    // Same as AddPoint, while another thread reads the newest samples of every snapshot like a plot would.
+    [Benchmark(OperationsPerInvoke = Samples)]
+    public long AddPointWhileReading()
+    {
+        long read = 0;
+        bool done = false;
+        Thread reader = new(() =>
+        {
+            while (!Volatile.Read(ref done))
+            {
+                foreach (ColumnSnapshot column in _model.Snapshot().Columns)
+                {
+                    if (column.Count > 0)
+                        read += column.LastY;
+                }
+            }
+        });
+        reader.Start();
+        AddPoint();
+        Volatile.Write(ref done, true);
+        reader.Join();
+        return read;
+    }
+}
\ No newline at end of file
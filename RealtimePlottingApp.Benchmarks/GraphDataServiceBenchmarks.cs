@@ -0,0 +1,63 @@
+﻿using System.Collections.Generic;
+using BenchmarkDotNet.Attributes;
+using RealtimePlottingApp.Models;
+using RealtimePlottingApp.Services.Plotting.LineGraph;
+
+namespace RealtimePlottingApp.Benchmarks;
+
+/// <summary>
+/// Extraction of the per-variable series to plot each frame (GraphDataService.GetSubData).
+/// The series are filled from the per-variable columns, which is what replaced the de-interleaving
+/// that PlotUiService used to do, so this covers that path as well.
+/// </summary>
+[MemoryDiagnoser]
+public class GraphDataServiceBenchmarks
+{
+    private GraphDataService _service = null!;
+    private TriggerPoint _trigger;
+
+    [Params(100_000, 10_000_000)]
+    public int SamplesPerVariable { get; set; }
+
+    [Params(1, 4)]
+    public int Variables { get; set; }
+
+    [GlobalSetup]
+    public void Setup()
+    {
+        GraphDataModel model = new(Variables);
+        for (uint i = 0; i < SamplesPerVariable; i++)
+            for (int v = 0; v < Variables; v++)
+                model.AddPoint(v, i, (i * 7 + (uint)v) % 1000);
+
+        _service = new GraphDataService(model) { PixelWidth = 1000, WindowWidth = 10 };
+        _trigger = new TriggerPoint(0, SamplesPerVariable / 2);
+    }
+
+    // The sliding window following the newest data.
+    [Benchmark]
+    public int Window()
+    {
+        _service.SetFullHistory(false);
+        _service.GetSubData(out IReadOnlyList<PlotSeries> series, out _, null, null, TriggerMode.Normal_Trigger);
+        return series[0].Count;
+    }
+
+    // The window centred on a trigger.
+    [Benchmark]
+    public int TriggerWindow()
+    {
+        _service.SetFullHistory(false);
+        _service.GetSubData(out IReadOnlyList<PlotSeries> series, out _, _trigger, _trigger, TriggerMode.Normal_Trigger);
+        return series[0].Count;
+    }
+
+    // The entire history, decimated to the plot's width.
+    [Benchmark]
+    public int FullHistory()
+    {
+        _service.SetFullHistory(true);
+        _service.GetSubData(out IReadOnlyList<PlotSeries> series, out _, null, null, TriggerMode.Normal_Trigger);
+        return series[0].Count;
+    }
+}
\ No newline at end of file
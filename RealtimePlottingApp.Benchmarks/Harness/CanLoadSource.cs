@@ -0,0 +1,77 @@
+﻿using System;
+using System.Buffers.Binary;
+using System.Collections.Generic;
+using RealtimePlottingApp.Models;
+using RealtimePlottingApp.Services.CAN;
+using RealtimePlottingApp.Services.ConfigParsers;
+using RealtimePlottingApp.Services.DataChannels;
+
+namespace RealtimePlottingApp.Benchmarks.Harness;
+
+/// <summary>
+/// Sends CAN frames of 16-bit variables on a virtual CAN interface, received by the application's
+/// SocketCanBus and CanDataChannel. Optionally interleaves frames of other IDs, which should be filtered out.
+/// </summary>
+/// <remarks>
+/// Requires a vcan interface: sudo ip link add dev vcan0 type vcan && sudo ip link set up vcan0
+/// </remarks>
+internal sealed class CanLoadSource : ILoadSource
+{
+    private const uint CanId = 0x100;
+    private const uint NoiseCanId = 0x200;
+
+    private readonly LoadOptions _options;
+    private readonly SocketCanBus _sender = new();
+    private readonly CanDataChannel _channel;
+    private readonly byte[] _frame;
+    private readonly byte[] _noise = new byte[8];
+    private uint _sequence;
+
+    public CanLoadSource(LoadOptions options, GraphDataModel model)
+    {
+        _options = options;
+        _frame = new byte[options.Variables * 2];
+
+        // Two bytes per variable: "11:11:22:22:..."
+        List<string> bytes = [];
+        for (int v = 1; v <= options.Variables; v++)
+            bytes.AddRange([$"{v}{v}", $"{v}{v}"]);
+        Dictionary<uint, CanPayloadPlan> routes = new ConfigParser().ParseCanRoutes((int)CanId, string.Join(':', bytes));
+
+        _channel = new CanDataChannel(new SocketCanBus(), options.CanInterface, null, routes, model);
+    }
+
+    // The socket's receive queue overflowing isn't reported, drops show up as samples not received.
+    public long Dropped => 0;
+
+    public void Connect()
+    {
+        _channel.Connect();
+        _sender.Connect(_options.CanInterface, null);
+    }
+
+    public long Send(long samples)
+    {
+        long sent = 0;
+        while (sent < samples)
+        {
+            for (int v = 0; v < _options.Variables; v++)
+                BinaryPrimitives.WriteUInt16BigEndian(_frame.AsSpan(v * 2), (ushort)((_sequence + v * 250) % 1000));
+            _sequence++;
+
+            if (_sender.SendMessage(CanId, _frame) == 0)
+                break; // Interface gone or buffer full, let the pacing catch up
+            sent += _options.Variables;
+
+            for (int n = 0; n < _options.NoiseFrames; n++)
+                _sender.SendMessage(NoiseCanId + (uint)n, _noise);
+        }
+        return sent;
+    }
+
+    public void Dispose()
+    {
+        _channel.Disconnect();
+        _sender.Disconnect();
+    }
+}
\ No newline at end of file
@@ -0,0 +1,19 @@
+﻿using System;
+
+namespace RealtimePlottingApp.Benchmarks.Harness;
+
+/// <summary>
+/// One end of a loopback link: generates samples like a device would, while the application's
+/// data channel on the other end stores them in the graph data model.
+/// </summary>
+internal interface ILoadSource : IDisposable
+{
+    // Connects the application's data channel, returns once the link is ready for data.
+    void Connect();
+
+    // Sends the given number of samples, returns how many were sent.
+    long Send(long samples);
+
+    // Samples which the application's receiving end knowingly dropped.
+    long Dropped { get; }
+}
\ No newline at end of file
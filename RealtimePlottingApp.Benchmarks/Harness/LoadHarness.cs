@@ -0,0 +1,149 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.Threading;
+using RealtimePlottingApp.Models;
+using RealtimePlottingApp.Services.Plotting.LineGraph;
+
+namespace RealtimePlottingApp.Benchmarks.Harness;
+
+/// <summary>
+/// End-to-end load test: drives the real data channels over a loopback link at a configured rate,
+/// while a render loop extracts plot data like the UI timer does, and reports once per second
+/// the sustained ingest rate, render times, and samples dropped.
+/// </summary>
+/// <remarks>
+/// Usage: load uart|can [--rate samples/s] [--duration s] [--fps n] [--vars 1-4] [--noise n]
+///                      [--interface vcan0] [--baud n]
+/// </remarks>
+internal static class LoadHarness
+{
+    public static int Run(string[] args)
+    {
+        if (args.Length == 0 || (args[0] != "uart" && args[0] != "can"))
+        {
+            Console.WriteLine("Usage: load uart|can [--rate samples/s] [--duration s] [--fps n] [--vars 1-4] " +
+                              "[--noise n] [--interface vcan0] [--baud n]");
+            return 1;
+        }
+
+        LoadOptions options = LoadOptions.Parse(args.AsSpan(1));
+        GraphDataModel model = new(options.Variables)
+        {
+            Retention = RetentionPolicy.LastSeconds(10) // Keep memory flat however long the run
+        };
+
+        try
+        {
+            using ILoadSource source = args[0] == "can"
+                ? new CanLoadSource(options, model)
+                : new UartLoadSource(options, model);
+            source.Connect();
+            return RunLoad(options, model, source);
+        }
+        catch (Exception e)
+        {
+            Console.WriteLine($"Load test failed: {e.Message}");
+            return 1;
+        }
+    }
+
+    private static int RunLoad(LoadOptions options, GraphDataModel model, ILoadSource source)
+    {
+        using CancellationTokenSource stop = new();
+        RenderLoop render = new(model, options.Fps);
+        Thread renderThread = new(() => render.Run(stop.Token)) { IsBackground = true, Name = "Render" };
+        renderThread.Start();
+
+        Console.WriteLine($"Offering {options.Rate:N0} samples/s for {options.Duration.TotalSeconds:N0} s, " +
+                          $"rendering at {options.Fps} fps");
+        Console.WriteLine("  time       sent/s   received/s    dropped   frame avg   frame max");
+
+        Stopwatch clock = Stopwatch.StartNew();
+        TimeSpan nextReport = TimeSpan.FromSeconds(1);
+        long sent = 0, lastSent = 0, lastReceived = 0;
+
+        while (clock.Elapsed < options.Duration)
+        {
+            // Send whatever is due by now, so the offered rate holds even if a send was late.
+            long due = (long)(clock.Elapsed.TotalSeconds * options.Rate);
+            if (due > sent)
+                sent += source.Send(due - sent);
+            else
+                Thread.Sleep(1);
+
+            if (clock.Elapsed >= nextReport)
+            {
+                long received = ReceivedSamples(model);
+                (double avgMs, double maxMs) = render.TakeFrameTimes();
+                Console.WriteLine($"{nextReport.TotalSeconds,5:N0} s {sent - lastSent,12:N0} {received - lastReceived,12:N0} " +
+                                  $"{source.Dropped,10:N0} {avgMs,8:N2} ms {maxMs,8:N2} ms");
+                lastSent = sent;
+                lastReceived = received;
+                nextReport += TimeSpan.FromSeconds(1);
+            }
+        }
+
+        // Give the receiving end a moment to drain what is still in flight.
+        Thread.Sleep(500);
+        stop.Cancel();
+        renderThread.Join();
+
+        long total = ReceivedSamples(model);
+        double seconds = options.Duration.TotalSeconds;
+        Console.WriteLine();
+        Console.WriteLine($"Sent {sent:N0} samples ({sent / seconds:N0}/s), received {total:N0} ({total / seconds:N0}/s)");
+        Console.WriteLine($"Lost {sent - total:N0} samples, of which {source.Dropped:N0} were reported dropped by the receiver");
+        return sent == total ? 0 : 2;
+    }
+
+    // Samples stored so far, including any that retention has discarded since.
+    private static long ReceivedSamples(GraphDataModel model)
+    {
+        long samples = 0;
+        foreach (ColumnSnapshot column in model.Snapshot().Columns)
+            samples += column.EndIndex;
+        return samples;
+    }
+
+    // Extracts the plot data at a fixed rate like the UI's update timer, timing each frame.
+    private sealed class RenderLoop(GraphDataModel model, int fps)
+    {
+        private readonly GraphDataService _service = new(model) { PixelWidth = 1000, WindowWidth = 5 };
+        private double _totalMs, _maxMs;
+        private int _frames;
+
+        public void Run(CancellationToken stop)
+        {
+            if (fps <= 0)
+                return;
+
+            TimeSpan interval = TimeSpan.FromSeconds(1.0 / fps);
+            while (!stop.WaitHandle.WaitOne(interval))
+            {
+                long start = Stopwatch.GetTimestamp();
+                _service.GetSubData(out IReadOnlyList<PlotSeries> _, out _, null, null, TriggerMode.Normal_Trigger);
+                double ms = Stopwatch.GetElapsedTime(start).TotalMilliseconds;
+
+                lock (this)
+                {
+                    _totalMs += ms;
+                    _maxMs = Math.Max(_maxMs, ms);
+                    _frames++;
+                }
+            }
+        }
+
+        // Average and longest frame since the last call.
+        public (double AvgMs, double MaxMs) TakeFrameTimes()
+        {
+            lock (this)
+            {
+                (double, double) times = (_frames > 0 ? _totalMs / _frames : 0, _maxMs);
+                _totalMs = _maxMs = 0;
+                _frames = 0;
+                return times;
+            }
+        }
+    }
+}
\ No newline at end of file
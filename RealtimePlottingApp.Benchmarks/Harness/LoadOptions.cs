@@ -0,0 +1,44 @@
+﻿using System;
+using System.Globalization;
+
+namespace RealtimePlottingApp.Benchmarks.Harness;
+
+/// <summary>
+/// Options of a load harness run, parsed from "--name value" arguments.
+/// </summary>
+internal sealed class LoadOptions
+{
+    // Samples offered per second in total, across all variables.
+    public double Rate { get; private set; } = 100_000;
+    // How long to keep the load up.
+    public TimeSpan Duration { get; private set; } = TimeSpan.FromSeconds(10);
+    // Rate the simulated render loop extracts plot data at, 0 disables it.
+    public int Fps { get; private set; } = 30;
+    // Variables per CAN or UART frame (unframed UART carries one).
+    public int Variables { get; private set; } = 4;
+    // Frames of unrelated CAN IDs sent per decoded frame, to exercise ID filtering.
+    public int NoiseFrames { get; private set; }
+    public string CanInterface { get; private set; } = "vcan0";
+    public int BaudRate { get; private set; } = 115200;
+
+    public static LoadOptions Parse(ReadOnlySpan<string> args)
+    {
+        LoadOptions options = new();
+        for (int i = 0; i + 1 < args.Length; i += 2)
+        {
+            string value = args[i + 1];
+            switch (args[i])
+            {
+                case "--rate": options.Rate = double.Parse(value, CultureInfo.InvariantCulture); break;
+                case "--duration": options.Duration = TimeSpan.FromSeconds(double.Parse(value, CultureInfo.InvariantCulture)); break;
+                case "--fps": options.Fps = int.Parse(value); break;
+                case "--vars": options.Variables = Math.Clamp(int.Parse(value), 1, 4); break;
+                case "--noise": options.NoiseFrames = int.Parse(value); break;
+                case "--interface": options.CanInterface = value; break;
+                case "--baud": options.BaudRate = int.Parse(value); break;
+                default: throw new ArgumentException($"Unknown option {args[i]}");
+            }
+        }
+        return options;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,96 @@
+﻿using System;
+using System.ComponentModel;
+using System.IO;
+using System.Runtime.InteropServices;
+using Microsoft.Win32.SafeHandles;
+
+namespace RealtimePlottingApp.Benchmarks.Harness;
+
+/// <summary>
+/// A Linux pseudo terminal pair, used as a UART loopback: the harness plays the microcontroller on the
+/// master side, while the application's serial reader opens the slave device like any serial port.
+/// </summary>
+internal sealed class PseudoTerminal : IDisposable
+{
+    private const int O_RDWR = 2;
+    private const int O_NOCTTY = 0x100;
+    private const short POLLIN = 1;
+    private const int EINTR = 4;
+
+    private readonly int _fd;
+
+    [StructLayout(LayoutKind.Sequential)]
+    private struct PollFd
+    {
+        public int Fd;
+        public short Events;
+        public short Revents;
+    }
+
+    [DllImport("libc", SetLastError = true)]
+    private static extern int posix_openpt(int flags);
+
+    [DllImport("libc", SetLastError = true)]
+    private static extern int grantpt(int fd);
+
+    [DllImport("libc", SetLastError = true)]
+    private static extern int unlockpt(int fd);
+
+    [DllImport("libc", SetLastError = true)]
+    private static extern IntPtr ptsname(int fd);
+
+    [DllImport("libc", SetLastError = true)]
+    private static extern int poll(ref PollFd fds, nuint nfds, int timeout);
+
+    /// <summary>
+    /// Path of the slave device, to be opened as the serial port.
+    /// </summary>
+    public string SlavePath { get; }
+
+    /// <summary>
+    /// Stream of the master side: what is written here is read from the slave, and vice versa.
+    /// </summary>
+    public FileStream Master { get; }
+
+    public PseudoTerminal()
+    {
+        int fd = posix_openpt(O_RDWR | O_NOCTTY);
+        if (fd < 0)
+            throw new Win32Exception(Marshal.GetLastWin32Error(), "posix_openpt failed");
+
+        SafeFileHandle handle = new(fd, ownsHandle: true);
+        if (grantpt(fd) != 0 || unlockpt(fd) != 0)
+        {
+            int error = Marshal.GetLastWin32Error();
+            handle.Dispose();
+            throw new Win32Exception(error, "Failed to unlock the pseudo terminal");
+        }
+
+        SlavePath = Marshal.PtrToStringAnsi(ptsname(fd)) ?? throw new IOException("ptsname failed");
+        Master = new FileStream(handle, FileAccess.ReadWrite, bufferSize: 0);
+        _fd = fd;
+    }
+
+    /// <summary>
+    /// Waits until the master side has bytes to read, so that reading it won't block.
+    /// </summary>
+    /// <returns>False if nothing was received within the timeout.</returns>
+    public bool WaitForInput(TimeSpan timeout)
+    {
+        PollFd pollFd = new() { Fd = _fd, Events = POLLIN };
+        int result;
+        do
+        {
+            result = poll(ref pollFd, 1, (int)Math.Ceiling(timeout.TotalMilliseconds));
+        } while (result < 0 && Marshal.GetLastWin32Error() == EINTR);
+
+        if (result < 0)
+            throw new Win32Exception(Marshal.GetLastWin32Error(), "poll failed");
+        return result > 0;
+    }
+
+    public void Dispose()
+    {
+        Master.Dispose();
+    }
+}
\ No newline at end of file
@@ -0,0 +1,112 @@
+﻿using System;
+using System.Buffers.Binary;
+using System.Diagnostics;
+using System.IO;
+using RealtimePlottingApp.Models;
+using RealtimePlottingApp.Services.ConfigParsers;
+using RealtimePlottingApp.Services.DataChannels;
+using RealtimePlottingApp.Services.UART;
+
+namespace RealtimePlottingApp.Benchmarks.Harness;
+
+/// <summary>
+/// Plays a microcontroller streaming 16-bit values into a pseudo terminal, read by the application's
+/// UARTSerialReader and UartDataChannel. Sends frames of all variables if the reader asks for them,
+/// unframed packages of one variable otherwise.
+/// </summary>
+internal sealed class UartLoadSource : ILoadSource
+{
+    private const int DataBytes = 2; // UART_PAYLOAD_16
+    private const int PackageSize = DataBytes + 1; // Followed by an 8-bit timestamp
+    private static readonly TimeSpan StartTimeout = TimeSpan.FromSeconds(5);
+
+    private readonly PseudoTerminal _pty = new();
+    private readonly UARTSerialReader _reader = new();
+    private readonly UartDataChannel _channel;
+    private readonly int _variables;
+    private readonly byte[] _buffer = new byte[UARTFrameFormat.MaxFrameSize * 1024];
+    private bool _framed;
+    private uint _sequence;
+
+    public UartLoadSource(LoadOptions options, GraphDataModel model)
+    {
+        _variables = options.Variables;
+        _channel = new UartDataChannel(_reader, _pty.SlavePath, options.BaudRate,
+            UARTDataPayloadSize.UART_PAYLOAD_16, ConfigParser.DefaultUartTickRate, model);
+    }
+
+    // Approximated from the bytes dropped, in samples.
+    public long Dropped => (long)(_reader.DroppedBytes / BytesPerSample);
+
+    private double BytesPerSample =>
+        _framed ? (double)UARTFrameFormat.FrameSize(_variables, DataBytes, 2) / _variables : PackageSize;
+
+    public void Connect()
+    {
+        _channel.Connect();
+
+        // Wait for the start byte, like the microcontroller does before streaming. The terminal is
+        // polled before every read, so a reader that never sends it can't block the harness.
+        Stopwatch waited = Stopwatch.StartNew();
+        byte[] received = new byte[1];
+        do
+        {
+            TimeSpan remaining = StartTimeout - waited.Elapsed;
+            if (remaining <= TimeSpan.Zero || !_pty.WaitForInput(remaining))
+                throw new TimeoutException("The serial reader did not send its start byte.");
+            if (_pty.Master.Read(received, 0, 1) != 1)
+                throw new EndOfStreamException("The serial reader closed the terminal.");
+        } while (received[0] != (byte)'S' && received[0] != (byte)'F');
+        _framed = received[0] == (byte)'F';
+    }
+
+    public long Send(long samples)
+    {
+        long sent = 0;
+        while (sent < samples)
+        {
+            // A triangle wave per variable, with the timestamp counting up and wrapping around.
+            int length = 0;
+            for (int i = 0; i < 1024 && sent < samples; i++, _sequence++)
+            {
+                length += _framed ? WriteFrame(_buffer.AsSpan(length)) : WritePackage(_buffer.AsSpan(length));
+                sent += _framed ? _variables : 1;
+            }
+
+            // Blocks while the terminal's buffer is full, which is the back-pressure a real UART can't apply.
+            _pty.Master.Write(_buffer, 0, length);
+        }
+        return sent;
+    }
+
+    private int WritePackage(Span<byte> package)
+    {
+        BinaryPrimitives.WriteUInt16BigEndian(package, Triangle(_sequence));
+        package[DataBytes] = (byte)_sequence;
+        return PackageSize;
+    }
+
+    private int WriteFrame(Span<byte> frame)
+    {
+        int frameSize = UARTFrameFormat.FrameSize(_variables, DataBytes, 2);
+        frame[0] = UARTFrameFormat.Sync;
+        frame[1] = UARTFrameFormat.CreateHeader(_variables, DataBytes, 2);
+        BinaryPrimitives.WriteUInt16BigEndian(frame[2..], (ushort)_sequence);
+        for (int v = 0; v < _variables; v++)
+            BinaryPrimitives.WriteUInt16BigEndian(frame[(4 + v * DataBytes)..], Triangle(_sequence + (uint)v * 250));
+        frame[frameSize - 1] = UARTFrameFormat.Crc8(frame[..(frameSize - 1)]);
+        return frameSize;
+    }
+
+    private static ushort Triangle(uint sequence)
+    {
+        uint phase = sequence % 2000;
+        return (ushort)(phase < 1000 ? phase : 2000 - phase);
+    }
+
+    public void Dispose()
+    {
+        _channel.Disconnect();
+        _pty.Dispose();
+    }
+}
\ No newline at end of file
@@ -0,0 +1,22 @@
+﻿using System;
+using BenchmarkDotNet.Running;
+using RealtimePlottingApp.Benchmarks.Harness;
+
+namespace RealtimePlottingApp.Benchmarks;
+
+/// <summary>
+/// Entry point for the benchmarks.
+/// `dotnet run -c Release` lets you pick micro-benchmarks (BenchmarkDotNet arguments such as --filter work),
+/// `dotnet run -c Release -- load uart|can [options]` runs the end-to-end load harness instead.
+/// </summary>
+public static class Program
+{
+    public static int Main(string[] args)
+    {
+        if (args.Length > 0 && args[0] == "load")
+            return LoadHarness.Run(args[1..]);
+
+        BenchmarkSwitcher.FromAssembly(typeof(Program).Assembly).Run(args);
+        return 0;
+    }
+}
\ No newline at end of file
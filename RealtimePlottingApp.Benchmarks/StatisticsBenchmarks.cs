@@ -0,0 +1,56 @@
+﻿using BenchmarkDotNet.Attributes;
+using RealtimePlottingApp.Models;
+using RealtimePlottingApp.Services.Statistics;
+
+namespace RealtimePlottingApp.Benchmarks;
+
+/// <summary>
+/// Running statistics: the cost per ingested sample of keeping them up to date as samples are committed,
+/// and the cost of reading them per frame, which shouldn't depend on how long the session has been running.
+/// </summary>
+[MemoryDiagnoser]
+public class StatisticsBenchmarks
+{
+    private const int Samples = 1_000_000;
+    private const int BatchSize = 1024;
+    private GraphDataModel _model = null!;
+    private StatisticsService _statistics = null!;
+    private uint _x;
+
+    [Params(1_000_000, 10_000_000)]
+    public int History { get; set; }
+
+    [IterationSetup]
+    public void Setup()
+    {
+        _model = new GraphDataModel(1);
+        _statistics = new StatisticsService(_model);
+        _x = 0;
+        Ingest(History);
+    }
+
+    [Benchmark(OperationsPerInvoke = Samples)]
+    public void Ingest() => Ingest(Samples);
+
+    [Benchmark]
+    public double ReadWindowAndRange()
+    {
+        // What a block diagram frame and a trigger placement read.
+        VariableStatistics window = _statistics.GetWindow(0);
+        _statistics.TryGetRange(out double min, out double max);
+        return window.Percentile95 + min + max;
+    }
+
+    private void Ingest(int samples)
+    {
+        for (int batch = 0; batch < samples / BatchSize; batch++)
+        {
+            lock (_model)
+            {
+                for (int i = 0; i < BatchSize; i++, _x++)
+                    _model.AddPoint(0, _x, _x % 1000); // Sawtooth from 0 to 999
+                _model.CommitSamples();
+            }
+        }
+    }
+}
\ No newline at end of file
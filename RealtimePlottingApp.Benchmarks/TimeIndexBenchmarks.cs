@@ -0,0 +1,51 @@
+﻿using System;
+using BenchmarkDotNet.Attributes;
+using RealtimePlottingApp.Models;
+
+namespace RealtimePlottingApp.Benchmarks;
+
+/// <summary>
+/// Finding the samples of a time range [t0, t1] through a column's time index, which should stay
+/// logarithmic in the history's length. The samples are irregularly spaced 32-bit microsecond
+/// timestamps, whose wrap-around the model unwraps onto its 64-bit timebase.
+/// </summary>
+[MemoryDiagnoser]
+public class TimeIndexBenchmarks
+{
+    private const int Queries = 1024;
+    private const long RangeTicks = 10_000; // 10 ms
+    private readonly long[] _from = new long[Queries];
+    private ColumnSnapshot _column;
+
+    [Params(1_000_000, 10_000_000)]
+    public int History { get; set; }
+
+    [GlobalSetup]
+    public void Setup()
+    {
+        // Average spacing of 1 ms, so the longer history wraps the raw timestamps around.
+        GraphDataModel model = new(1) { XValBitSize = 32, TicksPerSecond = 1_000_000 };
+        Random random = new(1);
+        uint x = 0;
+        lock (model)
+        {
+            for (int i = 0; i < History; i++)
+                model.AddPoint(0, x += (uint)random.Next(1, 2000), (uint)i);
+            model.CommitSamples();
+        }
+
+        _column = model.Snapshot().Columns[0];
+        long first = _column.GetX(_column.FirstIndex);
+        for (int q = 0; q < Queries; q++)
+            _from[q] = first + random.NextInt64(_column.LastX - first);
+    }
+
+    [Benchmark(OperationsPerInvoke = Queries)]
+    public long FindRange()
+    {
+        long samples = 0;
+        foreach (long from in _from)
+            samples += _column.UpperBound(from + RangeTicks) - _column.LowerBound(from);
+        return samples;
+    }
+}
\ No newline at end of file
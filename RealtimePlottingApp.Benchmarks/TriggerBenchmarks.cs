@@ -0,0 +1,56 @@
+﻿using BenchmarkDotNet.Attributes;
+using RealtimePlottingApp.Models;
+using RealtimePlottingApp.Services.Plotting.LineGraph;
+using ScottPlot.Plottables;
+
+namespace RealtimePlottingApp.Benchmarks;
+
+/// <summary>
+/// Trigger detection, which runs as samples are committed, plus the per-frame TriggerService.CheckForTrigger.
+/// Measured per ingested sample, against a signal that never reaches the level (every sample is scanned)
+/// and one that crosses it regularly.
+/// </summary>
+[MemoryDiagnoser]
+public class TriggerBenchmarks
+{
+    private const int Samples = 1_000_000;
+    private const int BatchSize = 1024;
+    private GraphDataModel _model = null!;
+    private TriggerService _triggerService = null!;
+    private HorizontalLine _level = null!;
+    private uint _x;
+
+    [Params(false, true)]
+    public bool Crossing { get; set; }
+
+    [IterationSetup]
+    public void Setup()
+    {
+        _model = new GraphDataModel(1);
+        _triggerService = new TriggerService(_model) { Mode = TriggerMode.Normal_Trigger, PostTriggerSamples = 0 };
+        _level = new HorizontalLine { Y = Crossing ? 500 : 5000 };
+        _triggerService.CheckForTrigger(null, _level);
+        _triggerService.EnableTrigger();
+        _x = 0;
+    }
+
+    [Benchmark(OperationsPerInvoke = Samples)]
+    public int IngestAndCheck()
+    {
+        int triggers = 0;
+        for (int batch = 0; batch < Samples / BatchSize; batch++)
+        {
+            lock (_model)
+            {
+                for (int i = 0; i < BatchSize; i++, _x++)
+                    _model.AddPoint(0, _x, _x % 1000); // Sawtooth from 0 to 999
+                _model.CommitSamples();
+            }
+
+            // Once per batch, like a frame picking up the detected trigger.
+            if (_triggerService.CheckForTrigger(null, _level).HasValue)
+                triggers++;
+        }
+        return triggers;
+    }
+}
\ No newline at end of file
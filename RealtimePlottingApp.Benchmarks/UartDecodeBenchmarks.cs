@@ -0,0 +1,77 @@
+﻿using System;
+using System.Buffers.Binary;
+using BenchmarkDotNet.Attributes;
+using RealtimePlottingApp.Models;
+using RealtimePlottingApp.Services.UART;
+
+namespace RealtimePlottingApp.Benchmarks;
+
+/// <summary>
+/// Decoding of received serial bytes into timestamped packages (UARTSerialReader.ProcessReceiveBuffer),
+/// fed one read at a time like the serial port's read loop does. Unframed packages are random bytes,
+/// frames hold 4 variables each, with every 1000th frame corrupted to exercise resynchronization.
+/// </summary>
+[MemoryDiagnoser]
+public class UartDecodeBenchmarks
+{
+    private readonly UARTSerialReader _reader = new();
+    private byte[] _bytes = [];
+    private long _packages;
+
+    [Params(UARTDataPayloadSize.UART_PAYLOAD_8, UARTDataPayloadSize.UART_PAYLOAD_32)]
+    public UARTDataPayloadSize PayloadSize { get; set; }
+
+    // Bytes per read, a full read buffer is 4096.
+    [Params(64, 4096)]
+    public int ReadSize { get; set; }
+
+    [Params(false, true)]
+    public bool Framed { get; set; }
+
+    [GlobalSetup]
+    public void Setup()
+    {
+        _reader.PrepareDecoding(PayloadSize, Framed);
+        _reader.TimestampedDataReceived += (_, e) => _packages += e.Packages.Length;
+        _bytes = Framed ? CreateFrames(1 << 20) : new byte[1 << 20];
+        if (!Framed)
+            new Random(1).NextBytes(_bytes);
+    }
+
+    // 1 MB of received bytes per invocation.
+    [Benchmark]
+    public long DecodeMegabyte()
+    {
+        for (int offset = 0; offset < _bytes.Length; offset += ReadSize)
+            _reader.OnBytesReceived(_bytes.AsSpan(offset, ReadSize));
+        return _packages;
+    }
+
+    // Consecutive frames of 4 variables filling the given number of bytes, the tail padded with zeroes.
+    private byte[] CreateFrames(int length)
+    {
+        const int variables = 4;
+        int payloadBytes = PayloadSize switch
+        {
+            UARTDataPayloadSize.UART_PAYLOAD_8 => 1,
+            UARTDataPayloadSize.UART_PAYLOAD_16 => 2,
+            _ => 4
+        };
+        int frameSize = UARTFrameFormat.FrameSize(variables, payloadBytes, 2);
+
+        byte[] bytes = new byte[length];
+        for (int f = 0; (f + 1) * frameSize <= length; f++)
+        {
+            Span<byte> frame = bytes.AsSpan(f * frameSize, frameSize);
+            frame[0] = UARTFrameFormat.Sync;
+            frame[1] = UARTFrameFormat.CreateHeader(variables, payloadBytes, 2);
+            BinaryPrimitives.WriteUInt16BigEndian(frame[2..], (ushort)f);
+            for (int v = 0; v < variables; v++)
+                frame[4 + v * payloadBytes] = (byte)(f + v);
+            frame[^1] = UARTFrameFormat.Crc8(frame[..^1]);
+            if (f % 1000 == 999)
+                frame[3] ^= 0x10;
+        }
+        return bytes;
+    }
+}
\ No newline at end of file
@@ -18,9 +18,11 @@ namespace RealtimePlottingApp.Events
         public byte[] Data { get; }
         
         /// <summary>
-        /// Gets the timestamp of when the message was received by the application.
+        /// Gets the timestamp of when the message was received by the application,
+        /// in ticks of the bus's ICanBus.TicksPerSecond since connecting.
+        /// Wraps around at the bus's ICanBus.TimestampBits.
         /// </summary>
-        public uint Timestamp { get; }
+        public long Timestamp { get; }
         
         /// <summary>
         /// Initializes a new instance of the <see cref="CanMessageReceivedEvent"/> class.
@@ -29,7 +31,7 @@ namespace RealtimePlottingApp.Events
         /// <param name="data">The received data payload.</param>
         /// <param name="timestamp">The timestamp to accompany this data</param>
         /// <exception cref="ArgumentNullException">Thrown if the data argument is null.</exception>
-        public CanMessageReceivedEvent(uint canId, byte[] data, uint timestamp)
+        public CanMessageReceivedEvent(uint canId, byte[] data, long timestamp)
         {
             CanId = canId;
             Data = data ?? throw new ArgumentNullException(nameof(data));
@@ -4,23 +4,30 @@ using RealtimePlottingApp.Models;
 namespace RealtimePlottingApp.Events;
 
 /// <summary>
-/// Event arguments that hold an array of timestamped data packages.
+/// Event arguments that hold a batch of timestamped data packages.
 /// </summary>
 public class TimestampedDataReceivedEvent : EventArgs
 {
     /// <summary>
-    /// Gets the timestamped data packages that has been received
+    /// Gets the timestamped data packages that has been received.
+    /// The memory is owned and reused by the sender, and is only valid for the duration
+    /// of the event handler. Copy the packages if they need to be kept.
     /// </summary>
-    public UARTTimestampedData[] Packages { get; }
+    public ReadOnlyMemory<UARTTimestampedData> Packages { get; }
+
+    /// <summary>
+    /// Number of bits of the packages' timestamps, after which they wrap around.
+    /// </summary>
+    public int TimestampBits { get; }
 
     /// <summary>
     /// Initializes a new isntance of the class.
     /// </summary>
     /// <param name="packages"> The received timestamped data packages </param>
-    /// <exception cref="ArgumentNullException"> Is cast when the packages argument is null </exception>
-    public TimestampedDataReceivedEvent(UARTTimestampedData[] packages)
+    /// <param name="timestampBits"> The number of bits of the packages' timestamps </param>
+    public TimestampedDataReceivedEvent(ReadOnlyMemory<UARTTimestampedData> packages, int timestampBits = 8)
     {
-        // Null-checked assignment
-        Packages = packages ?? throw new ArgumentNullException(nameof(packages));
+        Packages = packages;
+        TimestampBits = timestampBits;
     }
 }
\ No newline at end of file
@@ -0,0 +1,18 @@
+﻿namespace RealtimePlottingApp.Models;
+
+/// <summary>
+/// Describes how the raw bits of a CAN payload variable are turned into a value.
+/// The physical value is raw * Scale + Offset, where raw is sign-extended if Signed is set.
+/// Values are stored as unsigned samples, which CanPayloadPlan enforces when compiling a format.
+/// </summary>
+/// <param name="Signed">Whether the raw bits are a two's complement value</param>
+/// <param name="LittleEndian">Whether the lowest payload byte of the variable is its least significant</param>
+/// <param name="Scale">Factor the raw value is multiplied by</param>
+/// <param name="Offset">Value added after scaling</param>
+public readonly record struct CanFieldFormat(bool Signed, bool LittleEndian, double Scale, double Offset)
+{
+    /// <summary>
+    /// Unsigned, big-endian raw value, which is how masks were always decoded.
+    /// </summary>
+    public static CanFieldFormat Default => new(false, false, 1, 0);
+}
\ No newline at end of file
@@ -0,0 +1,12 @@
+﻿using System;
+
+namespace RealtimePlottingApp.Models;
+
+/// <summary>
+/// Describes the session a capture file was recorded from.
+/// </summary>
+/// <param name="VariableCount">Number of variables in the capture</param>
+/// <param name="TicksPerSecond">Number of X-value ticks per second, for replaying in real time</param>
+/// <param name="StartTime">When recording started</param>
+/// <param name="Config">The connection config message of the recorded session, e.g. "ConnectUart:..."</param>
+public readonly record struct CaptureHeader(int VariableCount, double TicksPerSecond, DateTime StartTime, string Config);
\ No newline at end of file
@@ -0,0 +1,7 @@
+﻿namespace RealtimePlottingApp.Models;
+
+/// <summary>
+/// One recorded sample of a capture file: the variable it belongs to, and its X (timestamp) and Y values.
+/// X values are stored on the 64-bit timebase, after timestamp overflows were accounted for, so they never decrease.
+/// </summary>
+public readonly record struct CaptureSample(int Variable, long X, uint Y);
\ No newline at end of file
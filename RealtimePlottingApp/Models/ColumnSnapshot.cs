@@ -0,0 +1,301 @@
+﻿using System;
+
+namespace RealtimePlottingApp.Models;
+
+/// <summary>
+/// Read-only view of a SampleColumn as of one commit. Samples are only ever appended past the
+/// published end, and chunks dropped by retention are only removed from newer snapshots, so a
+/// snapshot stays consistent however long it is held and whatever the writer does meanwhile.
+///
+/// Samples are addressed by an absolute index counting every sample added since the
+/// last clear, so an index stays valid (and keeps meaning the same sample) when older
+/// samples are dropped by a retention policy. Valid indexes are [FirstIndex, EndIndex).
+/// X values are 64-bit ticks of the data source's timebase (see GraphDataModel.TicksPerSecond),
+/// and samples of a time range are found through the column's sparse time index in O(log n).
+/// </summary>
+public readonly struct ColumnSnapshot
+{
+    private const int ChunkShift = SampleColumn.ChunkShift;
+    private const int ChunkMask = SampleColumn.ChunkSize - 1;
+
+    // ===== Instance Variables ===== //
+    private readonly SampleChunk[]? _chunks; // _chunks[0] is the chunk numbered _firstChunk
+    private readonly long[]? _chunkStartX;   // First X value of each chunk in _chunks
+    private readonly long _firstChunk;       // Absolute chunk number of the first retained chunk
+    private readonly long _endIndex;         // Absolute index one past the newest sample
+
+    internal ColumnSnapshot(SampleChunk[] chunks, long[] chunkStartX, long firstChunk, long endIndex)
+    {
+        _chunks = chunks;
+        _chunkStartX = chunkStartX;
+        _firstChunk = firstChunk;
+        _endIndex = endIndex;
+    }
+
+    // ===== API Properties ===== //
+    /// <summary>
+    /// Absolute index of the oldest retained sample.
+    /// </summary>
+    public long FirstIndex => _firstChunk << ChunkShift;
+
+    /// <summary>
+    /// Absolute index one past the newest sample. Equals the total number of samples added since the last clear.
+    /// </summary>
+    public long EndIndex => _endIndex;
+
+    /// <summary>
+    /// Number of samples retained.
+    /// </summary>
+    public long Count => _endIndex - FirstIndex;
+
+    /// <summary>
+    /// Heap memory allocated for the retained chunks, in bytes.
+    /// </summary>
+    public long MemoryUsageBytes => ChunkCount * SampleColumn.ChunkBytes;
+
+    /// <summary>
+    /// X value of the newest sample. Only valid when Count > 0.
+    /// </summary>
+    public long LastX => GetX(_endIndex - 1);
+
+    /// <summary>
+    /// Y value of the newest sample. Only valid when Count > 0.
+    /// </summary>
+    public uint LastY => GetY(_endIndex - 1);
+
+    // ===== API Methods ===== //
+    /// <summary>
+    /// Gets the X value of the sample at the given absolute index.
+    /// </summary>
+    public long GetX(long index) => _chunks![ChunkOf(index)].X[(int)(index & ChunkMask)];
+
+    /// <summary>
+    /// Gets the Y value of the sample at the given absolute index.
+    /// </summary>
+    public uint GetY(long index) => _chunks![ChunkOf(index)].Y[(int)(index & ChunkMask)];
+
+    /// <summary>
+    /// Returns the absolute index of the first sample with an X value greater than or equal to x,
+    /// or EndIndex if there is none. Binary searches the time index, then within a chunk: O(log n).
+    /// </summary>
+    public long LowerBound(long x)
+    {
+        if (Count == 0 || LastX < x)
+            return _endIndex;
+
+        // Find the last chunk that starts below x, the answer is within it or at the start of the next.
+        int chunkCount = ChunkCount;
+        int low = 0, high = chunkCount - 1, chunk = 0;
+        while (low <= high)
+        {
+            int mid = (low + high) / 2;
+            if (_chunkStartX![mid] < x)
+            {
+                chunk = mid;
+                low = mid + 1;
+            }
+            else
+            {
+                high = mid - 1;
+            }
+        }
+
+        long[] xs = _chunks![chunk].X;
+        int used = chunk == chunkCount - 1 ? (int)(((_endIndex - 1) & ChunkMask) + 1) : SampleColumn.ChunkSize;
+        int found = Array.BinarySearch(xs, 0, used, x);
+        if (found < 0)
+        {
+            found = ~found;
+        }
+        else
+        {
+            // Step back to the first of any duplicate X values.
+            while (found > 0 && xs[found - 1] == x) found--;
+        }
+
+        return ((_firstChunk + chunk) << ChunkShift) + found;
+    }
+
+    /// <summary>
+    /// Returns the absolute index of the first sample with an X value greater than x,
+    /// or EndIndex if there is none. Together with LowerBound, the samples of the time range
+    /// [fromX, toX] are [LowerBound(fromX), UpperBound(toX)). O(log n).
+    /// </summary>
+    public long UpperBound(long x) => x == long.MaxValue ? _endIndex : LowerBound(x + 1);
+
+    /// <summary>
+    /// Finds the samples holding the smallest and largest Y value in the absolute index range
+    /// [start, end), using the largest completed level of detail buckets that fit the range.
+    /// The range is clamped to the retained samples.
+    /// </summary>
+    /// <returns>False if the range holds no samples.</returns>
+    public bool TryGetYRange(long start, long end, out long minIndex, out long maxIndex)
+    {
+        start = Math.Max(start, FirstIndex);
+        end = Math.Min(end, _endIndex);
+        minIndex = maxIndex = start;
+        if (start >= end) return false;
+
+        uint min = uint.MaxValue, max = uint.MinValue;
+        long position = start;
+        while (position < end)
+        {
+            SampleChunk chunk = _chunks![ChunkOf(position)];
+            int offset = (int)(position & ChunkMask);
+            long chunkStart = position - offset;
+
+            // Pick the highest level whose bucket starts here and lies fully inside the range.
+            int level = 0;
+            while (level < SampleChunk.LodLevels &&
+                   (offset & ((1 << ((level + 1) * SampleChunk.LodShift)) - 1)) == 0 &&
+                   position + (1 << ((level + 1) * SampleChunk.LodShift)) <= end)
+                level++;
+
+            if (level == 0)
+            {
+                uint y = chunk.Y[offset];
+                if (y < min) { min = y; minIndex = position; }
+                if (y > max) { max = y; maxIndex = position; }
+                position++;
+            }
+            else
+            {
+                MinMaxBucket bucket =
+                    chunk.Lod[SampleChunk.LodLevelStart[level] + (offset >> (level * SampleChunk.LodShift))];
+                if (bucket.Min < min) { min = bucket.Min; minIndex = chunkStart + bucket.MinOffset; }
+                if (bucket.Max > max) { max = bucket.Max; maxIndex = chunkStart + bucket.MaxOffset; }
+                position += 1 << (level * SampleChunk.LodShift);
+            }
+        }
+        return true;
+    }
+
+    /// <summary>
+    /// Copies a min/max decimated version of the samples in [start, end) into the destination spans.
+    /// The range is split into groups of groupSize samples, aligned to absolute indexes so that
+    /// panning does not shift them, and the samples holding each group's smallest and largest
+    /// Y value are written in index order. Peaks are therefore kept exactly.
+    /// The destinations must hold at least 2 * (ceil((end - start) / groupSize) + 1) samples.
+    /// </summary>
+    /// <returns>The number of samples written.</returns>
+    public int CopyDecimatedTo(long start, long end, long groupSize,
+        Span<double> xDestination, Span<double> yDestination)
+    {
+        start = Math.Max(start, FirstIndex);
+        end = Math.Min(end, _endIndex);
+        int written = 0;
+
+        for (long groupStart = start - start % groupSize; groupStart < end; groupStart += groupSize)
+        {
+            if (!TryGetYRange(Math.Max(groupStart, start), Math.Min(groupStart + groupSize, end),
+                    out long minIndex, out long maxIndex))
+                continue;
+
+            long first = Math.Min(minIndex, maxIndex);
+            long last = Math.Max(minIndex, maxIndex);
+            xDestination[written] = GetX(first);
+            yDestination[written++] = GetY(first);
+            if (last == first) continue;
+            xDestination[written] = GetX(last);
+            yDestination[written++] = GetY(last);
+        }
+        return written;
+    }
+
+    /// <summary>
+    /// Enumerates the samples in the absolute index range [start, end) as contiguous
+    /// spans pointing directly into the underlying chunks, without copying.
+    /// The range is clamped to the retained samples.
+    /// </summary>
+    public SegmentEnumerator GetSegments(long start, long end)
+    {
+        return new SegmentEnumerator(this, Math.Max(start, FirstIndex), Math.Min(end, _endIndex));
+    }
+
+    /// <summary>
+    /// Copies samples, starting at the given absolute index, into destination spans of equal
+    /// length as doubles for plotting. The number of samples copied is the length of the spans.
+    /// </summary>
+    public void CopyTo(long start, Span<double> xDestination, Span<double> yDestination)
+    {
+        int written = 0;
+        foreach (Segment segment in GetSegments(start, start + xDestination.Length))
+        {
+            for (int i = 0; i < segment.X.Length; i++)
+            {
+                xDestination[written + i] = segment.X[i];
+                yDestination[written + i] = segment.Y[i];
+            }
+            written += segment.X.Length;
+        }
+    }
+
+    // ===== Private Helpers ===== //
+    // Number of chunks holding retained samples, the writer may have started another one past them.
+    private int ChunkCount => _endIndex > FirstIndex
+        ? (int)(((_endIndex - 1) >> ChunkShift) - _firstChunk + 1)
+        : 0;
+
+    private int ChunkOf(long index)
+    {
+        if (index < FirstIndex || index >= _endIndex)
+            throw new ArgumentOutOfRangeException(nameof(index));
+        return (int)((index >> ChunkShift) - _firstChunk);
+    }
+
+    // ===== Segment enumeration ===== //
+    /// <summary>
+    /// A contiguous run of samples inside one chunk.
+    /// </summary>
+    public readonly ref struct Segment
+    {
+        /// <summary>
+        /// Absolute index of the first sample in the segment.
+        /// </summary>
+        public long StartIndex { get; }
+        public ReadOnlySpan<long> X { get; }
+        public ReadOnlySpan<uint> Y { get; }
+
+        internal Segment(long startIndex, ReadOnlySpan<long> x, ReadOnlySpan<uint> y)
+        {
+            StartIndex = startIndex;
+            X = x;
+            Y = y;
+        }
+    }
+
+    /// <summary>
+    /// Allocation-free enumerator over the chunks covering an index range, usable with foreach.
+    /// </summary>
+    public ref struct SegmentEnumerator
+    {
+        private readonly ColumnSnapshot _column;
+        private long _next;
+        private readonly long _end;
+
+        internal SegmentEnumerator(ColumnSnapshot column, long start, long end)
+        {
+            _column = column;
+            _next = start;
+            _end = end;
+            Current = default;
+        }
+
+        public Segment Current { get; private set; }
+
+        public SegmentEnumerator GetEnumerator() => this;
+
+        public bool MoveNext()
+        {
+            if (_next >= _end) return false;
+
+            SampleChunk chunk = _column._chunks![_column.ChunkOf(_next)];
+            int offset = (int)(_next & ChunkMask);
+            int length = (int)Math.Min(SampleColumn.ChunkSize - offset, _end - _next);
+
+            Current = new Segment(_next, chunk.X.AsSpan(offset, length), chunk.Y.AsSpan(offset, length));
+            _next += length;
+            return true;
+        }
+    }
+}
\ No newline at end of file
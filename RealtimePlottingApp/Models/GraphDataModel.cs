@@ -1,23 +1,44 @@
 ﻿using System;
 using System.Collections.Generic;
+using System.Threading;
+using RealtimePlottingApp.Services.Diagnostics;
 
 namespace RealtimePlottingApp.Models;
 
 /// <summary>
-/// Model representing data lists for a 2D plotting of X and Y values.
+/// Model representing the sampled X and Y values of one or more variables for 2D plotting.
+/// Each variable is stored in its own chunked SampleColumn, so consumers can read one
+/// variable's samples directly instead of de-interleaving a shared list.
+///
+/// Raw timestamps are unwrapped onto a 64-bit timebase as they are added, so X values keep
+/// increasing however often the source's narrower timestamps overflow. They are stored in
+/// the source's own units, which TicksPerSecond relates to time.
+///
+/// Written by a single data source at a time, which holds the model's lock while adding and
+/// committing a batch of samples. The lock is otherwise only taken to reconfigure or clear the model.
+/// Readers such as the plots never lock it: Snapshot() returns the samples as of the last commit,
+/// so that rendering can never hold up ingest.
 /// </summary>
 public class GraphDataModel
 {
-    // Private instance variables which stores the data
-    private readonly List<uint> _XData;
-    private readonly List<uint> _YData;
-    
+    // Private instance variables which stores the data, one column per variable.
+    private SampleColumn[] _columns;
+    private int _nextVariable; // Variable that the next interleaved AddPoint belongs to.
+    private int _uncommittedSamples; // Samples added since the last CommitSamples.
+
+    // The columns as of the last commit, for readers. Published as a sequence lock: _publishVersion is
+    // odd while the writer updates them, and readers retry if it changed while they were copying them.
+    private ColumnSnapshot[] _published = [];
+    private long _publishVersion;
+    private long _commitCount;
+
     // Variables for timestamp (X-Value) overflow handling.
     // _lastRawTimestamp keeps track of the last raw timestamp.
     // _overflowAdd holds the total offset added to the raw timestamp.
     private uint _lastRawTimestamp;
-    private uint _overflowAdd;
+    private long _overflowAdd;
     private uint _xValBitSize = 8; // 8-bit timestamps as default.
+    private bool _hasData;
 
     /// <summary>
     /// Variable defining bit-size of the X-Axis values,
@@ -28,84 +49,235 @@ public class GraphDataModel
         get => _xValBitSize;
         set => _xValBitSize = value;
     }
-    
+
     /// <summary>
     /// Counter that increments each time a timestamp overflow is detected.
     /// Overflows are handled internally to allow consistent plotting.
     /// </summary>
     public uint yOverflowCounter { get; private set; }
-    
+
+    /// <summary>
+    /// The number of variables (columns) stored. Changing it clears all data.
+    /// </summary>
+    public int VariableCount
+    {
+        get => _columns.Length;
+        set
+        {
+            if (value < 1) throw new ArgumentOutOfRangeException(nameof(value));
+            if (value == _columns.Length) return;
+            _columns = CreateColumns(value);
+            Clear();
+        }
+    }
+
+    /// <summary>
+    /// Policy bounding how much history is retained. Applied as new chunks are started.
+    /// </summary>
+    public RetentionPolicy Retention { get; set; } = RetentionPolicy.Unlimited;
+
+    /// <summary>
+    /// Number of X-value ticks per second, i.e. the units the data source timestamps samples in
+    /// (1000 for milliseconds, 1000000 for microseconds). Set by the data channel, and used to
+    /// apply duration-based retention and to define plot windows and statistics in seconds.
+    /// </summary>
+    public double TicksPerSecond { get; set; } = 1000;
+
+    /// <summary>
+    /// Returns access to the column of samples for each variable, indexed by variable number.
+    /// Only for the writer, i.e. while holding the model's lock. Other threads use Snapshot().
+    /// </summary>
+    public IReadOnlyList<SampleColumn> Columns => _columns;
+
     /// <summary>
-    /// Returns access to a read-only representation of the X values.
+    /// Number of batches committed since the model was created.
     /// </summary>
-    public IReadOnlyList<uint> XData => _XData.AsReadOnly();
-    
+    public long CommitCount => Volatile.Read(ref _commitCount);
+
     /// <summary>
-    /// Returns access to a read-only representation of the Y values.
+    /// Raised by CommitSamples() once a data source has added a batch of samples,
+    /// while the model is still locked, so that observers such as the trigger engine
+    /// can inspect new samples as they are ingested rather than on the next UI update.
     /// </summary>
-    public IReadOnlyList<uint> YData => _YData.AsReadOnly();
+    public event EventHandler? SamplesCommitted;
+
+    /// <summary>
+    /// Raised by Clear() once all samples have been removed, while the model is still locked,
+    /// so that observers which keep state derived from the samples can reset it.
+    /// </summary>
+    public event EventHandler? Cleared;
 
     /// <summary>
     /// Constructor for a new graph data model
     /// </summary>
-    public GraphDataModel()
+    /// <param name="variableCount">The number of variables to store columns for</param>
+    public GraphDataModel(int variableCount = 1)
     {
-        _XData = [];
-        _YData = [];
+        _columns = CreateColumns(Math.Max(variableCount, 1));
         _lastRawTimestamp = 0;
         _overflowAdd = 0;
         yOverflowCounter = 0;
+        Publish();
     }
 
     /// <summary>
-    /// Clone constructor for a graph data model 
+    /// Adds a new data point for the next variable in interleaved order (Var1, Var2, ... VarN, Var1, ...),
+    /// for data sources which transmit the variables in a fixed sequence.
+    /// The X values are adjusted dynamically to account for potential timestamp overflows.
     /// </summary>
-    /// <param name="xData">A list of data values for the x-axis</param>
-    /// <param name="yData">A list of data values for the y-axis</param>
-    public GraphDataModel(List<uint> xData, List<uint> yData)
+    /// <param name="x">The raw timestamp value.</param>
+    /// <param name="y">The Y value data.</param>
+    public void AddPoint(uint x, uint y)
     {
-        _XData = new List<uint>(xData);
-        _YData = new List<uint>(yData);
-        _lastRawTimestamp = 0;
-        _overflowAdd = 0;
-        yOverflowCounter = 0;
+        AddPoint(_nextVariable, x, y);
     }
 
     /// <summary>
-    /// Adds a new data point to both the X and Y collections of data.
+    /// Adds a new data point for the given variable.
     /// The X values are adjusted dynamically to account for potential timestamp overflows.
     /// </summary>
+    /// <param name="variable">Index of the variable the point belongs to.</param>
     /// <param name="x">The raw timestamp value.</param>
     /// <param name="y">The Y value data.</param>
-    public void AddPoint(uint x, uint y)
+    public void AddPoint(int variable, uint x, uint y)
     {
         // Check for overflow for values that is not the first value.
-        if (_XData.Count > 0)
+        if (_hasData)
         {
             // When a new "raw timestamp" is less than the previous one, an overflow must have occurred.
             if (x < _lastRawTimestamp)
             {
                 // Increment the value to "make up for" by overflows to ensure graphing integrity
-                _overflowAdd += (uint)Math.Pow(2,_xValBitSize); //The amount "lost" during this X-Axis overflow.
+                _overflowAdd += 1L << (int)Math.Min(_xValBitSize, 32); //The amount "lost" during this X-Axis overflow.
                 yOverflowCounter++;
             }
         }
-            
+
         // Store the current raw timestamp, to allow next value to check if it's overflown.
         _lastRawTimestamp = x;
+        _hasData = true;
 
         // Calculate the adjusted timestamp by adding the accumulated offset from any and all overflows.
-        uint adjustedX = x + _overflowAdd;
-        _XData.Add(adjustedX);
-        _YData.Add(y);
+        AddUnwrappedPoint(variable, x + _overflowAdd, y);
     }
 
+    /// <summary>
+    /// Adds a new data point for the given variable, whose X value is already on the 64-bit timebase,
+    /// such as a sample replayed from a capture or a 64-bit timestamped CAN frame.
+    /// X values are expected to be non-decreasing.
+    /// </summary>
+    /// <param name="variable">Index of the variable the point belongs to.</param>
+    /// <param name="x">The unwrapped timestamp value.</param>
+    /// <param name="y">The Y value data.</param>
+    public void AddUnwrappedPoint(int variable, long x, uint y)
+    {
+        SampleColumn column = _columns[variable];
+        column.Add(x, y);
+        _nextVariable = variable + 1 < _columns.Length ? variable + 1 : 0;
+        _uncommittedSamples++;
+
+        // A new chunk was just started, check whether older chunks fell outside the retention policy.
+        if (Retention.Mode != RetentionMode.Unlimited && (column.Current.EndIndex & (SampleColumn.ChunkSize - 1)) == 1)
+            ApplyRetention(column);
+    }
+
+    /// <summary>
+    /// Publishes the samples added so far to readers, and notifies observers that a batch of samples has been added.
+    /// Should be called by data sources after each batch, while holding the model's lock.
+    /// </summary>
+    public void CommitSamples()
+    {
+        PipelineMetrics.StoredSamples.Add(_uncommittedSamples);
+        _uncommittedSamples = 0;
+        Publish();
+        SamplesCommitted?.Invoke(this, EventArgs.Empty);
+    }
+
+    /// <summary>
+    /// Takes a consistent snapshot of every variable's samples as of the last commit, without locking.
+    /// Can be called from any thread, and never waits for the writer beyond the few copies of a commit.
+    /// </summary>
+    public GraphSnapshot Snapshot()
+    {
+        SpinWait spin = default;
+        while (true)
+        {
+            long version = Volatile.Read(ref _publishVersion);
+            if ((version & 1) == 0)
+            {
+                ColumnSnapshot[] columns = (ColumnSnapshot[])Volatile.Read(ref _published).Clone();
+                long commits = _commitCount;
+
+                // Keep the copies above from being moved past the version check.
+                Interlocked.MemoryBarrier();
+                if (Volatile.Read(ref _publishVersion) == version)
+                    return new GraphSnapshot(columns, commits);
+            }
+            spin.SpinOnce(); // The writer is publishing a commit, or published one while copying
+        }
+    }
+
+    /// <summary>
+    /// Removes all samples. Should be called while holding the model's lock.
+    /// </summary>
     public void Clear()
     {
-        _XData.Clear();
-        _YData.Clear();
+        foreach (SampleColumn column in _columns)
+            column.Clear();
+        _nextVariable = 0;
+        _uncommittedSamples = 0;
+        _hasData = false;
         _lastRawTimestamp = 0;
         _overflowAdd = 0;
         yOverflowCounter = 0;
+        Publish();
+        Cleared?.Invoke(this, EventArgs.Empty);
+    }
+
+    // Makes the columns as written so far visible to snapshots. Only called by the writer.
+    private void Publish()
+    {
+        Interlocked.Increment(ref _publishVersion); // Odd: readers retry. Full fence, the samples are written before.
+        if (_published.Length != _columns.Length)
+            _published = new ColumnSnapshot[_columns.Length];
+        for (int v = 0; v < _columns.Length; v++)
+            _published[v] = _columns[v].Current;
+        _commitCount++;
+        Volatile.Write(ref _publishVersion, _publishVersion + 1); // Even: published
+    }
+
+    // Drops whole chunks from the front of a column until it satisfies the retention policy.
+    private void ApplyRetention(SampleColumn column)
+    {
+        switch (Retention.Mode)
+        {
+            case RetentionMode.SampleCount:
+                while (column.Current.Count - SampleColumn.ChunkSize >= Retention.Limit && column.DropOldestChunk()) { }
+                break;
+
+            case RetentionMode.Duration:
+                // A chunk can go once even its newest sample is older than the retained duration.
+                long cutoff = column.Current.LastX - (long)(Retention.Limit * TicksPerSecond);
+                while (OldestChunkLastX(column.Current) < cutoff && column.DropOldestChunk()) { }
+                break;
+
+            case RetentionMode.MemoryBudget:
+                // Split the budget evenly, so that every variable keeps a comparable history.
+                double columnBudget = Retention.Limit / _columns.Length;
+                while (column.Current.MemoryUsageBytes > columnBudget && column.DropOldestChunk()) { }
+                break;
+        }
+    }
+
+    // X value of the last sample in the oldest retained chunk, which can be dropped once it's old enough.
+    private static long OldestChunkLastX(ColumnSnapshot column) =>
+        column.GetX(Math.Min(column.FirstIndex + SampleColumn.ChunkSize, column.EndIndex) - 1);
+
+    private static SampleColumn[] CreateColumns(int count)
+    {
+        SampleColumn[] columns = new SampleColumn[count];
+        for (int i = 0; i < count; i++)
+            columns[i] = new SampleColumn();
+        return columns;
     }
 }
\ No newline at end of file
@@ -0,0 +1,80 @@
+﻿using System;
+using System.Collections.Generic;
+
+namespace RealtimePlottingApp.Models;
+
+/// <summary>
+/// Consistent read-only view of all variables of a GraphDataModel as of one commit,
+/// taken without locking by GraphDataModel.Snapshot(). Stays valid while the writer keeps adding samples.
+/// </summary>
+public sealed class GraphSnapshot
+{
+    // ===== Instance Variables ===== //
+    private readonly ColumnSnapshot[] _columns;
+
+    internal GraphSnapshot(ColumnSnapshot[] columns, long commitCount)
+    {
+        _columns = columns;
+        CommitCount = commitCount;
+    }
+
+    // ===== API Properties ===== //
+    /// <summary>
+    /// The samples of each variable, indexed by variable number.
+    /// </summary>
+    public IReadOnlyList<ColumnSnapshot> Columns => _columns;
+
+    /// <summary>
+    /// Number of commits published before the snapshot was taken.
+    /// </summary>
+    public long CommitCount { get; }
+
+    /// <summary>
+    /// True if no samples are retained for any variable.
+    /// </summary>
+    public bool IsEmpty
+    {
+        get
+        {
+            foreach (ColumnSnapshot column in _columns)
+                if (column.Count > 0) return false;
+            return true;
+        }
+    }
+
+    /// <summary>
+    /// Heap memory allocated for sample storage, in bytes.
+    /// </summary>
+    public long MemoryUsageBytes
+    {
+        get
+        {
+            long total = 0;
+            foreach (ColumnSnapshot column in _columns)
+                total += column.MemoryUsageBytes;
+            return total;
+        }
+    }
+
+    // ===== API Methods ===== //
+    /// <summary>
+    /// Finds the smallest and largest Y value retained across all variables.
+    /// </summary>
+    /// <returns>False if there is no data.</returns>
+    public bool TryGetYRange(out uint min, out uint max)
+    {
+        min = uint.MaxValue;
+        max = uint.MinValue;
+        bool hasData = false;
+        foreach (ColumnSnapshot column in _columns)
+        {
+            // Resolved from the column's level of detail buckets, not by scanning every sample.
+            if (!column.TryGetYRange(column.FirstIndex, column.EndIndex, out long minIndex, out long maxIndex))
+                continue;
+            min = Math.Min(min, column.GetY(minIndex));
+            max = Math.Max(max, column.GetY(maxIndex));
+            hasData = true;
+        }
+        return hasData;
+    }
+}
\ No newline at end of file
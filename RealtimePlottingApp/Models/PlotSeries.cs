@@ -0,0 +1,50 @@
+﻿using System;
+
+namespace RealtimePlottingApp.Models;
+
+/// <summary>
+/// X and Y values of one variable as handed to the plot, in arrays which are reused between
+/// frames. Only the first Count values are valid. The arrays are only replaced when a frame
+/// needs more room than they have, so a plot series can keep referencing them across frames.
+/// </summary>
+public class PlotSeries
+{
+    /// <summary>
+    /// Backing array of X values. Replaced when the capacity grows.
+    /// </summary>
+    public double[] Xs { get; private set; } = [];
+
+    /// <summary>
+    /// Backing array of Y values. Replaced when the capacity grows.
+    /// </summary>
+    public double[] Ys { get; private set; } = [];
+
+    /// <summary>
+    /// Number of valid values at the start of the arrays.
+    /// </summary>
+    public int Count { get; private set; }
+
+    /// <summary>
+    /// Sets the number of valid values, growing the arrays if they are too small.
+    /// Values are not preserved when growing, the caller is expected to overwrite them.
+    /// </summary>
+    public void SetCount(int count)
+    {
+        ArgumentOutOfRangeException.ThrowIfNegative(count);
+        EnsureCapacity(count);
+        Count = count;
+    }
+
+    /// <summary>
+    /// Grows the arrays to hold at least the given number of values, doubling the capacity
+    /// to make growing rare. Values are not preserved when growing.
+    /// </summary>
+    public void EnsureCapacity(int capacity)
+    {
+        if (capacity <= Xs.Length) return;
+        int newCapacity = Math.Max(capacity, Xs.Length * 2);
+        Xs = new double[newCapacity];
+        Ys = new double[newCapacity];
+        Count = 0;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,109 @@
+﻿using System;
+using System.Numerics;
+
+namespace RealtimePlottingApp.Models;
+
+/// <summary>
+/// Streaming histogram of sample values, from which quantiles such as the median are estimated.
+/// Values below 16 are counted exactly, larger values in logarithmic buckets of 16 per power of two,
+/// so an estimate is within half a bucket (about 3%) of the true value. Adding a value is O(1),
+/// and a quantile is found in time and memory independent of how many values were added.
+/// Sketches can be added to and subtracted from each other, e.g. to maintain a sliding window.
+/// Only used by StatisticsAccumulator, so it is guarded by StatisticsService's lock like the accumulator.
+/// </summary>
+public sealed class QuantileSketch
+{
+    // ===== Constants ===== //
+    private const int SubBucketBits = 4;
+    private const int SubBuckets = 1 << SubBucketBits;
+
+    /// <summary>
+    /// Number of buckets: the exact values below 16, then 16 per power of two up to 2^32.
+    /// </summary>
+    public const int BucketCount = SubBuckets + (32 - SubBucketBits) * SubBuckets;
+
+    // ===== Instance Variables ===== //
+    private readonly long[] _counts = new long[BucketCount];
+
+    // ===== API Properties ===== //
+    /// <summary>
+    /// Number of values in the sketch.
+    /// </summary>
+    public long Count { get; private set; }
+
+    // ===== API Methods ===== //
+    public void Add(uint value)
+    {
+        _counts[BucketOf(value)]++;
+        Count++;
+    }
+
+    /// <summary>
+    /// Adds all values of another sketch to this one.
+    /// </summary>
+    public void Add(QuantileSketch other)
+    {
+        for (int i = 0; i < BucketCount; i++)
+            _counts[i] += other._counts[i];
+        Count += other.Count;
+    }
+
+    /// <summary>
+    /// Removes all values of another sketch from this one, which must have been added to it before.
+    /// </summary>
+    public void Subtract(QuantileSketch other)
+    {
+        for (int i = 0; i < BucketCount; i++)
+            _counts[i] -= other._counts[i];
+        Count -= other.Count;
+    }
+
+    public void Clear()
+    {
+        Array.Clear(_counts);
+        Count = 0;
+    }
+
+    /// <summary>
+    /// Estimates the value below which the given fraction of the values lie.
+    /// </summary>
+    /// <param name="quantile">Fraction between 0 and 1, e.g. 0.5 for the median</param>
+    /// <returns>The estimated value, or NaN if the sketch is empty.</returns>
+    public double Quantile(double quantile)
+    {
+        if (Count == 0)
+            return double.NaN;
+
+        // The value of the rank-th smallest value's bucket, ranks starting at 1.
+        long rank = Math.Clamp((long)Math.Ceiling(Math.Clamp(quantile, 0, 1) * Count), 1, Count);
+        long seen = 0;
+        for (int bucket = 0; bucket < BucketCount; bucket++)
+        {
+            seen += _counts[bucket];
+            if (seen >= rank)
+                return BucketMidpoint(bucket);
+        }
+        return BucketMidpoint(BucketCount - 1);
+    }
+
+    // ===== Private Helpers ===== //
+    // Values below 16 are their own bucket, others are bucketed by their highest bit and the 4 bits below it.
+    private static int BucketOf(uint value)
+    {
+        if (value < SubBuckets)
+            return (int)value;
+        int exponent = BitOperations.Log2(value);
+        int subBucket = (int)(value >> (exponent - SubBucketBits)) & (SubBuckets - 1);
+        return SubBuckets + (exponent - SubBucketBits) * SubBuckets + subBucket;
+    }
+
+    private static double BucketMidpoint(int bucket)
+    {
+        if (bucket < SubBuckets)
+            return bucket;
+        int shift = (bucket - SubBuckets) / SubBuckets;
+        int subBucket = (bucket - SubBuckets) % SubBuckets;
+        double lower = (double)(SubBuckets + subBucket) * (1L << shift);
+        return lower + ((1L << shift) - 1) / 2.0;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,12 @@
+﻿namespace RealtimePlottingApp.Models;
+
+/// <summary>
+/// Enum representing the ways the sample history can be bounded.
+/// </summary>
+public enum RetentionMode
+{
+    Unlimited,    // Keep everything until cleared
+    SampleCount,  // Keep the last N samples of each variable
+    Duration,     // Keep the last T seconds of samples
+    MemoryBudget, // Keep as much as fits in a number of bytes across all variables
+}
\ No newline at end of file
@@ -0,0 +1,47 @@
+﻿using System;
+
+namespace RealtimePlottingApp.Models;
+
+/// <summary>
+/// Describes how much sample history a GraphDataModel should keep.
+/// Retention is applied a whole chunk at a time, so slightly more than the limit
+/// (at most one chunk per variable) may be retained.
+/// </summary>
+public readonly record struct RetentionPolicy(RetentionMode Mode, double Limit)
+{
+    /// <summary>
+    /// Keep the entire history until cleared.
+    /// </summary>
+    public static RetentionPolicy Unlimited => new(RetentionMode.Unlimited, 0);
+
+    /// <summary>
+    /// Keep at least the last `samples` samples of each variable.
+    /// </summary>
+    public static RetentionPolicy LastSamples(long samples) => new(RetentionMode.SampleCount, samples);
+
+    /// <summary>
+    /// Keep at least the samples received within the last `seconds` seconds.
+    /// </summary>
+    public static RetentionPolicy LastSeconds(double seconds) => new(RetentionMode.Duration, seconds);
+
+    /// <summary>
+    /// Keep the sample history within `bytes` bytes of memory across all variables.
+    /// </summary>
+    public static RetentionPolicy MemoryBudget(long bytes) => new(RetentionMode.MemoryBudget, bytes);
+
+    /// <summary>
+    /// Parses a policy from its "Mode:Limit" string form, as sent over the message bus.
+    /// </summary>
+    /// <exception cref="FormatException">Thrown if the string is not a valid policy.</exception>
+    public static RetentionPolicy Parse(string text)
+    {
+        string[] parts = text.Split(':');
+        if (parts.Length != 2 || !Enum.TryParse(parts[0], out RetentionMode mode) ||
+            !double.TryParse(parts[1], System.Globalization.CultureInfo.InvariantCulture, out double limit) || limit < 0)
+            throw new FormatException($"Invalid retention policy: {text}");
+        return new RetentionPolicy(mode, limit);
+    }
+
+    public override string ToString() => 
+        $"{Mode}:{Limit.ToString(System.Globalization.CultureInfo.InvariantCulture)}";
+}
\ No newline at end of file
@@ -0,0 +1,31 @@
+﻿namespace RealtimePlottingApp.Models;
+
+/// <summary>
+/// Fixed-size block of a SampleColumn's samples with their level of detail buckets.
+/// Written only by the column's writer, and only past the column's published end,
+/// so readers of a snapshot never see a sample change.
+/// </summary>
+internal sealed class SampleChunk
+{
+    // Each level of detail summarizes 16 buckets (or samples) of the level below,
+    // three levels fit in one chunk: 256 + 16 + 1 buckets of 16, 256 and 4096 samples.
+    public const int LodShift = 4;
+    public const int LodLevels = SampleColumn.ChunkShift / LodShift;
+    public const int LodBucketsPerChunk = 256 + 16 + 1;
+    public static readonly int[] LodLevelStart = [0, 0, 256, 272]; // Bucket array offset per level (1-based)
+
+    public readonly long[] X = new long[SampleColumn.ChunkSize];
+    public readonly uint[] Y = new uint[SampleColumn.ChunkSize];
+    public readonly MinMaxBucket[] Lod = new MinMaxBucket[LodBucketsPerChunk];
+}
+
+/// <summary>
+/// Smallest and largest Y value of a bucket, with their offsets within the chunk (12 bytes).
+/// </summary>
+internal struct MinMaxBucket
+{
+    public uint Min;
+    public uint Max;
+    public ushort MinOffset;
+    public ushort MaxOffset;
+}
\ No newline at end of file
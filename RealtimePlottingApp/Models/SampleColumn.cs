@@ -0,0 +1,156 @@
+﻿using System;
+
+namespace RealtimePlottingApp.Models;
+
+/// <summary>
+/// Stores the samples of a single variable as an X (timestamp) and Y (value) column,
+/// split into fixed-size chunks. Growing only ever allocates one new chunk, so no large
+/// copies are made as a capture grows, and whole chunks can be dropped from the front
+/// to bound memory use. X values are 64-bit ticks of the data source's timebase,
+/// already unwrapped from any timestamp overflows, so they never wrap around.
+///
+/// The column is an append log with a single writer. Samples are read through snapshots
+/// (see ColumnSnapshot), which the writer publishes on every commit of the GraphDataModel:
+/// samples before a published end are never modified again, and the list of chunks is
+/// replaced rather than modified whenever chunks are dropped, so readers need no locks.
+///
+/// Alongside the samples, every chunk keeps a min/max pyramid of the Y values (level of detail),
+/// summarizing 16, 256 and 4096 samples per bucket. It is filled in as buckets complete, so
+/// the Y range of any span of samples is found in time proportional to the span's size
+/// in buckets, which keeps decimated plotting of long captures independent of their length.
+///
+/// The first X value of every chunk is also kept in a separate array, a sparse time index
+/// with one entry per chunk. Finding the samples of a time range binary searches it and then
+/// a single chunk, in O(log n) without touching the chunks that are skipped.
+/// </summary>
+public class SampleColumn
+{
+    // ===== Constants ===== //
+    /// <summary>
+    /// Number of samples held by one chunk. Power of two to allow shift/mask addressing.
+    /// </summary>
+    public const int ChunkSize = 4096;
+    internal const int ChunkShift = 12;
+    private const int ChunkMask = ChunkSize - 1;
+    private const int InitialChunkCapacity = 16;
+
+    /// <summary>
+    /// Heap memory used by one chunk: its X and Y columns, level of detail buckets and time index entry.
+    /// </summary>
+    public const long ChunkBytes = ChunkSize * (long)(sizeof(long) + sizeof(uint)) +
+                                   SampleChunk.LodBucketsPerChunk * 12L + sizeof(long);
+
+    // ===== Instance Variables ===== //
+    // Only touched by the writer. Slots of both arrays past the chunks in use are filled in as chunks are
+    // started, which snapshots never look at; anything else replaces the array instead of modifying it.
+    private SampleChunk[] _chunks = new SampleChunk[InitialChunkCapacity];
+    private long[] _chunkStartX = new long[InitialChunkCapacity]; // First X of each chunk in _chunks
+    private int _chunkCount;  // Chunks in use, _chunks[0] is the first retained chunk
+    private long _firstChunk; // Absolute chunk number of the first retained chunk
+    private long _endIndex;   // Absolute index one past the newest sample
+
+    // ===== API Properties ===== //
+    /// <summary>
+    /// The column as written so far, including samples which are not committed yet.
+    /// Only for the writer, i.e. while holding the GraphDataModel's lock, such as in its SamplesCommitted handlers.
+    /// Other threads read the column through GraphDataModel.Snapshot().
+    /// </summary>
+    public ColumnSnapshot Current => new(_chunks, _chunkStartX, _firstChunk, _endIndex);
+
+    // ===== API Methods ===== //
+    /// <summary>
+    /// Appends a sample to the end of the column. X values are expected to be non-decreasing.
+    /// </summary>
+    public void Add(long x, uint y)
+    {
+        int offset = (int)(_endIndex & ChunkMask);
+        if (offset == 0)
+            StartChunk(x); // Current chunk is full (or none exists yet), start a new one.
+
+        SampleChunk chunk = _chunks[_chunkCount - 1];
+        chunk.X[offset] = x;
+        chunk.Y[offset] = y;
+        _endIndex++;
+
+        // Fold every completed bucket into the level above it.
+        int completed = offset + 1;
+        for (int level = 1;
+             level <= SampleChunk.LodLevels && (completed & ((1 << (level * SampleChunk.LodShift)) - 1)) == 0;
+             level++)
+            FoldBucket(chunk, level, offset >> (level * SampleChunk.LodShift));
+    }
+
+    /// <summary>
+    /// Drops the oldest chunk. The chunk currently written to is never dropped.
+    /// Snapshots taken before keep the chunk alive until they are no longer used.
+    /// </summary>
+    /// <returns>True if a chunk was dropped.</returns>
+    public bool DropOldestChunk()
+    {
+        if (_chunkCount <= 1) return false;
+        SampleChunk[] chunks = new SampleChunk[_chunks.Length];
+        long[] chunkStartX = new long[_chunkStartX.Length];
+        Array.Copy(_chunks, 1, chunks, 0, _chunkCount - 1);
+        Array.Copy(_chunkStartX, 1, chunkStartX, 0, _chunkCount - 1);
+        _chunks = chunks;
+        _chunkStartX = chunkStartX;
+        _chunkCount--;
+        _firstChunk++;
+        return true;
+    }
+
+    /// <summary>
+    /// Removes all samples and releases all chunks, once no snapshot uses them anymore.
+    /// </summary>
+    public void Clear()
+    {
+        _chunks = new SampleChunk[InitialChunkCapacity];
+        _chunkStartX = new long[InitialChunkCapacity];
+        _chunkCount = 0;
+        _firstChunk = 0;
+        _endIndex = 0;
+    }
+
+    // ===== Private Helpers ===== //
+    // Adds a chunk starting at the given X after the ones in use, into larger copies of the list of
+    // chunks and the time index if they're full. Both are published together by the next commit.
+    private void StartChunk(long firstX)
+    {
+        if (_chunkCount == _chunks.Length)
+        {
+            SampleChunk[] chunks = new SampleChunk[_chunks.Length * 2];
+            long[] chunkStartX = new long[_chunks.Length * 2];
+            Array.Copy(_chunks, chunks, _chunkCount);
+            Array.Copy(_chunkStartX, chunkStartX, _chunkCount);
+            _chunks = chunks;
+            _chunkStartX = chunkStartX;
+        }
+        _chunkStartX[_chunkCount] = firstX;
+        _chunks[_chunkCount++] = new SampleChunk();
+    }
+
+    // Summarizes the 16 samples (level 1) or 16 lower level buckets that make up a completed bucket.
+    private static void FoldBucket(SampleChunk chunk, int level, int bucket)
+    {
+        MinMaxBucket result = new() { Min = uint.MaxValue, Max = uint.MinValue };
+        int first = bucket << SampleChunk.LodShift;
+
+        for (int i = first; i < first + (1 << SampleChunk.LodShift); i++)
+        {
+            if (level == 1)
+            {
+                uint y = chunk.Y[i];
+                if (y < result.Min) { result.Min = y; result.MinOffset = (ushort)i; }
+                if (y > result.Max) { result.Max = y; result.MaxOffset = (ushort)i; }
+            }
+            else
+            {
+                MinMaxBucket lower = chunk.Lod[SampleChunk.LodLevelStart[level - 1] + i];
+                if (lower.Min < result.Min) { result.Min = lower.Min; result.MinOffset = lower.MinOffset; }
+                if (lower.Max > result.Max) { result.Max = lower.Max; result.MaxOffset = lower.MaxOffset; }
+            }
+        }
+
+        chunk.Lod[SampleChunk.LodLevelStart[level] + bucket] = result;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,234 @@
+﻿using System;
+
+namespace RealtimePlottingApp.Models;
+
+/// <summary>
+/// Maintains the statistics of one variable's samples as they are added, in O(1) per sample:
+/// totals since it was last cleared, and the same over a sliding window ending at the newest sample.
+///
+/// The window is split into panes of equal duration which each summarize their own samples,
+/// and as a new pane starts the oldest one leaves the window as a whole. The window therefore
+/// covers between WindowPanes - 1 and WindowPanes panes' worth of time. Quantiles of the window
+/// come from a sketch kept as the sum of the panes' sketches, so that no query has to merge them.
+/// Not threadsafe, StatisticsService only calls it while holding its own lock.
+/// </summary>
+public sealed class StatisticsAccumulator
+{
+    // ===== Constants ===== //
+    /// <summary>
+    /// Number of panes the sliding window is split into.
+    /// </summary>
+    public const int WindowPanes = 16;
+
+    // ===== Instance Variables ===== //
+    private RunningMoments _total;
+    private readonly QuantileSketch _totalSketch = new();
+
+    private readonly RunningMoments[] _panes = new RunningMoments[WindowPanes];
+    private readonly QuantileSketch[] _paneSketches = new QuantileSketch[WindowPanes];
+    private readonly long[] _paneNumbers = new long[WindowPanes]; // Pane held by each slot, -1 if none
+    private readonly QuantileSketch _windowSketch = new();        // Sum of the panes' sketches
+    private long _paneTicks = 1;    // Duration of a pane in X ticks
+    private long _newestPane = -1;  // Number of the newest pane (X / _paneTicks), -1 before the first sample
+
+    // ===== Constructor ===== //
+    public StatisticsAccumulator()
+    {
+        for (int i = 0; i < WindowPanes; i++)
+            _paneSketches[i] = new QuantileSketch();
+        ClearWindow();
+    }
+
+    // ===== API Methods ===== //
+    /// <summary>
+    /// Adds a sample. X values are expected to be non-decreasing, older samples are counted in the newest pane.
+    /// </summary>
+    public void Add(long x, uint y)
+    {
+        _total.Add(x, y);
+        _totalSketch.Add(y);
+
+        long pane = x / _paneTicks;
+        if (pane > _newestPane)
+            AdvanceWindow(pane);
+        else if (_newestPane - pane >= WindowPanes)
+        {
+            // Time went back past the whole window, e.g. the data source's clock was reset. Start over.
+            ClearWindow();
+            AdvanceWindow(pane);
+        }
+
+        int slot = (int)(_newestPane % WindowPanes);
+        _panes[slot].Add(x, y);
+        _paneSketches[slot].Add(y);
+        _windowSketch.Add(y);
+    }
+
+    /// <summary>
+    /// Sets the duration of the sliding window, which clears the window's samples.
+    /// </summary>
+    /// <param name="windowTicks">The window's duration in X ticks</param>
+    public void SetWindow(double windowTicks)
+    {
+        _paneTicks = Math.Max(1, (long)Math.Ceiling(windowTicks / WindowPanes));
+        ClearWindow();
+    }
+
+    /// <summary>
+    /// Removes all samples, both from the totals and the window.
+    /// </summary>
+    public void Clear()
+    {
+        _total = default;
+        _totalSketch.Clear();
+        ClearWindow();
+    }
+
+    /// <summary>
+    /// Statistics of all samples added since the accumulator was cleared.
+    /// </summary>
+    /// <param name="ticksPerSecond">X ticks per second, to compute the sample rate</param>
+    public VariableStatistics GetTotal(double ticksPerSecond) =>
+        ToStatistics(_total, _totalSketch, ticksPerSecond);
+
+    /// <summary>
+    /// Statistics of the samples within the sliding window. Merges the window's panes, O(WindowPanes).
+    /// </summary>
+    /// <param name="ticksPerSecond">X ticks per second, to compute the sample rate</param>
+    public VariableStatistics GetWindow(double ticksPerSecond) =>
+        ToStatistics(MergeWindow(), _windowSketch, ticksPerSecond);
+
+    /// <summary>
+    /// Estimates a quantile of all samples, or of the samples within the sliding window.
+    /// </summary>
+    /// <param name="quantile">Fraction between 0 and 1, e.g. 0.99 for the 99th percentile</param>
+    /// <param name="window">True for the samples within the window, false for all samples</param>
+    /// <returns>The estimate, or NaN if there are no samples.</returns>
+    public double GetQuantile(double quantile, bool window)
+    {
+        RunningMoments moments = window ? MergeWindow() : _total;
+        return moments.Count == 0
+            ? double.NaN
+            : Math.Clamp((window ? _windowSketch : _totalSketch).Quantile(quantile), moments.Min, moments.Max);
+    }
+
+    // ===== Private Helpers ===== //
+    // Merges the panes within the window, oldest to newest so the newest pane's last sample ends up as the latest.
+    private RunningMoments MergeWindow()
+    {
+        RunningMoments window = default;
+        for (long pane = _newestPane - WindowPanes + 1; pane <= _newestPane; pane++)
+        {
+            if (pane < 0) continue;
+            int slot = (int)(pane % WindowPanes);
+            if (_paneNumbers[slot] == pane)
+                window.Merge(_panes[slot]);
+        }
+        return window;
+    }
+
+    // Starts the panes up to the given one, dropping the panes which leave the window.
+    private void AdvanceWindow(long pane)
+    {
+        if (pane - _newestPane >= WindowPanes)
+            ClearWindow(); // Every pane leaves the window.
+
+        for (long next = Math.Max(_newestPane + 1, pane - WindowPanes + 1); next <= pane; next++)
+        {
+            int slot = (int)(next % WindowPanes);
+            if (_paneNumbers[slot] >= 0)
+            {
+                _windowSketch.Subtract(_paneSketches[slot]);
+                _paneSketches[slot].Clear();
+                _panes[slot] = default;
+            }
+            _paneNumbers[slot] = next;
+        }
+        _newestPane = pane;
+    }
+
+    private void ClearWindow()
+    {
+        Array.Clear(_panes);
+        foreach (QuantileSketch sketch in _paneSketches)
+            sketch.Clear();
+        Array.Fill(_paneNumbers, -1);
+        _windowSketch.Clear();
+        _newestPane = -1;
+    }
+
+    private static VariableStatistics ToStatistics(in RunningMoments moments, QuantileSketch sketch,
+        double ticksPerSecond)
+    {
+        if (moments.Count == 0)
+            return VariableStatistics.Empty;
+
+        // Estimates are kept within the exact range, which makes them exact at the extremes.
+        uint min = moments.Min, max = moments.Max;
+        double Estimate(double quantile) => Math.Clamp(sketch.Quantile(quantile), min, max);
+
+        double span = (double)moments.LastX - moments.FirstX;
+        return new VariableStatistics(
+            moments.Count,
+            moments.Latest,
+            min,
+            max,
+            moments.Sum / moments.Count,
+            Math.Sqrt(moments.SumOfSquares / moments.Count),
+            moments.Count > 1 && span > 0 ? (moments.Count - 1) * ticksPerSecond / span : double.NaN,
+            Estimate(0.5),
+            Estimate(0.95));
+    }
+}
+
+/// <summary>
+/// Count, sums and extremes of a run of samples, from which the mean, RMS and sample rate follow.
+/// </summary>
+internal struct RunningMoments
+{
+    public long Count;
+    public double Sum;
+    public double SumOfSquares;
+    public uint Min;
+    public uint Max;
+    public uint Latest;
+    public long FirstX;
+    public long LastX;
+
+    public void Add(long x, uint y)
+    {
+        if (Count == 0)
+        {
+            Min = Max = y;
+            FirstX = x;
+        }
+        else
+        {
+            if (y < Min) Min = y;
+            if (y > Max) Max = y;
+        }
+        Latest = y;
+        LastX = x;
+        Count++;
+        Sum += y;
+        SumOfSquares += (double)y * y;
+    }
+
+    // Merges the moments of a run of samples which follows this one.
+    public void Merge(in RunningMoments next)
+    {
+        if (next.Count == 0) return;
+        if (Count == 0)
+        {
+            this = next;
+            return;
+        }
+        Min = Math.Min(Min, next.Min);
+        Max = Math.Max(Max, next.Max);
+        Latest = next.Latest;
+        LastX = next.LastX;
+        Count += next.Count;
+        Sum += next.Sum;
+        SumOfSquares += next.SumOfSquares;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,11 @@
+﻿namespace RealtimePlottingApp.Models;
+
+/// <summary>
+/// Enum representing which crossings of the trigger level cause a trigger.
+/// </summary>
+public enum TriggerEdge
+{
+    Rising,
+    Falling,
+    Either,
+}
\ No newline at end of file
@@ -0,0 +1,7 @@
+﻿namespace RealtimePlottingApp.Models;
+
+/// <summary>
+/// Identifies the sample that fired a trigger: the variable it belongs to,
+/// and its absolute index within that variable's column in the GraphDataModel.
+/// </summary>
+public readonly record struct TriggerPoint(int Variable, long SampleIndex);
\ No newline at end of file
@@ -1,7 +1,8 @@
 ﻿namespace RealtimePlottingApp.Models;
 
 /// <summary>
-/// Represents one package received from a serial reader, consisting of data value and timestamp.
+/// Represents one package received from a serial reader, consisting of data value and timestamp,
+/// and for framed transmissions the variable it belongs to.
 /// </summary>
 public struct UARTTimestampedData
 {
@@ -11,7 +12,13 @@ public struct UARTTimestampedData
     public uint Data { get; set; }
     
     /// <summary>
-    /// A timestamp which accompanies the data.
+    /// A timestamp which accompanies the data, 8, 16 or 32 bits depending on the protocol.
     /// </summary>
-    public ushort Time { get; set; }
+    public uint Time { get; set; }
+
+    /// <summary>
+    /// Index of the variable within its frame, or -1 for unframed packages,
+    /// whose variable is only given by the order they are transmitted in.
+    /// </summary>
+    public int Variable { get; set; }
 }
\ No newline at end of file
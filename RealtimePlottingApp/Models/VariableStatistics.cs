@@ -0,0 +1,25 @@
+﻿namespace RealtimePlottingApp.Models;
+
+/// <summary>
+/// Summary of one variable's samples, either since the data was cleared or over a sliding window.
+/// All values are NaN (and Count is 0) if there are no samples.
+/// </summary>
+/// <param name="Count">Number of samples summarized</param>
+/// <param name="Latest">Value of the newest sample</param>
+/// <param name="Min">Smallest value</param>
+/// <param name="Max">Largest value</param>
+/// <param name="Mean">Arithmetic mean of the values</param>
+/// <param name="Rms">Root mean square of the values</param>
+/// <param name="SampleRate">Samples per second between the first and newest sample, NaN for fewer than 2 samples</param>
+/// <param name="Median">Estimated median, see QuantileSketch</param>
+/// <param name="Percentile95">Estimated 95th percentile, see QuantileSketch</param>
+public readonly record struct VariableStatistics(
+    long Count, double Latest, double Min, double Max, double Mean, double Rms,
+    double SampleRate, double Median, double Percentile95)
+{
+    /// <summary>
+    /// Statistics of no samples.
+    /// </summary>
+    public static VariableStatistics Empty => new(0, double.NaN, double.NaN, double.NaN, double.NaN,
+        double.NaN, double.NaN, double.NaN, double.NaN);
+}
\ No newline at end of file
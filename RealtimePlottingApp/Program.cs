@@ -1,6 +1,7 @@
 ﻿using Avalonia;
 using System;
 using Avalonia.ReactiveUI;
+using RealtimePlottingApp.Services.Headless;
 
 namespace RealtimePlottingApp;
 
@@ -10,8 +11,14 @@ sealed class Program
     // SynchronizationContext-reliant code before AppMain is called: things aren't initialized
     // yet and stuff might break.
     [STAThread]
-    public static void Main(string[] args) => BuildAvaloniaApp()
-        .StartWithClassicDesktopLifetime(args);
+    public static int Main(string[] args)
+    {
+        // Headless captures run without Avalonia, see HeadlessOptions.Usage.
+        if (HeadlessOptions.IsRequested(args))
+            return HeadlessCapture.Run(args);
+
+        return BuildAvaloniaApp().StartWithClassicDesktopLifetime(args);
+    }
 
     // Avalonia configuration, don't remove; also used by visual designer.
     public static AppBuilder BuildAvaloniaApp()
@@ -0,0 +1,157 @@
+﻿using System;
+using System.Collections.Generic;
+using RealtimePlottingApp.Models;
+
+namespace RealtimePlottingApp.Services.CAN
+{
+    /// <summary>
+    /// A CAN data payload mask compiled into the bit extraction steps of each of its variables.
+    /// Compiling once per connection means decoding a frame is only a few shifts per variable,
+    /// without any string handling or allocation.
+    /// </summary>
+    /// <remarks>
+    /// Supports payloads of up to 64 bytes (CAN FD), and variables whose decoded values fit in 32 bits.
+    /// Plans are created from a mask string by ConfigParser.CompileCanDataMask.
+    /// </remarks>
+    public sealed class CanPayloadPlan
+    {
+        /// <summary>
+        /// Largest payload a CAN (FD) frame can carry, in bytes.
+        /// </summary>
+        public const int MaxPayloadLength = 64;
+
+        // A run of bits within one payload byte: (data[ByteIndex] >> Shift) & ((1 << Width) - 1)
+        private readonly record struct Step(int ByteIndex, int Shift, int Width);
+
+        private sealed class Field(Step[] steps, int bits, CanFieldFormat format)
+        {
+            public readonly Step[] Steps = steps;
+            public readonly int Bits = bits;
+            public readonly CanFieldFormat Format = format;
+        }
+
+        private readonly Field[] _fields;
+
+        /// <summary>
+        /// Index of the graph variable that the plan's first variable is stored as.
+        /// Following variables are stored at consecutive indices.
+        /// </summary>
+        public int FirstVariable { get; }
+
+        /// <summary>
+        /// Number of variables decoded from each frame.
+        /// </summary>
+        public int VariableCount => _fields.Length;
+
+        /// <summary>
+        /// Minimum payload length in bytes a frame must have to be decoded.
+        /// </summary>
+        public int PayloadLength { get; }
+
+        /// <summary>
+        /// Compiles the nibble assignment of a mask into a plan.
+        /// </summary>
+        /// <param name="nibbles">For each payload nibble, most significant nibble of byte 0 first,
+        /// the local variable number (0-based) it belongs to, or -1 if unused</param>
+        /// <param name="formats">Format of each local variable, indexed by variable number</param>
+        /// <param name="firstVariable">Graph variable index of the plan's first variable</param>
+        /// <exception cref="FormatException">Thrown if a variable is missing, wider than 64 bits,
+        /// or can't be stored as an unsigned sample, see CompileField.</exception>
+        public CanPayloadPlan(ReadOnlySpan<int> nibbles, IReadOnlyList<CanFieldFormat> formats, int firstVariable)
+        {
+            if (nibbles.Length > MaxPayloadLength * 2)
+                throw new FormatException($"Mask is longer than {MaxPayloadLength} bytes.");
+
+            FirstVariable = firstVariable;
+            _fields = new Field[formats.Count];
+            for (int v = 0; v < _fields.Length; v++)
+            {
+                _fields[v] = CompileField(nibbles, v, formats[v]);
+                foreach (Step step in _fields[v].Steps)
+                    PayloadLength = Math.Max(PayloadLength, step.ByteIndex + 1);
+            }
+        }
+
+        /// <summary>
+        /// Decodes the plan's variables from a frame's payload.
+        /// </summary>
+        /// <param name="data">The frame's payload</param>
+        /// <param name="values">Receives the value of each variable, must hold at least VariableCount values</param>
+        /// <returns>False if the payload is too short for the mask, in which case nothing is decoded.</returns>
+        public bool TryDecode(ReadOnlySpan<byte> data, Span<double> values)
+        {
+            if (data.Length < PayloadLength)
+                return false;
+
+            for (int v = 0; v < _fields.Length; v++)
+            {
+                Field field = _fields[v];
+                ulong raw = 0;
+                foreach (Step step in field.Steps)
+                    raw = (raw << step.Width) | (uint)((data[step.ByteIndex] >> step.Shift) & ((1 << step.Width) - 1));
+
+                double value;
+                if (field.Format.Signed)
+                {
+                    // Move the sign bit to the top, then shift back arithmetically to sign-extend.
+                    int unused = 64 - field.Bits;
+                    value = (long)(raw << unused) >> unused;
+                }
+                else
+                {
+                    value = raw;
+                }
+                values[v] = value * field.Format.Scale + field.Format.Offset;
+            }
+            return true;
+        }
+
+        // Collects the nibbles of variable v into steps, in order of decreasing significance.
+        // The graph data stores unsigned 32-bit whole samples, so formats which decode to fractional values,
+        // or to values outside that range, are rejected rather than rounded and clamped.
+        // Signed variables need an offset to keep them non-negative.
+        private static Field CompileField(ReadOnlySpan<int> nibbles, int v, CanFieldFormat format)
+        {
+            List<Step> steps = [];
+            int bytes = (nibbles.Length + 1) / 2;
+            for (int n = 0; n < bytes; n++)
+            {
+                // Big-endian: the lowest byte is the most significant, little-endian reverses the bytes.
+                int b = format.LittleEndian ? bytes - 1 - n : n;
+                bool high = nibbles[2 * b] == v;
+                bool low = 2 * b + 1 < nibbles.Length && nibbles[2 * b + 1] == v;
+
+                if (high && low) steps.Add(new Step(b, 0, 8)); // Case "ii", the full byte
+                else if (high) steps.Add(new Step(b, 4, 4));   // Case "i_"
+                else if (low) steps.Add(new Step(b, 0, 4));    // Case "_i"
+            }
+
+            int bits = 0;
+            foreach (Step step in steps)
+                bits += step.Width;
+
+            if (bits == 0)
+                throw new FormatException($"Variable {v + 1} is not present in the mask.");
+            if (bits > 64)
+                throw new FormatException($"Variable {v + 1} is wider than 64 bits.");
+
+            if (!double.IsInteger(format.Scale) || !double.IsInteger(format.Offset))
+                throw new FormatException($"Variable {v + 1} has a fractional scale or offset, " +
+                                          "but samples are stored as whole numbers.");
+            if (format.Scale == 0)
+                throw new FormatException($"Variable {v + 1} has a scale of 0.");
+
+            double lowestRaw = format.Signed ? -Math.Pow(2, bits - 1) : 0;
+            double highestRaw = format.Signed ? Math.Pow(2, bits - 1) - 1 : Math.Pow(2, bits) - 1;
+            double lowest = Math.Min(lowestRaw * format.Scale, highestRaw * format.Scale) + format.Offset;
+            double highest = Math.Max(lowestRaw * format.Scale, highestRaw * format.Scale) + format.Offset;
+            if (lowest < 0)
+                throw new FormatException($"Variable {v + 1} decodes to values as low as {lowest:R}, " +
+                                          "but samples are stored unsigned. Add an offset to keep it non-negative.");
+            if (highest > uint.MaxValue)
+                throw new FormatException($"Variable {v + 1} decodes to values as high as {highest:R}, " +
+                                          "but samples are stored in 32 bits.");
+            return new Field(steps.ToArray(), bits, format);
+        }
+    }
+}
\ No newline at end of file
@@ -1,4 +1,5 @@
 ﻿using System;
+using System.Collections.Generic;
 using RealtimePlottingApp.Events;
 
 namespace RealtimePlottingApp.Services.CAN
@@ -10,6 +11,17 @@ namespace RealtimePlottingApp.Services.CAN
     /// </summary>
     public interface ICanBus
     {
+        // IDs of the messages to receive, or null to receive all messages.
+        // Set before connecting, implementations filter as close to the hardware as they can.
+        IReadOnlyCollection<uint>? CanIdFilters { get; set; }
+
+        // Number of ticks per second of the message timestamps, i.e. their resolution.
+        double TicksPerSecond { get; }
+
+        // Width of the message timestamps in bits. Timestamps narrower than 64 bits wrap around,
+        // which the graph data model unwraps.
+        int TimestampBits { get; }
+
         // Connect to the CAN bus at the specified interface  
         void Connect(string interfaceName, string? bitrate);
 
@@ -1,11 +1,13 @@
 ﻿using System;
 using System.Collections.Concurrent;
+using System.Collections.Generic;
 using System.Diagnostics;
 using System.Linq;
 using System.Threading;
 using Peak.Can.Basic;
 using Peak.Can.Basic.BackwardCompatibility;
 using RealtimePlottingApp.Events;
+using RealtimePlottingApp.Services.Diagnostics;
 
 namespace RealtimePlottingApp.Services.CAN
 {
@@ -27,6 +29,8 @@ namespace RealtimePlottingApp.Services.CAN
         // It is essentially an observer pattern implementation for the CAN bus,
         // where the application can subscribe to the event to receive messages.
         public event EventHandler<CanMessageReceivedEvent>? MessageReceived;
+        // IDs to receive, PCAN-Basic only filters ID ranges, so the IDs are checked as messages are read.
+        private HashSet<uint>? _canIdFilters;
         // Maximum length of CAN data in bytes
         private const int MaxCanDataLength = 8;
         
@@ -52,6 +56,17 @@ namespace RealtimePlottingApp.Services.CAN
             _stopwatch = new Stopwatch();
         }
         
+        public IReadOnlyCollection<uint>? CanIdFilters
+        {
+            get => _canIdFilters;
+            set => _canIdFilters = value == null ? null : [..value];
+        }
+
+        // Messages are timestamped by a stopwatch when they are read, in milliseconds.
+        public double TicksPerSecond => 1000.0 / msInterval;
+
+        public int TimestampBits => 32;
+
         public void Connect(string interfaceName, string? bitrate)
         {
             if (!TryGetPcanChannel(interfaceName, out _channel))
@@ -189,13 +204,16 @@ namespace RealtimePlottingApp.Services.CAN
             {
                 TPCANMsg message;
                 TPCANStatus status = PCANBasic.Read((ushort)_channel, out message);
-                if (status == TPCANStatus.PCAN_ERROR_OK && message.LEN > 0)
+                if (status == TPCANStatus.PCAN_ERROR_OK && message.LEN > 0 &&
+                    _canIdFilters?.Contains(message.ID) != false)
                 {
+                    PipelineMetrics.CanFramesReceived.Add(1);
                     if (!_bufferPool.TryDequeue(out byte[]? buffer))
                     {
                         // Fallback if pool isn't enough. We prefer to not allocate new ones and use the
                         // pool to save recieve performance and leave less work for garbage collector.
                         buffer = new byte[MaxCanDataLength];
+                        PipelineMetrics.CanPoolAllocations.Add(1);
                     }
                     // Copy data into the borrowed buffer.
                     if (buffer == null) continue;
@@ -203,6 +221,7 @@ namespace RealtimePlottingApp.Services.CAN
 
                     // Enqueue the message for processing.
                     _messageQueue.Enqueue((message.ID, message.LEN, buffer));
+                    PipelineMetrics.CanQueueDepth.Add(1);
                 }
             }
         }
@@ -216,6 +235,7 @@ namespace RealtimePlottingApp.Services.CAN
                     
                     while (_messageQueue.TryDequeue(out var msg))
                     {
+                        PipelineMetrics.CanQueueDepth.Add(-1);
                         try
                         {
                             // Calculate timestamp as integer value, and divide by msInterval
@@ -1,11 +1,12 @@
 ﻿using System;
 using System.Collections.Concurrent;
-using System.Diagnostics;
+using System.Collections.Generic;
 using SocketCANSharp;
 using System.Threading;
 using System.Net.Sockets;
 using System.Linq;
 using RealtimePlottingApp.Events;
+using RealtimePlottingApp.Services.Diagnostics;
 using SocketCANSharp.Network;
 
 namespace RealtimePlottingApp.Services.CAN
@@ -17,11 +18,16 @@ namespace RealtimePlottingApp.Services.CAN
     /// <remarks>
     /// This implementation is based on the SocketCAN-Sharp library made by derek-will, which is a C# wrapper for the SocketCAN API.
     /// The SocketCAN API is a set of open-source CAN drivers for Linux, which allows applications to communicate with CAN devices.
+    /// Receiving bypasses the library and is done in batches by a SocketCanReceiver, with ID filtering
+    /// in the kernel and kernel timestamps. This can be tried out without hardware on a virtual CAN interface:
+    /// `sudo ip link add dev vcan0 type vcan &amp;&amp; sudo ip link set up vcan0`, then send frames with `cangen vcan0`.
     /// </remarks>
     public class SocketCanBus : ICanBus
     {
         // SocketCAN socket instance for communication
         private RawCanSocket? _socket;
+        // Batched, kernel-filtered and timestamped reading from the socket
+        private SocketCanReceiver? _receiver;
         // Thread for receiving messages from the CAN bus to avoid blocking the main thread
         private Thread? _receiveThread;
         // Thread for processing queued messages.
@@ -35,28 +41,38 @@ namespace RealtimePlottingApp.Services.CAN
         public event EventHandler<CanMessageReceivedEvent>? MessageReceived;
         // Maximum length of CAN data in bytes
         private const int MaxCanDataLength = 8;
+        // Maximum length of CAN FD data in bytes, the size of receive buffers.
+        private const int MaxCanFdDataLength = 64;
+        // How long a blocked receive or handoff waits before checking whether to stop.
+        private static readonly TimeSpan StopCheckInterval = TimeSpan.FromMilliseconds(100);
         
-        // Concurrent queue which holds received messages
-        private readonly ConcurrentQueue<(uint canId, int length, byte[] buffer)> _messageQueue 
-            = new ConcurrentQueue<(uint canId, int length, byte[] buffer)>();
+        // Blocking queue which hands received messages from the receive thread to the processing thread.
+        private readonly BlockingCollection<(uint canId, int length, byte[] buffer, long timestamp)> _messageQueue 
+            = new BlockingCollection<(uint canId, int length, byte[] buffer, long timestamp)>();
         
         // Preallocated pool of byte arrays
         private readonly ConcurrentQueue<byte[]?> _bufferPool = new ConcurrentQueue<byte[]?>();
         
-        // Stopwatch for timestamping messages.
-        private readonly Stopwatch _stopwatch;
-        private const int msInterval = 1; // Invoked resolution of timestamps.
+        // System time of connecting, which message timestamps are relative to.
+        private long _connectTimeNs;
+        private const int usInterval = 1; // Invoked resolution of timestamps, in microseconds.
 
         public SocketCanBus()
         {
             // Preallocate buffers to be reused as a receive pool
             for (int i = 0; i < 100; i++)
             {
-                _bufferPool.Enqueue(new byte[MaxCanDataLength]);
+                _bufferPool.Enqueue(new byte[MaxCanFdDataLength]);
             }
-            
-            _stopwatch = new Stopwatch();
         }
+
+        public IReadOnlyCollection<uint>? CanIdFilters { get; set; }
+
+        // Kernel timestamps have nanosecond resolution, so frames are timestamped in microseconds.
+        public double TicksPerSecond => 1_000_000.0 / usInterval;
+
+        // Kernel timestamps are 64-bit, so they are passed on without wrapping around.
+        public int TimestampBits => 64;
         
         public void Connect(string interfaceName, string? bitrate)
         {
@@ -81,9 +97,17 @@ namespace RealtimePlottingApp.Services.CAN
                 _socket = new RawCanSocket();
                 _socket.Bind(canInterface);
 
+                // Let the kernel drop unwanted IDs, and timestamp frames as they arrive.
+                _receiver = new SocketCanReceiver((int)_socket.SafeHandle.DangerousGetHandle());
+                _receiver.SetFilters(CanIdFilters);
+                _receiver.EnableCanFd(); // Classic frames are still received if not supported.
+                if (!_receiver.EnableTimestamps())
+                    Console.WriteLine("Kernel timestamps unavailable, timestamping frames when read.");
+                _receiver.SetReceiveTimeout(StopCheckInterval);
+
                 // Set the socket to a listening state, initialization is successful.
                 _running = true;
-                _stopwatch.Restart(); // Start a fresh timer.
+                _connectTimeNs = SocketCanReceiver.CurrentTimeNs(); // Start a fresh timer.
 
                 // Start the receiving thread in the background to read messages
                 _receiveThread = new Thread(ReceiveMessages) { IsBackground = true };
@@ -120,9 +144,16 @@ namespace RealtimePlottingApp.Services.CAN
             {
                 _processThread.Join();
             }
-            _stopwatch.Reset(); // Stop & zero-set.
             _socket?.Close();
             _socket = null;
+            _receiver = null;
+
+            // Return buffers of messages that were never processed.
+            while (_messageQueue.TryTake(out var msg))
+            {
+                _bufferPool.Enqueue(msg.buffer);
+                PipelineMetrics.CanQueueDepth.Add(-1);
+            }
         }
 
         public int SendMessage(uint canId, byte[] data)
@@ -152,28 +183,39 @@ namespace RealtimePlottingApp.Services.CAN
 
         private void ReceiveMessages()
         {
-            while (_running)
+            SocketCanReceiver? receiver = _receiver;
+            while (_running && receiver != null)
             {
                 try
                 {
-                    CanFrame frame = new CanFrame();
-                    _socket?.Read(out frame);
-
-                    if (frame.Length > 0 && frame.Data != null)
+                    // Blocks until frames arrive, or the timeout expires with none.
+                    int count = receiver.Receive();
+                    for (int i = 0; i < count; i++)
                     {
+                        if (!receiver.GetFrame(i, out uint canId, out ReadOnlySpan<byte> data, out long timestampNs)
+                            || data.Length == 0)
+                            continue;
+
                         if (!_bufferPool.TryDequeue(out byte[]? buffer))
                         {
                             // Fallback if pool isn't enough. We prefer to not allocate new ones and use the
                             // pool to save recieve performance and leave less work for garbage collector.
-                            buffer = new byte[MaxCanDataLength];
+                            buffer = new byte[MaxCanFdDataLength];
+                            PipelineMetrics.CanPoolAllocations.Add(1);
                         }
                         // Copy data into the borrowed buffer.
                         if (buffer == null) continue;
-                        Array.Copy(frame.Data, buffer, frame.Length);
+                        data.CopyTo(buffer);
 
-                        // Enqueue the message for processing.
-                        _messageQueue.Enqueue((frame.CanId, frame.Length, buffer));
+                        // Calculate timestamp from when the kernel received the frame as integer value,
+                        // and divide by usInterval to get a specified resolution.
+                        long timestamp = Math.Max(timestampNs - _connectTimeNs, 0) / 1_000 / usInterval;
+
+                        // Hand the message to the processing thread.
+                        _messageQueue.Add((canId, data.Length, buffer, timestamp));
+                        PipelineMetrics.CanQueueDepth.Add(1);
                     }
+                    PipelineMetrics.CanFramesReceived.Add(count);
                 }
                 catch (SocketException e)
                 {
@@ -189,34 +231,24 @@ namespace RealtimePlottingApp.Services.CAN
             {
                 try
                 {
-                   
-                    while (_messageQueue.TryDequeue(out var msg))
+                    // Block until a message is handed off, waking up regularly to check whether to stop.
+                    if (!_messageQueue.TryTake(out var msg, StopCheckInterval))
+                        continue;
+                    PipelineMetrics.CanQueueDepth.Add(-1);
+
+                    try
                     {
-                        try
-                        {
-                            // Calculate timestamp as integer value, and divide by msInterval
-                            // to get a specified resolution
-                            uint timestamp = (uint)(_stopwatch.ElapsedMilliseconds / msInterval);
-                            
-                            MessageReceived?.Invoke(this, new CanMessageReceivedEvent(
-                                msg.canId, 
-                                msg.buffer.Take(msg.length).ToArray(),
-                                timestamp)
-                            );
-                        }
-                        catch (Exception ex)
-                        {
-                            Console.WriteLine($"Error in MessageReceived handler: {ex.Message}");
-                        }
-                        _bufferPool.Enqueue(msg.buffer);
+                        MessageReceived?.Invoke(this, new CanMessageReceivedEvent(
+                            msg.canId, 
+                            msg.buffer.AsSpan(0, msg.length).ToArray(),
+                            msg.timestamp)
+                        );
                     }
-                    
-                    // Sleep shortly to reduce CPU usage if no messages are in the queue.
-                    if (_messageQueue.IsEmpty)
+                    catch (Exception ex)
                     {
-                        Thread.Sleep(1);
+                        Console.WriteLine($"Error in MessageReceived handler: {ex.Message}");
                     }
-                    
+                    _bufferPool.Enqueue(msg.buffer);
                 }
                 catch (Exception e)
                 {
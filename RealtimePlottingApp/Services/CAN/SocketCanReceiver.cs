@@ -0,0 +1,293 @@
+﻿using System;
+using System.Buffers.Binary;
+using System.Collections.Generic;
+using System.Net.Sockets;
+using System.Runtime.InteropServices;
+
+namespace RealtimePlottingApp.Services.CAN
+{
+    /// <summary>
+    /// Batched receiving of frames from a raw SocketCAN socket.
+    /// Frames are read many at a time with recvmmsg, into buffers that are allocated once,
+    /// and each is timestamped by the kernel when it was received (by hardware if the interface supports it).
+    /// ID filters are applied by the kernel, so frames which aren't needed never reach the application.
+    /// </summary>
+    /// <remarks>
+    /// The socket itself is owned by the caller, this only reads from it.
+    /// Struct layouts assume a 64-bit Linux system.
+    /// </remarks>
+    public sealed class SocketCanReceiver
+    {
+        // ===== Linux constants ===== //
+        private const int SOL_SOCKET = 1;
+        private const int SO_RCVTIMEO = 20;
+        private const int SO_TIMESTAMPNS = 35;
+        private const int SO_TIMESTAMPING = 37;
+        private const int SOL_CAN_RAW = 101;
+        private const int CAN_RAW_FILTER = 1;
+        private const int CAN_RAW_FD_FRAMES = 5;
+        private const int SOF_TIMESTAMPING_RX_HARDWARE = 1 << 2;
+        private const int SOF_TIMESTAMPING_RX_SOFTWARE = 1 << 3;
+        private const int SOF_TIMESTAMPING_SOFTWARE = 1 << 4;
+        private const int SOF_TIMESTAMPING_RAW_HARDWARE = 1 << 6;
+        private const int MSG_WAITFORONE = 0x10000;
+        private const int EAGAIN = 11;
+        private const int EINTR = 4;
+
+        private const uint CAN_EFF_FLAG = 0x80000000; // Extended (29 bit) identifier
+        private const uint CAN_RTR_FLAG = 0x40000000; // Remote transmission request
+        private const uint CAN_ERR_FLAG = 0x20000000; // Error frame
+        private const uint CAN_SFF_MASK = 0x000007FF;
+        private const uint CAN_EFF_MASK = 0x1FFFFFFF;
+
+        private const int CanFdMtu = 72;       // sizeof(struct canfd_frame)
+        private const int CanDataOffset = 8;   // Payload offset in both can_frame and canfd_frame
+        private const int ControlLength = 64;  // Room for one SCM_TIMESTAMPING message (16 byte header + 3 timespecs)
+
+        // ===== Native structures ===== //
+        [StructLayout(LayoutKind.Sequential)]
+        private struct IoVec
+        {
+            public IntPtr Base;
+            public nuint Length;
+        }
+
+        [StructLayout(LayoutKind.Sequential)]
+        private struct MsgHdr
+        {
+            public IntPtr Name;
+            public uint NameLength;
+            public IntPtr Iov;
+            public nuint IovLength;
+            public IntPtr Control;
+            public nuint ControlLength;
+            public int Flags;
+        }
+
+        [StructLayout(LayoutKind.Sequential)]
+        private struct MMsgHdr
+        {
+            public MsgHdr Header;
+            public uint Length; // Bytes received for this message
+        }
+
+        [StructLayout(LayoutKind.Sequential)]
+        private struct CanFilter(uint id, uint mask)
+        {
+            public uint Id = id;
+            public uint Mask = mask;
+        }
+
+        [StructLayout(LayoutKind.Sequential)]
+        private struct TimeVal(long seconds, long microseconds)
+        {
+            public long Seconds = seconds;
+            public long Microseconds = microseconds;
+        }
+
+        [DllImport("libc", SetLastError = true)]
+        private static extern int recvmmsg(int fd, [In, Out] MMsgHdr[] messages, uint length, int flags, IntPtr timeout);
+
+        [DllImport("libc", SetLastError = true)]
+        private static extern int setsockopt(int fd, int level, int name, ref int value, uint length);
+
+        [DllImport("libc", SetLastError = true)]
+        private static extern int setsockopt(int fd, int level, int name, ref TimeVal value, uint length);
+
+        [DllImport("libc", SetLastError = true)]
+        private static extern int setsockopt(int fd, int level, int name, [In] CanFilter[]? value, uint length);
+
+        // ===== Instance Variables ===== //
+        private readonly int _fd;
+        private readonly MMsgHdr[] _messages;
+        // Pinned, so the kernel can write into them through the pointers held by _messages.
+        private readonly IoVec[] _iovecs;
+        private readonly byte[] _frames;
+        private readonly byte[] _control;
+
+        private int _count; // Messages received by the last Receive()
+        private long? _hardwareClockOffset; // Hardware clock to system clock, in ns
+
+        /// <summary>
+        /// Creates a receiver for a bound raw CAN socket.
+        /// </summary>
+        /// <param name="fd">The socket's file descriptor</param>
+        /// <param name="batchSize">Most frames read by one Receive() call</param>
+        public SocketCanReceiver(int fd, int batchSize = 64)
+        {
+            _fd = fd;
+            _messages = new MMsgHdr[batchSize];
+            _iovecs = GC.AllocateArray<IoVec>(batchSize, pinned: true);
+            _frames = GC.AllocateArray<byte>(batchSize * CanFdMtu, pinned: true);
+            _control = GC.AllocateArray<byte>(batchSize * ControlLength, pinned: true);
+
+            for (int i = 0; i < batchSize; i++)
+            {
+                _iovecs[i].Base = Marshal.UnsafeAddrOfPinnedArrayElement(_frames, i * CanFdMtu);
+                _iovecs[i].Length = CanFdMtu;
+                _messages[i].Header.Iov = Marshal.UnsafeAddrOfPinnedArrayElement(_iovecs, i);
+                _messages[i].Header.IovLength = 1;
+                _messages[i].Header.Control = Marshal.UnsafeAddrOfPinnedArrayElement(_control, i * ControlLength);
+            }
+        }
+
+        // ===== Configuration ===== //
+        /// <summary>
+        /// Makes the kernel only deliver data frames with the given IDs, or every frame if null.
+        /// IDs above the 11-bit range are matched as extended (29-bit) identifiers.
+        /// </summary>
+        /// <exception cref="SocketException">Thrown if the kernel rejects the filters.</exception>
+        public void SetFilters(IReadOnlyCollection<uint>? canIds)
+        {
+            CanFilter[]? filters = null;
+            if (canIds != null)
+            {
+                filters = new CanFilter[canIds.Count];
+                int i = 0;
+                foreach (uint canId in canIds)
+                {
+                    // Match the ID, whether it is extended, and that it's not a remote request.
+                    filters[i++] = canId > CAN_SFF_MASK
+                        ? new CanFilter(canId | CAN_EFF_FLAG, CAN_EFF_MASK | CAN_EFF_FLAG | CAN_RTR_FLAG)
+                        : new CanFilter(canId, CAN_SFF_MASK | CAN_EFF_FLAG | CAN_RTR_FLAG);
+                }
+            }
+
+            // Without IDs, a filter matching everything restores the kernel's default.
+            // An empty list of IDs removes all filters, so nothing is received.
+            filters ??= [new CanFilter(0, 0)];
+
+            if (setsockopt(_fd, SOL_CAN_RAW, CAN_RAW_FILTER, filters, (uint)(filters.Length * 8)) < 0)
+                throw new SocketException(Marshal.GetLastPInvokeError());
+        }
+
+        /// <summary>
+        /// Requests CAN FD frames in addition to classic frames, so payloads of up to 64 bytes are received.
+        /// </summary>
+        /// <returns>False if the interface or kernel does not support CAN FD.</returns>
+        public bool EnableCanFd()
+        {
+            int enable = 1;
+            return setsockopt(_fd, SOL_CAN_RAW, CAN_RAW_FD_FRAMES, ref enable, sizeof(int)) == 0;
+        }
+
+        /// <summary>
+        /// Requests receive timestamps from the kernel, using hardware timestamps where the interface has them.
+        /// </summary>
+        /// <returns>False if the kernel timestamps are unavailable, then frames are timestamped when read.</returns>
+        public bool EnableTimestamps()
+        {
+            int flags = SOF_TIMESTAMPING_RX_HARDWARE | SOF_TIMESTAMPING_RAW_HARDWARE |
+                        SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+            if (setsockopt(_fd, SOL_SOCKET, SO_TIMESTAMPING, ref flags, sizeof(int)) == 0)
+                return true;
+
+            int enable = 1; // Fall back to software timestamps only.
+            return setsockopt(_fd, SOL_SOCKET, SO_TIMESTAMPNS, ref enable, sizeof(int)) == 0;
+        }
+
+        /// <summary>
+        /// Sets how long Receive() blocks without any frames before returning 0.
+        /// </summary>
+        /// <exception cref="SocketException">Thrown if the kernel rejects the timeout.</exception>
+        public void SetReceiveTimeout(TimeSpan timeout)
+        {
+            long microseconds = (long)timeout.TotalMicroseconds;
+            TimeVal value = new(microseconds / 1_000_000, microseconds % 1_000_000);
+            if (setsockopt(_fd, SOL_SOCKET, SO_RCVTIMEO, ref value, (uint)Marshal.SizeOf<TimeVal>()) < 0)
+                throw new SocketException(Marshal.GetLastPInvokeError());
+        }
+
+        // ===== Receiving ===== //
+        /// <summary>
+        /// Blocks until at least one frame is received, then reads as many as are queued up to the batch size.
+        /// The frames are available through GetFrame() until the next call.
+        /// </summary>
+        /// <returns>The number of frames received, or 0 if the receive timeout expired.</returns>
+        /// <exception cref="SocketException">Thrown if reading from the socket fails.</exception>
+        public int Receive()
+        {
+            for (int i = 0; i < _messages.Length; i++)
+                _messages[i].Header.ControlLength = ControlLength; // Updated by the kernel on every read.
+
+            int count = recvmmsg(_fd, _messages, (uint)_messages.Length, MSG_WAITFORONE, IntPtr.Zero);
+            if (count < 0)
+            {
+                int error = Marshal.GetLastPInvokeError();
+                _count = 0;
+                if (error is EAGAIN or EINTR)
+                    return 0;
+                throw new SocketException(error);
+            }
+
+            _count = count;
+            return count;
+        }
+
+        /// <summary>
+        /// Gets a frame read by the last Receive().
+        /// </summary>
+        /// <param name="index">Index of the frame, below the count returned by Receive()</param>
+        /// <param name="canId">The frame's identifier, without flags</param>
+        /// <param name="data">The frame's payload, only valid until the next Receive()</param>
+        /// <param name="timestampNs">When the frame was received, in ns since the Unix epoch</param>
+        /// <returns>False for remote request and error frames, which carry no data.</returns>
+        public bool GetFrame(int index, out uint canId, out ReadOnlySpan<byte> data, out long timestampNs)
+        {
+            if ((uint)index >= (uint)_count)
+                throw new ArgumentOutOfRangeException(nameof(index));
+
+            ReadOnlySpan<byte> frame = _frames.AsSpan(index * CanFdMtu, (int)_messages[index].Length);
+            uint rawId = BinaryPrimitives.ReadUInt32LittleEndian(frame);
+            int length = Math.Min((int)frame[4], frame.Length - CanDataOffset);
+
+            canId = (rawId & CAN_EFF_FLAG) != 0 ? rawId & CAN_EFF_MASK : rawId & CAN_SFF_MASK;
+            data = frame.Slice(CanDataOffset, Math.Max(length, 0));
+            timestampNs = GetTimestamp(index);
+            return (rawId & (CAN_RTR_FLAG | CAN_ERR_FLAG)) == 0;
+        }
+
+        // Reads the kernel timestamp of a message from its control messages.
+        private long GetTimestamp(int index)
+        {
+            ReadOnlySpan<byte> control = _control.AsSpan(index * ControlLength,
+                (int)Math.Min(_messages[index].Header.ControlLength, ControlLength));
+
+            // struct cmsghdr { size_t len; int level; int type; data (aligned to 8 bytes) }
+            while (control.Length >= 16)
+            {
+                int length = (int)BinaryPrimitives.ReadUInt64LittleEndian(control);
+                int level = BinaryPrimitives.ReadInt32LittleEndian(control[8..]);
+                int type = BinaryPrimitives.ReadInt32LittleEndian(control[12..]);
+                if (length < 16 || length > control.Length) break;
+
+                if (level == SOL_SOCKET && type == SO_TIMESTAMPING && length >= 16 + 3 * 16)
+                {
+                    // Three timespecs: software, (deprecated), raw hardware.
+                    long software = ReadTimeSpec(control[16..]);
+                    long hardware = ReadTimeSpec(control[48..]);
+                    if (hardware == 0)
+                        return software;
+
+                    // The hardware clock has its own epoch, align it once to the system clock.
+                    _hardwareClockOffset ??= (software != 0 ? software : CurrentTimeNs()) - hardware;
+                    return hardware + _hardwareClockOffset.Value;
+                }
+                if (level == SOL_SOCKET && type == SO_TIMESTAMPNS && length >= 16 + 16)
+                    return ReadTimeSpec(control[16..]);
+
+                control = control[Math.Min((length + 7) & ~7, control.Length)..];
+            }
+
+            return CurrentTimeNs(); // No kernel timestamp, use the time it was read.
+        }
+
+        private static long ReadTimeSpec(ReadOnlySpan<byte> span) =>
+            BinaryPrimitives.ReadInt64LittleEndian(span) * 1_000_000_000 + BinaryPrimitives.ReadInt64LittleEndian(span[8..]);
+
+        /// <summary>
+        /// The current system time on the same clock as the frame timestamps, in ns since the Unix epoch.
+        /// </summary>
+        public static long CurrentTimeNs() => (DateTime.UtcNow - DateTime.UnixEpoch).Ticks * 100;
+    }
+}
\ No newline at end of file
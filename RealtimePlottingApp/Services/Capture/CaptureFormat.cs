@@ -0,0 +1,29 @@
+﻿namespace RealtimePlottingApp.Services.Capture;
+
+/// <summary>
+/// Layout of capture files. All values are little-endian.
+/// <code>
+/// Header:  magic "RPCAPTUR" | ushort version | ushort variableCount | int configLength
+///          | double ticksPerSecond | long startTime (Unix ms) | UTF-8 config
+/// Chunks:  uint "CHNK" | int count | long firstX | long lastX | count * (long x | uint y | ushort variable)
+/// Index:   chunkCount * (long offset | long firstX | long lastX | int count)
+/// Trailer: long indexOffset | int chunkCount | uint "CIDX"
+/// </code>
+/// Samples are in order of X across all variables. The index and trailer are written when the
+/// capture is closed, if they are missing (e.g. after a crash) the chunks are scanned instead.
+/// </summary>
+public static class CaptureFormat
+{
+    public const ulong Magic = 0x5255545041435052; // "RPCAPTUR"
+    public const ushort Version = 1;
+    public const int HeaderSize = 32;              // Excluding the config string
+
+    public const uint ChunkMagic = 0x4B4E4843;     // "CHNK"
+    public const int ChunkHeaderSize = 24;
+    public const int ChunkSamples = 4096;          // Samples per chunk, except the last
+    public const int SampleSize = 14;
+
+    public const int IndexEntrySize = 28;
+    public const uint TrailerMagic = 0x58444943;   // "CIDX"
+    public const int TrailerSize = 16;
+}
\ No newline at end of file
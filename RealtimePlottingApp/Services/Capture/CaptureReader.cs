@@ -0,0 +1,189 @@
+﻿using System;
+using System.Buffers.Binary;
+using System.Collections.Generic;
+using System.IO;
+using System.IO.MemoryMappedFiles;
+using System.Text;
+using RealtimePlottingApp.Models;
+
+namespace RealtimePlottingApp.Services.Capture;
+
+/// <summary>
+/// Reads a capture file through a memory mapping, so only the chunks being read are paged in,
+/// and captures of many gigabytes can be replayed without loading them onto the heap.
+/// Chunks are located by timestamp with a binary search of the file's index.
+/// </summary>
+public sealed class CaptureReader : IDisposable
+{
+    // ===== Instance Variables ===== //
+    private readonly MemoryMappedFile _file;
+    private readonly MemoryMappedViewAccessor _view;
+    private readonly long _length;
+    private readonly (long offset, long firstX, long lastX, int count)[] _index;
+    private readonly byte[] _buffer = new byte[CaptureFormat.ChunkSamples * CaptureFormat.SampleSize];
+
+    /// <summary>
+    /// The session the capture was recorded from.
+    /// </summary>
+    public CaptureHeader Header { get; }
+
+    /// <summary>
+    /// The number of chunks in the capture.
+    /// </summary>
+    public int ChunkCount => _index.Length;
+
+    /// <summary>
+    /// The total number of samples in the capture.
+    /// </summary>
+    public long SampleCount { get; }
+
+    // ===== Constructor ===== //
+    /// <summary>
+    /// Opens a capture file for reading.
+    /// </summary>
+    /// <exception cref="InvalidDataException">Thrown if the file is not a capture file.</exception>
+    public CaptureReader(string path)
+    {
+        _length = new FileInfo(path).Length;
+        if (_length < CaptureFormat.HeaderSize)
+            throw new InvalidDataException("File is too short to be a capture.");
+
+        _file = MemoryMappedFile.CreateFromFile(path, FileMode.Open, null, 0, MemoryMappedFileAccess.Read);
+        _view = _file.CreateViewAccessor(0, 0, MemoryMappedFileAccess.Read);
+        try
+        {
+            Header = ReadHeader(out long firstChunk);
+            _index = ReadIndex() ?? ScanChunks(firstChunk);
+            foreach (var entry in _index)
+                SampleCount += entry.count;
+        }
+        catch
+        {
+            Dispose();
+            throw;
+        }
+    }
+
+    // ===== API Methods ===== //
+    /// <summary>
+    /// X value of the first sample, or 0 if the capture is empty.
+    /// </summary>
+    public long FirstX => _index.Length > 0 ? _index[0].firstX : 0;
+
+    /// <summary>
+    /// X value of the last sample, or 0 if the capture is empty.
+    /// </summary>
+    public long LastX => _index.Length > 0 ? _index[^1].lastX : 0;
+
+    /// <summary>
+    /// Finds the first chunk that contains samples at or after the given X value.
+    /// </summary>
+    /// <returns>The chunk index, or ChunkCount if all samples are before x.</returns>
+    public int FindChunk(long x)
+    {
+        int low = 0, high = _index.Length;
+        while (low < high)
+        {
+            int mid = (low + high) >>> 1;
+            if (_index[mid].lastX < x) low = mid + 1;
+            else high = mid;
+        }
+        return low;
+    }
+
+    /// <summary>
+    /// Reads the samples of a chunk.
+    /// </summary>
+    /// <param name="chunk">Index of the chunk to read</param>
+    /// <param name="samples">Receives the samples, must hold at least CaptureFormat.ChunkSamples samples</param>
+    /// <returns>The number of samples read.</returns>
+    public int ReadChunk(int chunk, Span<CaptureSample> samples)
+    {
+        (long offset, _, _, int count) = _index[chunk];
+        int bytes = count * CaptureFormat.SampleSize;
+        _view.ReadArray(offset + CaptureFormat.ChunkHeaderSize, _buffer, 0, bytes);
+
+        ReadOnlySpan<byte> data = _buffer.AsSpan(0, bytes);
+        for (int i = 0; i < count; i++)
+        {
+            ReadOnlySpan<byte> sample = data.Slice(i * CaptureFormat.SampleSize, CaptureFormat.SampleSize);
+            samples[i] = new CaptureSample(
+                BinaryPrimitives.ReadUInt16LittleEndian(sample[12..]),
+                BinaryPrimitives.ReadInt64LittleEndian(sample),
+                BinaryPrimitives.ReadUInt32LittleEndian(sample[8..]));
+        }
+        return count;
+    }
+
+    public void Dispose()
+    {
+        _view?.Dispose();
+        _file?.Dispose();
+    }
+
+    // ===== Private Helpers ===== //
+    private CaptureHeader ReadHeader(out long firstChunk)
+    {
+        if (_view.ReadUInt64(0) != CaptureFormat.Magic)
+            throw new InvalidDataException("File is not a capture.");
+        if (_view.ReadUInt16(8) != CaptureFormat.Version)
+            throw new InvalidDataException("Unsupported capture version.");
+
+        int variableCount = _view.ReadUInt16(10);
+        int configLength = _view.ReadInt32(12);
+        if (configLength < 0 || CaptureFormat.HeaderSize + (long)configLength > _length)
+            throw new InvalidDataException("Capture header is corrupt.");
+
+        byte[] config = new byte[configLength];
+        _view.ReadArray(CaptureFormat.HeaderSize, config, 0, configLength);
+        firstChunk = CaptureFormat.HeaderSize + configLength;
+
+        return new CaptureHeader(
+            variableCount,
+            _view.ReadDouble(16),
+            DateTimeOffset.FromUnixTimeMilliseconds(_view.ReadInt64(24)).LocalDateTime,
+            Encoding.UTF8.GetString(config));
+    }
+
+    // Reads the index written when the capture was closed, or returns null if it is missing.
+    private (long, long, long, int)[]? ReadIndex()
+    {
+        long trailer = _length - CaptureFormat.TrailerSize;
+        if (trailer < CaptureFormat.HeaderSize || _view.ReadUInt32(trailer + 12) != CaptureFormat.TrailerMagic)
+            return null;
+
+        long indexOffset = _view.ReadInt64(trailer);
+        int chunkCount = _view.ReadInt32(trailer + 8);
+        if (indexOffset < 0 || chunkCount < 0 ||
+            indexOffset + (long)chunkCount * CaptureFormat.IndexEntrySize != trailer)
+            return null;
+
+        var index = new (long, long, long, int)[chunkCount];
+        for (int i = 0; i < chunkCount; i++)
+        {
+            long entry = indexOffset + (long)i * CaptureFormat.IndexEntrySize;
+            index[i] = (_view.ReadInt64(entry), _view.ReadInt64(entry + 8),
+                _view.ReadInt64(entry + 16), _view.ReadInt32(entry + 24));
+        }
+        return index;
+    }
+
+    // Rebuilds the index by walking the chunk headers, for captures which were never closed.
+    // A partially written last chunk is left out.
+    private (long, long, long, int)[] ScanChunks(long offset)
+    {
+        List<(long, long, long, int)> index = [];
+        while (offset + CaptureFormat.ChunkHeaderSize <= _length &&
+               _view.ReadUInt32(offset) == CaptureFormat.ChunkMagic)
+        {
+            int count = _view.ReadInt32(offset + 4);
+            long end = offset + CaptureFormat.ChunkHeaderSize + (long)count * CaptureFormat.SampleSize;
+            if (count <= 0 || count > CaptureFormat.ChunkSamples || end > _length)
+                break;
+
+            index.Add((offset, _view.ReadInt64(offset + 8), _view.ReadInt64(offset + 16), count));
+            offset = end;
+        }
+        return index.ToArray();
+    }
+}
\ No newline at end of file
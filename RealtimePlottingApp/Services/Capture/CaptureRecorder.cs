@@ -0,0 +1,107 @@
+﻿using System;
+using System.Collections.Generic;
+using RealtimePlottingApp.Models;
+
+namespace RealtimePlottingApp.Services.Capture;
+
+/// <summary>
+/// Records the samples a data source adds to a GraphDataModel into a capture file as they are committed.
+/// Samples of all variables are written merged in order of X, the order they were received in,
+/// so that replaying the file reproduces the session.
+/// </summary>
+public sealed class CaptureRecorder : IDisposable
+{
+    // ===== Instance Variables ===== //
+    private readonly GraphDataModel _graphData;
+    private readonly ICaptureSink _writer;
+    private readonly long[] _cursors; // Per variable, the next sample index to record
+    private bool _disposed;
+
+    /// <summary>
+    /// Starts recording samples added to the model from now on.
+    /// </summary>
+    /// <param name="graphData">The model to record the samples of</param>
+    /// <param name="path">Path of the capture file to create</param>
+    /// <param name="config">The connection config message of the session</param>
+    public CaptureRecorder(GraphDataModel graphData, string path, string config)
+        : this(graphData, header => new CaptureWriter(path, header), config)
+    {
+    }
+
+    /// <summary>
+    /// Starts recording samples added to the model from now on, into a sink created for the session.
+    /// </summary>
+    /// <param name="graphData">The model to record the samples of</param>
+    /// <param name="createSink">Creates the sink to record to, given the header of the session</param>
+    /// <param name="config">The connection config message of the session</param>
+    public CaptureRecorder(GraphDataModel graphData, Func<CaptureHeader, ICaptureSink> createSink, string config)
+    {
+        _graphData = graphData;
+        lock (_graphData)
+        {
+            _writer = createSink(new CaptureHeader(
+                graphData.VariableCount, graphData.TicksPerSecond, DateTime.Now, config));
+            _cursors = new long[graphData.VariableCount];
+            for (int v = 0; v < _cursors.Length; v++)
+                _cursors[v] = graphData.Columns[v].Current.EndIndex;
+            _graphData.SamplesCommitted += OnSamplesCommitted;
+        }
+
+        // Finalize the file if the application exits while recording.
+        AppDomain.CurrentDomain.ProcessExit += OnProcessExit;
+    }
+
+    /// <summary>
+    /// The number of samples recorded so far.
+    /// </summary>
+    public long SampleCount => _writer.SampleCount;
+
+    /// <summary>
+    /// Stops recording and finalizes the capture file.
+    /// </summary>
+    public void Dispose()
+    {
+        AppDomain.CurrentDomain.ProcessExit -= OnProcessExit;
+        lock (_graphData)
+        {
+            if (_disposed) return;
+            _disposed = true;
+            _graphData.SamplesCommitted -= OnSamplesCommitted;
+            _writer.Dispose();
+        }
+    }
+
+    private void OnProcessExit(object? sender, EventArgs e) => Dispose();
+
+    // Runs on the data source's thread after each batch, while the graph data is locked.
+    private void OnSamplesCommitted(object? sender, EventArgs e)
+    {
+        IReadOnlyList<SampleColumn> columns = _graphData.Columns;
+        if (columns.Count != _cursors.Length)
+            return; // The model was reconfigured for another session, which is not part of this capture.
+
+        while (true)
+        {
+            // Take the earliest pending sample across variables, ties go to the lowest variable.
+            int next = -1;
+            long nextX = 0;
+            for (int v = 0; v < columns.Count; v++)
+            {
+                ColumnSnapshot column = columns[v].Current;
+                _cursors[v] = Math.Max(_cursors[v], column.FirstIndex);
+                if (_cursors[v] >= column.EndIndex) continue;
+
+                long x = column.GetX(_cursors[v]);
+                if (next < 0 || x < nextX)
+                {
+                    next = v;
+                    nextX = x;
+                }
+            }
+            if (next < 0) return;
+
+            _writer.Append(next, nextX, columns[next].Current.GetY(_cursors[next]));
+            _cursors[next]++;
+        }
+    }
+}
\ No newline at end of file
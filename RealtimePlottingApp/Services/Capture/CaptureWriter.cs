@@ -0,0 +1,147 @@
+﻿using System;
+using System.Buffers.Binary;
+using System.Collections.Generic;
+using System.IO;
+using System.Text;
+using RealtimePlottingApp.Models;
+
+namespace RealtimePlottingApp.Services.Capture;
+
+/// <summary>
+/// Streams samples to a capture file, a chunk at a time. Samples must be appended in order of X.
+/// The timestamp index is written when disposed, which finalizes the file.
+/// Appended to by a CaptureRecorder on SamplesCommitted, directly or through a RotatingCaptureWriter,
+/// so calls are serialized by the GraphDataModel's lock.
+/// </summary>
+public sealed class CaptureWriter : ICaptureSink
+{
+    // ===== Instance Variables ===== //
+    private readonly Stream _stream;
+    private readonly byte[] _chunk = new byte[CaptureFormat.ChunkHeaderSize +
+                                              CaptureFormat.ChunkSamples * CaptureFormat.SampleSize];
+    private readonly List<(long offset, long firstX, long lastX, int count)> _index = [];
+    private int _count; // Samples in the current chunk
+    private long _firstX;
+    private long _lastX;
+    private bool _disposed;
+
+    /// <summary>
+    /// The total number of samples written.
+    /// </summary>
+    public long SampleCount { get; private set; }
+
+    // ===== Constructors ===== //
+    /// <summary>
+    /// Creates a capture file at the given path, overwriting any existing file.
+    /// </summary>
+    public CaptureWriter(string path, CaptureHeader header)
+        : this(new FileStream(path, FileMode.Create, FileAccess.Write, FileShare.Read), header)
+    {
+    }
+
+    /// <summary>
+    /// Writes a capture to a stream, which is disposed along with the writer.
+    /// </summary>
+    public CaptureWriter(Stream stream, CaptureHeader header)
+    {
+        if (header.VariableCount is < 1 or > ushort.MaxValue)
+            throw new ArgumentOutOfRangeException(nameof(header), "Invalid variable count.");
+
+        _stream = stream;
+        byte[] config = Encoding.UTF8.GetBytes(header.Config);
+        Span<byte> bytes = stackalloc byte[CaptureFormat.HeaderSize];
+        BinaryPrimitives.WriteUInt64LittleEndian(bytes, CaptureFormat.Magic);
+        BinaryPrimitives.WriteUInt16LittleEndian(bytes[8..], CaptureFormat.Version);
+        BinaryPrimitives.WriteUInt16LittleEndian(bytes[10..], (ushort)header.VariableCount);
+        BinaryPrimitives.WriteInt32LittleEndian(bytes[12..], config.Length);
+        BinaryPrimitives.WriteDoubleLittleEndian(bytes[16..], header.TicksPerSecond);
+        BinaryPrimitives.WriteInt64LittleEndian(bytes[24..],
+            new DateTimeOffset(header.StartTime.ToUniversalTime()).ToUnixTimeMilliseconds());
+        _stream.Write(bytes);
+        _stream.Write(config);
+    }
+
+    // ===== API Methods ===== //
+    /// <summary>
+    /// Appends a sample, writing the current chunk out once it is full.
+    /// </summary>
+    public void Append(int variable, long x, uint y)
+    {
+        ObjectDisposedException.ThrowIf(_disposed, this);
+
+        if (_count == 0)
+            _firstX = x;
+        _lastX = x;
+
+        Span<byte> sample = _chunk.AsSpan(CaptureFormat.ChunkHeaderSize + _count * CaptureFormat.SampleSize);
+        BinaryPrimitives.WriteInt64LittleEndian(sample, x);
+        BinaryPrimitives.WriteUInt32LittleEndian(sample[8..], y);
+        BinaryPrimitives.WriteUInt16LittleEndian(sample[12..], (ushort)variable);
+        SampleCount++;
+
+        if (++_count == CaptureFormat.ChunkSamples)
+            WriteChunk();
+    }
+
+    /// <summary>
+    /// Writes out the current chunk even if it isn't full, so everything appended so far is in the file.
+    /// </summary>
+    public void Flush()
+    {
+        ObjectDisposedException.ThrowIf(_disposed, this);
+        WriteChunk();
+        _stream.Flush();
+    }
+
+    /// <summary>
+    /// Writes the remaining samples and the timestamp index, and closes the file.
+    /// </summary>
+    public void Dispose()
+    {
+        if (_disposed) return;
+
+        try
+        {
+            WriteChunk();
+
+            // Index of every chunk's offset and X range, followed by the trailer locating it.
+            long indexOffset = _stream.Position;
+            Span<byte> entry = stackalloc byte[CaptureFormat.IndexEntrySize];
+            foreach ((long offset, long firstX, long lastX, int count) in _index)
+            {
+                BinaryPrimitives.WriteInt64LittleEndian(entry, offset);
+                BinaryPrimitives.WriteInt64LittleEndian(entry[8..], firstX);
+                BinaryPrimitives.WriteInt64LittleEndian(entry[16..], lastX);
+                BinaryPrimitives.WriteInt32LittleEndian(entry[24..], count);
+                _stream.Write(entry);
+            }
+
+            Span<byte> trailer = stackalloc byte[CaptureFormat.TrailerSize];
+            BinaryPrimitives.WriteInt64LittleEndian(trailer, indexOffset);
+            BinaryPrimitives.WriteInt32LittleEndian(trailer[8..], _index.Count);
+            BinaryPrimitives.WriteUInt32LittleEndian(trailer[12..], CaptureFormat.TrailerMagic);
+            _stream.Write(trailer);
+        }
+        finally
+        {
+            _disposed = true;
+            _stream.Dispose();
+        }
+    }
+
+    // ===== Private Helpers ===== //
+    private void WriteChunk()
+    {
+        if (_count == 0) return;
+
+        Span<byte> header = _chunk.AsSpan(0, CaptureFormat.ChunkHeaderSize);
+        BinaryPrimitives.WriteUInt32LittleEndian(header, CaptureFormat.ChunkMagic);
+        BinaryPrimitives.WriteInt32LittleEndian(header[4..], _count);
+        BinaryPrimitives.WriteInt64LittleEndian(header[8..], _firstX);
+        BinaryPrimitives.WriteInt64LittleEndian(header[16..], _lastX);
+
+        _index.Add((_stream.Position, _firstX, _lastX, _count));
+        _stream.Write(_chunk, 0, CaptureFormat.ChunkHeaderSize + _count * CaptureFormat.SampleSize);
+        _count = 0;
+    }
+}
\ No newline at end of file
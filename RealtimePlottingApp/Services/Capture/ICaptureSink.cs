@@ -0,0 +1,24 @@
+﻿using System;
+
+namespace RealtimePlottingApp.Services.Capture;
+
+/// <summary>
+/// Destination of the samples a CaptureRecorder records, such as a single
+/// capture file (CaptureWriter) or a series of rotated files (RotatingCaptureWriter).
+/// Samples are appended in order of X, on SamplesCommitted while the GraphDataModel's lock is held.
+/// </summary>
+public interface ICaptureSink : IDisposable
+{
+    /// <summary>
+    /// The total number of samples appended.
+    /// </summary>
+    long SampleCount { get; }
+
+    /// <summary>
+    /// Appends a sample of the given variable.
+    /// </summary>
+    /// <param name="variable">Number of the variable the sample belongs to</param>
+    /// <param name="x">The sample's timestamp</param>
+    /// <param name="y">The sample's value</param>
+    void Append(int variable, long x, uint y);
+}
\ No newline at end of file
@@ -0,0 +1,206 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Globalization;
+using System.IO;
+using System.IO.Compression;
+using System.Threading.Tasks;
+using RealtimePlottingApp.Models;
+
+namespace RealtimePlottingApp.Services.Capture;
+
+/// <summary>
+/// Format of the files written by a RotatingCaptureWriter.
+/// </summary>
+public enum CaptureFileFormat
+{
+    Capture, // Capture files (.rpcap), see CaptureFormat
+    Csv      // One "ticks,variable,value" row per sample (.csv)
+}
+
+/// <summary>
+/// Streams samples to a series of files for long unattended captures, starting a new file once the current one
+/// reaches a size or age limit. Every file is complete by itself: capture files have their own header and
+/// index, so any of them can be replayed on its own once uncompressed. Closed files are optionally gzip
+/// compressed on a thread pool thread, keeping the compression off the thread appending the samples.
+/// Appended to by a CaptureRecorder on SamplesCommitted, while the GraphDataModel's lock is held.
+/// FileCount and CurrentPath are read without that lock, so they are only fit for progress reports.
+/// </summary>
+public sealed class RotatingCaptureWriter : ICaptureSink
+{
+    // ===== Constants ===== //
+    private const string CsvHeader = "ticks,variable,value";
+    private const int AgeCheckInterval = CaptureFormat.ChunkSamples; // Samples between checks of the file's age
+
+    // ===== Instance Variables ===== //
+    private readonly string _directory;
+    private readonly string _prefix;
+    private readonly CaptureHeader _header;
+    private readonly CaptureFileFormat _format;
+    private readonly long _maxFileBytes;
+    private readonly TimeSpan _maxFileAge;
+    private readonly bool _compress;
+    private readonly List<Task> _compressions = [];
+    private readonly char[] _row = new char[40]; // Longest row: 20 + 1 + 5 + 1 + 10 + newline
+
+    private CaptureWriter? _capture;
+    private StreamWriter? _csv;
+    private string? _path;
+    private long _fileBytes;   // Uncompressed bytes written to the current file
+    private long _fileStarted; // Environment.TickCount64 when the current file was opened
+    private int _fileCount;
+    private bool _disposed;
+
+    // ===== Constructor ===== //
+    /// <summary>
+    /// Prepares to write files into a directory. The first file is created once the first sample is appended.
+    /// </summary>
+    /// <param name="directory">Directory to write the files to, created if it doesn't exist</param>
+    /// <param name="prefix">Start of the file names, which are followed by the time the file was opened and its number</param>
+    /// <param name="header">The session the samples are recorded from</param>
+    /// <param name="format">Format of the files</param>
+    /// <param name="maxFileBytes">Uncompressed size at which a new file is started</param>
+    /// <param name="maxFileAge">Age at which a new file is started, TimeSpan.Zero to only rotate by size</param>
+    /// <param name="compress">Whether to gzip every file once it is closed</param>
+    public RotatingCaptureWriter(string directory, string prefix, CaptureHeader header, CaptureFileFormat format,
+        long maxFileBytes, TimeSpan maxFileAge, bool compress)
+    {
+        if (maxFileBytes <= 0)
+            throw new ArgumentOutOfRangeException(nameof(maxFileBytes));
+
+        Directory.CreateDirectory(directory);
+        _directory = directory;
+        _prefix = prefix;
+        _header = header;
+        _format = format;
+        _maxFileBytes = maxFileBytes;
+        _maxFileAge = maxFileAge;
+        _compress = compress;
+    }
+
+    // ===== API Properties ===== //
+    public long SampleCount { get; private set; }
+
+    /// <summary>
+    /// The number of files started so far, including the one being written.
+    /// </summary>
+    public int FileCount => _fileCount;
+
+    /// <summary>
+    /// Path of the file being written, null between files.
+    /// </summary>
+    public string? CurrentPath => _path;
+
+    // ===== API Methods ===== //
+    public void Append(int variable, long x, uint y)
+    {
+        ObjectDisposedException.ThrowIf(_disposed, this);
+
+        if (_path == null)
+            OpenFile();
+
+        if (_capture != null)
+        {
+            _capture.Append(variable, x, y);
+            _fileBytes += CaptureFormat.SampleSize;
+        }
+        else
+        {
+            // Formatted into a reused buffer, rather than a string per row.
+            Span<char> row = _row;
+            x.TryFormat(row, out int length, default, CultureInfo.InvariantCulture);
+            row[length++] = ',';
+            variable.TryFormat(row[length..], out int written, default, CultureInfo.InvariantCulture);
+            length += written;
+            row[length++] = ',';
+            y.TryFormat(row[length..], out written, default, CultureInfo.InvariantCulture);
+            length += written;
+            row[length++] = '\n';
+            _csv!.Write(_row, 0, length);
+            _fileBytes += length;
+        }
+        SampleCount++;
+
+        // The age is only looked at every so often, so that the clock isn't read for every sample.
+        if (_fileBytes >= _maxFileBytes ||
+            (_maxFileAge > TimeSpan.Zero && SampleCount % AgeCheckInterval == 0 &&
+             Environment.TickCount64 - _fileStarted >= _maxFileAge.TotalMilliseconds))
+            CloseFile();
+    }
+
+    /// <summary>
+    /// Closes the current file, and waits for all files to be compressed.
+    /// </summary>
+    public void Dispose()
+    {
+        if (_disposed) return;
+        _disposed = true;
+
+        CloseFile();
+        try
+        {
+            Task.WaitAll(_compressions.ToArray());
+        }
+        catch (AggregateException e)
+        {
+            Console.WriteLine($"Error compressing capture files: {e.InnerException?.Message}");
+        }
+    }
+
+    // ===== Private Helpers ===== //
+    private void OpenFile()
+    {
+        string extension = _format == CaptureFileFormat.Csv ? "csv" : "rpcap";
+        string path = Path.Combine(_directory,
+            $"{_prefix}-{DateTime.Now:yyyyMMdd-HHmmss}-{_fileCount + 1:D4}.{extension}");
+
+        if (_format == CaptureFileFormat.Csv)
+        {
+            _csv = new StreamWriter(path, append: false);
+            _csv.WriteLine(CsvHeader);
+        }
+        else
+        {
+            _capture = new CaptureWriter(path, _header with { StartTime = DateTime.Now });
+        }
+
+        _path = path;
+        _fileBytes = 0;
+        _fileStarted = Environment.TickCount64;
+        _fileCount++;
+    }
+
+    private void CloseFile()
+    {
+        if (_path == null) return;
+
+        string path = _path;
+        _path = null;
+        _capture?.Dispose();
+        _csv?.Dispose();
+        _capture = null;
+        _csv = null;
+
+        if (!_compress) return;
+        _compressions.RemoveAll(task => task.IsCompleted);
+        _compressions.Add(Task.Run(() => Compress(path)));
+    }
+
+    // Replaces a closed file by its gzip compressed version. The file is kept as is if that fails.
+    private static void Compress(string path)
+    {
+        try
+        {
+            using (FileStream source = File.OpenRead(path))
+            using (FileStream target = new(path + ".gz", FileMode.Create, FileAccess.Write))
+            using (GZipStream gzip = new(target, CompressionLevel.Optimal))
+            {
+                source.CopyTo(gzip);
+            }
+            File.Delete(path);
+        }
+        catch (IOException e)
+        {
+            Console.WriteLine($"Error compressing {path}: {e.Message}");
+        }
+    }
+}
\ No newline at end of file
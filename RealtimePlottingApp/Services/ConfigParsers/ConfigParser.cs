@@ -1,13 +1,22 @@
 ﻿using System;
 using System.Collections.Generic;
+using System.Globalization;
+using System.Linq;
 using System.Text.RegularExpressions;
 using RealtimePlottingApp.Models;
+using RealtimePlottingApp.Services.CAN;
 
 namespace RealtimePlottingApp.Services.ConfigParsers;
 
 public partial class ConfigParser : IConfigParser
 {
-    public bool ParseUartConfig(string message, out string comPort, out int baudRate, out UARTDataPayloadSize dataSize, out int uniqueVars)
+    /// <summary>
+    /// Timestamp ticks per second of UART connections whose message doesn't specify the rate.
+    /// </summary>
+    public const double DefaultUartTickRate = 1000;
+
+    public bool ParseUartConfig(string message, out string comPort, out int baudRate, out UARTDataPayloadSize dataSize,
+        out int uniqueVars, out double ticksPerSecond)
     {
         Match match = GeneratedUartRegex().Match(message);
 
@@ -23,7 +32,10 @@ public partial class ConfigParser : IConfigParser
                 "32 bits" => UARTDataPayloadSize.UART_PAYLOAD_32,
                 _ => throw new FormatException("Invalid data size format")
             };
-            return true;
+            ticksPerSecond = match.Groups["tickRate"].Success
+                ? double.Parse(match.Groups["tickRate"].Value, CultureInfo.InvariantCulture)
+                : DefaultUartTickRate;
+            return ticksPerSecond > 0;
         }
 
         // No success, return defaults.
@@ -31,6 +43,7 @@ public partial class ConfigParser : IConfigParser
         baudRate = 0;
         uniqueVars = 0;
         dataSize = default;
+        ticksPerSecond = 0;
         return false;
     }
     
@@ -55,69 +68,183 @@ public partial class ConfigParser : IConfigParser
         return false;
     }
     
+    public bool ParseReplayConfig(string message, out string filePath, out double speed)
+    {
+        Match match = GeneratedReplayRegex().Match(message);
+
+        if (match.Success)
+        {
+            filePath = match.Groups["filePath"].Value;
+            // "max" replays as fast as possible, otherwise a multiple of real time.
+            speed = match.Groups["speed"].Value.Equals("max", StringComparison.OrdinalIgnoreCase)
+                ? double.PositiveInfinity
+                : double.Parse(match.Groups["speed"].Value, CultureInfo.InvariantCulture);
+            return speed > 0;
+        }
+
+        // No success, return defaults.
+        filePath = string.Empty;
+        speed = 0;
+        return false;
+    }
+    
     /// <summary>
-    /// Parses a CAN data payload mask to extract the variables from the 8-byte data array.
+    /// Parses a CAN data payload mask to extract the variables from the data array.
     /// The mask is expected to be in the format "__:__:__:__:__:__:__:__", with each colon-seperated
     /// group corresponds to the first and second half of a byte (imagine it as a hex-representation of the payload).
+    /// This compiles the mask on every call, so for a stream of frames CompileCanDataMask should be used instead.
     /// </summary>
     /// <param name="mask">The mask string</param>
-    /// <param name="data">A byte-array of size 8 containing CAN data</param>
+    /// <param name="data">A byte-array containing CAN data</param>
     /// <returns>List representing the extracted variables as unsigned integers indexed by numerical order.</returns>
     public List<uint> ParseCanDataMask(string mask, byte[] data)
     {
         List<uint> variables = [];
-        
-        string[] groups = mask.Split(':');
-        if (groups.Length != 8)
+
+        CanPayloadPlan plan;
+        try
+        {
+            plan = CompileCanDataMask(mask, 0);
+        }
+        catch (FormatException e)
         {
-            Console.WriteLine("Invalid mask format. Expected 8 groups.");
+            Console.WriteLine($"Invalid mask format. {e.Message}");
             // Return empty list
             return variables;
         }
 
-        // For each possible variable number 1..9 which exists in the mask:
-        for (int i = 1; mask.Contains(i.ToString()) && i <= 9; i++)
+        Span<double> values = stackalloc double[plan.VariableCount];
+        if (!plan.TryDecode(data, values))
+            return variables;
+
+        foreach (double value in values)
+            variables.Add((uint)value);
+        return variables;
+    }
+
+    /// <summary>
+    /// Compiles a CAN data payload mask into a plan which decodes frames without parsing the mask again.
+    /// The mask has a colon-seperated group per payload byte, "__:__:__:__:__:__:__:__" for 8 bytes,
+    /// and up to 64 groups for CAN FD. Digits [1..9] mark which half of a byte belongs to which variable.
+    /// Variables are unsigned big-endian by default, and may be followed by ";n=options" per variable n,
+    /// where options are a comma-seperated list of: s (signed), u (unsigned), le (little-endian),
+    /// be (big-endian), *factor (scale) and +offset or -offset. E.g. "11:11:__:__:__:__:__:__;1=s,le,+32768"
+    /// Samples are stored as unsigned 32-bit whole numbers, so scales and offsets must be whole numbers,
+    /// variables must fit in 32 bits after scaling, and signed variables need an offset that keeps them non-negative.
+    /// </summary>
+    /// <param name="mask">The mask string</param>
+    /// <param name="firstVariable">Graph variable index that the mask's variable 1 is stored as</param>
+    /// <returns>The compiled plan</returns>
+    /// <exception cref="FormatException">Thrown if the mask or its options are invalid,
+    /// or a variable can decode to values that can't be stored.</exception>
+    public CanPayloadPlan CompileCanDataMask(string mask, int firstVariable)
+    {
+        string[] parts = mask.Split(';');
+        string[] groups = parts[0].Split(':');
+        if (groups.Length > CanPayloadPlan.MaxPayloadLength || groups.Any(g => g.Length != 2))
+            throw new FormatException($"Expected 1 to {CanPayloadPlan.MaxPayloadLength} groups of 2 characters.");
+
+        // Variables are numbered in order of the digits used, so "1" is always the first variable.
+        List<char> digits = parts[0].Where(c => c is >= '1' and <= '9').Distinct().Order().ToList();
+        int[] nibbles = new int[groups.Length * 2];
+        for (int n = 0; n < nibbles.Length; n++)
+            nibbles[n] = digits.IndexOf(groups[n / 2][n % 2]);
+
+        CanFieldFormat[] formats = new CanFieldFormat[digits.Count];
+        Array.Fill(formats, CanFieldFormat.Default);
+        foreach (string option in parts.Skip(1))
+        {
+            string[] keyValue = option.Split('=');
+            int v = keyValue.Length == 2 && keyValue[0].Trim().Length == 1 ? digits.IndexOf(keyValue[0].Trim()[0]) : -1;
+            if (v < 0)
+                throw new FormatException($"Invalid variable option \"{option}\".");
+            formats[v] = ParseCanFieldFormat(keyValue[1], formats[v]);
+        }
+
+        return new CanPayloadPlan(nibbles, formats, firstVariable);
+    }
+
+    /// <summary>
+    /// Compiles the CAN routes of a connection, mapping each CAN ID to the plan that decodes its frames.
+    /// The payload mask may hold several masks seperated by "|". The first applies to canIdFilter,
+    /// and the others are prefixed by their own ID as "id@mask", with the ID in decimal or hex (0x...).
+    /// The variables of each mask are numbered after those of the masks before it.
+    /// </summary>
+    /// <param name="canIdFilter">The ID of the can messages the first mask applies to</param>
+    /// <param name="dataPayloadMask">The mask(s) defining how to read the data</param>
+    /// <returns>The plan for each CAN ID</returns>
+    /// <exception cref="FormatException">Thrown if a mask or ID is invalid, or an ID is repeated.</exception>
+    public Dictionary<uint, CanPayloadPlan> ParseCanRoutes(int canIdFilter, string dataPayloadMask)
+    {
+        Dictionary<uint, CanPayloadPlan> routes = [];
+        int variableCount = 0;
+
+        string[] entries = dataPayloadMask.Split('|');
+        for (int i = 0; i < entries.Length; i++)
         {
-            uint varI = 0;
-            bool variableUpdated = false;
-            // Look for number i in the mask, to construct variable i.
-            for (int j = 0; j < groups.Length; j++)
+            string mask = entries[i];
+            uint canId = (uint)canIdFilter;
+            int at = mask.IndexOf('@');
+            if (i > 0)
             {
-                // Variable not masked in this group(byte), check next.
-                if (!groups[j].Contains(i.ToString())) continue;
-                
-                if (groups[j].Equals($"{i}{i}")) // Case: "ii"
-                {
-                    // Shift left by 8 bits (full byte) and `|` with data to reconstruct that full byte of the data.
-                    varI = (varI << 8) | data[j];
-                    variableUpdated = true;
-                }
-                
-                else if (groups[j].StartsWith($"{i}")) // Case: "i_", where _ is wildcard.
-                {
-                    uint highHalf = (uint)(data[j] >> 4) & 0x0F; // Extract high half
-                    varI = (varI << 4) | highHalf; // Shift left by 4 bits and `|` with the half
-                    variableUpdated = true;
-                }
-                
-                else if (groups[j].EndsWith($"{i}")) // Case "_i", where _ is wildcard.
-                {
-                    uint lowHalf = (uint)data[j] & 0x0F; // Extract low half
-                    varI = (varI << 4) | lowHalf; // Shift left by 4 bits and `|` with the half
-                    variableUpdated = true;
-                }
+                if (at < 0)
+                    throw new FormatException($"Mask \"{mask}\" has no CAN ID.");
+                canId = ParseCanId(mask[..at]);
+                mask = mask[(at + 1)..];
             }
-            // Finished constructing data from mask.
-            if(variableUpdated)
-                variables.Add(varI);
+
+            CanPayloadPlan plan = CompileCanDataMask(mask, variableCount);
+            if (!routes.TryAdd(canId, plan))
+                throw new FormatException($"CAN ID {canId} has more than one mask.");
+            variableCount += plan.VariableCount;
         }
 
-        return variables;
+        return routes;
+    }
+
+    // Applies a comma-seperated list of variable options on top of a format.
+    private static CanFieldFormat ParseCanFieldFormat(string options, CanFieldFormat format)
+    {
+        foreach (string token in options.Split(',').Select(t => t.Trim()))
+        {
+            format = token switch
+            {
+                "s" => format with { Signed = true },
+                "u" => format with { Signed = false },
+                "le" => format with { LittleEndian = true },
+                "be" => format with { LittleEndian = false },
+                _ when token.StartsWith('*') => format with { Scale = ParseDouble(token[1..]) },
+                _ when token.StartsWith('+') => format with { Offset = ParseDouble(token[1..]) },
+                _ when token.StartsWith('-') => format with { Offset = ParseDouble(token) },
+                _ => throw new FormatException($"Invalid variable option \"{token}\".")
+            };
+        }
+        return format;
+    }
+
+    private static double ParseDouble(string text)
+    {
+        if (!double.TryParse(text, NumberStyles.Float, CultureInfo.InvariantCulture, out double value))
+            throw new FormatException($"Invalid number \"{text}\".");
+        return value;
+    }
+
+    private static uint ParseCanId(string text)
+    {
+        text = text.Trim();
+        bool parsed = text.StartsWith("0x", StringComparison.OrdinalIgnoreCase)
+            ? uint.TryParse(text[2..], NumberStyles.HexNumber, CultureInfo.InvariantCulture, out uint canId)
+            : uint.TryParse(text, NumberStyles.None, CultureInfo.InvariantCulture, out canId);
+        if (!parsed)
+            throw new FormatException($"Invalid CAN ID \"{text}\".");
+        return canId;
     }
 
     // Generated Regexes for higher performance than defining on the spot.
-    [GeneratedRegex(@"^ConnectUart:ComPort:(?<comPort>[^,]+),BaudRate:(?<baudRate>\d+),DataSize:(?<dataSize>\d+ bits),UniqueVars:(?<uniqueVars>\d+)$")]
+    [GeneratedRegex(@"^ConnectUart:ComPort:(?<comPort>[^,]+),BaudRate:(?<baudRate>\d+),DataSize:(?<dataSize>\d+ bits),UniqueVars:(?<uniqueVars>\d+)(,TickRate:(?<tickRate>\d+(\.\d+)?))?$")]
     private static partial Regex GeneratedUartRegex();
     [GeneratedRegex(@"^ConnectCan:CanInterface:(?<canInterface>[^,]+),BitRate:(?<bitRate>[^,]+),CanIdFilter:(?<canIdFilter>\d+),DataPayloadMask:(?<dataPayloadMask>.+)$")]
     private static partial Regex GeneratedCanRegex();
+    [GeneratedRegex(@"^ConnectReplay:Speed:(?<speed>max|\d+(\.\d+)?),File:(?<filePath>.+)$", RegexOptions.IgnoreCase)]
+    private static partial Regex GeneratedReplayRegex();
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 ﻿using System.Collections.Generic;
 using RealtimePlottingApp.Models;
+using RealtimePlottingApp.Services.CAN;
 
 namespace RealtimePlottingApp.Services.ConfigParsers;
 
@@ -14,9 +15,10 @@ public interface IConfigParser
     /// <param name="baudRate">The baud rate to communicate at</param>
     /// <param name="dataSize">The size of the data that is received</param>
     /// <param name="uniqueVars">The number of unique variables expected to be received</param>
+    /// <param name="ticksPerSecond">The rate of the sender's timestamp timer, 1000 if not specified</param>
     /// <returns></returns>
      bool ParseUartConfig(string message, out string comPort, out int baudRate,
-        out UARTDataPayloadSize dataSize, out int uniqueVars);
+        out UARTDataPayloadSize dataSize, out int uniqueVars, out double ticksPerSecond);
 
     /// <summary>
     /// Parses a CAN config string and returns mandatory
@@ -31,6 +33,16 @@ public interface IConfigParser
     bool ParseCanConfig(string message, out string canInterface, out string bitRate,
         out int canIdFilter, out string dataPayloadMask);
 
+    /// <summary>
+    /// Parses a replay config string and returns the
+    /// fields needed to replay a capture file.
+    /// </summary>
+    /// <param name="message">String containing user configuration</param>
+    /// <param name="filePath">The capture file to replay</param>
+    /// <param name="speed">Multiple of real time to replay at, PositiveInfinity for max speed</param>
+    /// <returns></returns>
+    bool ParseReplayConfig(string message, out string filePath, out double speed);
+
     /// <summary>
     /// Parses a CAN data mask to define what data in the payload
     /// belongs to which variable.
@@ -39,4 +51,24 @@ public interface IConfigParser
     /// <param name="data">The byte array of data to apply the mask to</param>
     /// <returns></returns>
     List<uint> ParseCanDataMask(string mask, byte[] data);
+
+    /// <summary>
+    /// Compiles a CAN data mask, with optional per-variable options for
+    /// signedness, endianness and scale/offset, into a reusable decoding plan.
+    /// Options under which a variable decodes to fractional values, or values outside
+    /// the unsigned 32-bit sample range, are rejected.
+    /// </summary>
+    /// <param name="mask">The data mask to be compiled</param>
+    /// <param name="firstVariable">Graph variable index of the mask's first variable</param>
+    /// <returns></returns>
+    CanPayloadPlan CompileCanDataMask(string mask, int firstVariable);
+
+    /// <summary>
+    /// Compiles the data masks of a CAN connection into a plan per CAN ID,
+    /// so one connection can decode the frames of several IDs.
+    /// </summary>
+    /// <param name="canIdFilter">The ID the first mask applies to</param>
+    /// <param name="dataPayloadMask">The data mask(s) to be compiled</param>
+    /// <returns></returns>
+    Dictionary<uint, CanPayloadPlan> ParseCanRoutes(int canIdFilter, string dataPayloadMask);
 }
\ No newline at end of file
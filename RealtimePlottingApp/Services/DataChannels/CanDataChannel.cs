@@ -1,8 +1,11 @@
-﻿using System.Collections.Generic;
+﻿using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.Linq;
 using RealtimePlottingApp.Events;
 using RealtimePlottingApp.Models;
 using RealtimePlottingApp.Services.CAN;
-using RealtimePlottingApp.Services.ConfigParsers;
+using RealtimePlottingApp.Services.Diagnostics;
 
 namespace RealtimePlottingApp.Services.DataChannels;
 
@@ -12,9 +15,12 @@ public class CanDataChannel : IDataChannel
     private readonly ICanBus _canBus;
     private readonly string _interfaceName;
     private readonly string? _bitrate;
-    private readonly int _canIdFilter;
-    private readonly string _canDataPayloadMask;
-    private readonly IConfigParser _configParser = new ConfigParser();
+    // Compiled payload mask for each CAN ID to decode, frames of other IDs are ignored.
+    private readonly Dictionary<uint, CanPayloadPlan> _routes;
+    // Decoded values of the latest frame, reused for every frame.
+    private readonly double[] _values;
+    // Whether the bus's timestamps are already on the model's 64-bit timebase, rather than wrapping around.
+    private readonly bool _unwrappedTimestamps;
 
     // Reference to model which data should be added to.
     private readonly GraphDataModel _graphDataModel;
@@ -28,18 +34,26 @@ public class CanDataChannel : IDataChannel
     /// <param name="canBus">The CAN-bus implementation to use</param>
     /// <param name="interfaceName">The CAN-interface to connect to</param>
     /// <param name="bitrate">The bit rate of the CAN communication</param>
-    /// <param name="canIdFilter">An ID to filter data traffic by</param>
-    /// <param name="canDataPayloadMask">A mask for which bytes of the data belongs to which variable</param>
+    /// <param name="routes">The compiled mask of each CAN ID to decode, see IConfigParser.ParseCanRoutes</param>
     /// <param name="graphDataModel">The GraphDataModel to store received messages in after filtering</param>
-    public CanDataChannel(ICanBus canBus, string interfaceName, string? bitrate, 
-        int canIdFilter, string canDataPayloadMask, GraphDataModel graphDataModel)
+    public CanDataChannel(ICanBus canBus, string interfaceName, string? bitrate,
+        Dictionary<uint, CanPayloadPlan> routes, GraphDataModel graphDataModel)
     {
         _interfaceName = interfaceName;
         _bitrate = bitrate;
         _graphDataModel = graphDataModel;
-        _canIdFilter = canIdFilter;
-        _canDataPayloadMask = canDataPayloadMask;
+        _unwrappedTimestamps = canBus.TimestampBits >= 64;
+        lock (_graphDataModel)
+        {
+            // Frames are timestamped with the bus's full timestamps, in its own units.
+            if (!_unwrappedTimestamps)
+                _graphDataModel.XValBitSize = (uint)canBus.TimestampBits;
+            _graphDataModel.TicksPerSecond = canBus.TicksPerSecond;
+        }
+        _routes = routes;
+        _values = new double[routes.Values.Select(plan => plan.VariableCount).DefaultIfEmpty().Max()];
         _canBus = canBus;
+        _canBus.CanIdFilters = routes.Keys; // Only receive the IDs that are decoded.
         _canBus.MessageReceived += OnCanDataReceived;
     }
 
@@ -58,15 +72,27 @@ public class CanDataChannel : IDataChannel
     // ---------- Implementation-specific helper methods ---------- //
     private void OnCanDataReceived(object? sender, CanMessageReceivedEvent e)
     {
-        if (_canIdFilter != e.CanId) return; // Filter by requested ID
-        
-        List<uint> variables = _configParser.ParseCanDataMask(_canDataPayloadMask, e.Data);
+        // Filter by requested IDs, and skip frames too short for their mask.
+        if (!_routes.TryGetValue(e.CanId, out CanPayloadPlan? plan) || !plan.TryDecode(e.Data, _values))
+            return;
+
+        long requested = Stopwatch.GetTimestamp();
         lock (_graphDataModel)
         {
-            foreach (var value in variables)
+            long acquired = Stopwatch.GetTimestamp();
+            // Mask variables are decoded in numerical order, store each in its own column.
+            for (int i = 0; i < plan.VariableCount; i++)
             {
-                _graphDataModel.AddPoint(e.Timestamp, value);
+                if (_unwrappedTimestamps)
+                    _graphDataModel.AddUnwrappedPoint(plan.FirstVariable + i, e.Timestamp, ToSample(_values[i]));
+                else
+                    _graphDataModel.AddPoint(plan.FirstVariable + i, (uint)e.Timestamp, ToSample(_values[i]));
             }
+            _graphDataModel.CommitSamples();
+            PipelineMetrics.RecordLock(requested, acquired);
         }
     }
+
+    // Plans only decode whole values within the range of a sample.
+    private static uint ToSample(double value) => (uint)value;
 }
\ No newline at end of file
@@ -24,6 +24,8 @@ public class DataGeneratorChannel : IDataChannel
     {
         _generator = new DataGenerator();
         _graphDataModel = graphDataModel;
+        lock (_graphDataModel)
+            _graphDataModel.TicksPerSecond = 1000; // Points are generated about a millisecond apart.
         _generator.DataAvailable += OnTestDataReceived;
     }
 
@@ -46,6 +48,7 @@ public class DataGeneratorChannel : IDataChannel
         {
             // Add last X- and Y-data point via indexing from the end.
             _graphDataModel.AddPoint(_generator.XData[^1], _generator.YData[^1]);
+            _graphDataModel.CommitSamples();
         }
     }
 }
\ No newline at end of file
@@ -0,0 +1,139 @@
+﻿using System;
+using System.Diagnostics;
+using System.Threading;
+using RealtimePlottingApp.Models;
+using RealtimePlottingApp.Services.Capture;
+using RealtimePlottingApp.Services.Diagnostics;
+
+namespace RealtimePlottingApp.Services.DataChannels;
+
+/// <summary>
+/// Data Channel which replays a capture file into a GraphDataModel, paced by the recorded timestamps
+/// at real time, a multiple of it, or as fast as possible. Gives a deterministic and hardware-free
+/// data source for revisiting sessions and load testing the plotting pipeline.
+/// </summary>
+public class ReplayDataChannel : IDataChannel
+{
+    // Longest time the replay thread sleeps at once, so that disconnecting is responsive.
+    private const int MaxSleepMs = 50;
+
+    // State variables for connections
+    private readonly CaptureReader _reader;
+    private readonly double _speed;
+    private readonly long? _startX;
+    private readonly ManualResetEventSlim _stopRequested = new(false);
+    private Thread? _replayThread;
+
+    // Reference to model which data should be added to.
+    private readonly GraphDataModel _graphDataModel;
+
+    /// <summary>
+    /// Raised on the replay thread once every sample of the capture has been replayed.
+    /// </summary>
+    public event EventHandler? ReplayCompleted;
+
+    // ---------- Constructor ---------- //
+    /// <summary>
+    /// Creates a ReplayDataChannel, which will replay the samples of a capture file
+    /// into the given GraphDataModel.
+    /// </summary>
+    /// <param name="path">The capture file to replay</param>
+    /// <param name="speed">Multiple of real time to replay at, or PositiveInfinity to replay as fast as possible</param>
+    /// <param name="graphDataModel">The GraphDataModel to add the samples to</param>
+    /// <param name="startX">Timestamp to start replaying from, or null to replay from the start</param>
+    /// <remarks>Sets the model's timebase to the one the capture was recorded with.</remarks>
+    public ReplayDataChannel(string path, double speed, GraphDataModel graphDataModel, long? startX = null)
+    {
+        if (!(speed > 0))
+            throw new ArgumentOutOfRangeException(nameof(speed), "Replay speed must be positive.");
+
+        _reader = new CaptureReader(path);
+        _speed = speed;
+        _startX = startX;
+        _graphDataModel = graphDataModel;
+        if (_reader.Header.TicksPerSecond > 0)
+        {
+            lock (_graphDataModel)
+                _graphDataModel.TicksPerSecond = _reader.Header.TicksPerSecond;
+        }
+    }
+
+    /// <summary>
+    /// The session the capture was recorded from.
+    /// </summary>
+    public CaptureHeader Header => _reader.Header;
+
+    // ---------- IDataChannel Methods ---------- //
+    public void Connect()
+    {
+        if (_replayThread != null) return;
+
+        _stopRequested.Reset();
+        _replayThread = new Thread(Replay) { IsBackground = true };
+        _replayThread.Start();
+    }
+
+    public void Disconnect()
+    {
+        _stopRequested.Set();
+        if (_replayThread != null && _replayThread != Thread.CurrentThread && _replayThread.IsAlive)
+            _replayThread.Join();
+        _replayThread = null;
+        _reader.Dispose();
+    }
+
+    // ---------- Implementation-specific helper methods ---------- //
+    private void Replay()
+    {
+        CaptureSample[] samples = new CaptureSample[CaptureFormat.ChunkSamples];
+        double ticksPerSecond = _reader.Header.TicksPerSecond > 0 ? _reader.Header.TicksPerSecond : 1000;
+        long firstX = _startX ?? _reader.FirstX;
+        Stopwatch clock = Stopwatch.StartNew();
+
+        for (int chunk = _reader.FindChunk(firstX); chunk < _reader.ChunkCount; chunk++)
+        {
+            int count = _reader.ReadChunk(chunk, samples);
+            int i = 0;
+            while (i < count && samples[i].X < firstX) i++; // Skip to the start within the first chunk.
+
+            while (i < count)
+            {
+                if (_stopRequested.IsSet) return;
+
+                // Find the samples that are due by now, all of them when replaying at max speed.
+                int end = count;
+                if (!double.IsPositiveInfinity(_speed))
+                {
+                    double dueX = firstX + clock.Elapsed.TotalSeconds * _speed * ticksPerSecond;
+                    end = i;
+                    while (end < count && samples[end].X <= dueX) end++;
+
+                    if (end == i)
+                    {
+                        // Nothing due yet, sleep until the next sample is.
+                        double waitMs = (samples[i].X - dueX) / (_speed * ticksPerSecond) * 1000;
+                        _stopRequested.Wait((int)Math.Clamp(Math.Ceiling(waitMs), 1, MaxSleepMs));
+                        continue;
+                    }
+                }
+
+                long requested = Stopwatch.GetTimestamp();
+                lock (_graphDataModel)
+                {
+                    long acquired = Stopwatch.GetTimestamp();
+                    for (int s = i; s < end; s++)
+                    {
+                        CaptureSample sample = samples[s];
+                        if (sample.Variable < _graphDataModel.VariableCount)
+                            _graphDataModel.AddUnwrappedPoint(sample.Variable, sample.X, sample.Y);
+                    }
+                    _graphDataModel.CommitSamples();
+                    PipelineMetrics.RecordLock(requested, acquired);
+                }
+                i = end;
+            }
+        }
+
+        ReplayCompleted?.Invoke(this, EventArgs.Empty);
+    }
+}
\ No newline at end of file
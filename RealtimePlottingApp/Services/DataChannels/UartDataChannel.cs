@@ -1,5 +1,7 @@
-﻿using RealtimePlottingApp.Events;
+﻿using System.Diagnostics;
+using RealtimePlottingApp.Events;
 using RealtimePlottingApp.Models;
+using RealtimePlottingApp.Services.Diagnostics;
 using RealtimePlottingApp.Services.UART;
 
 namespace RealtimePlottingApp.Services.DataChannels;
@@ -24,13 +26,17 @@ public class UartDataChannel : IDataChannel
     /// <param name="comPort">COM-Port for the serial stream</param>
     /// <param name="baudRate">The baud rate to receive data at</param>
     /// <param name="dataSize">The expected size of the data field in each package</param>
+    /// <param name="ticksPerSecond">The rate of the timer on the device that timestamps are counted by</param>
     /// <param name="graphDataModel">The data model to store receiving data in</param>
-    public UartDataChannel(ISerialReader serialReader ,string comPort, int baudRate, UARTDataPayloadSize dataSize, GraphDataModel graphDataModel)
+    public UartDataChannel(ISerialReader serialReader ,string comPort, int baudRate, UARTDataPayloadSize dataSize,
+        double ticksPerSecond, GraphDataModel graphDataModel)
     {
         _comPort = comPort;
         _baudRate = baudRate;
         _dataSize = dataSize;
         _graphDataModel = graphDataModel;
+        lock (_graphDataModel)
+            _graphDataModel.TicksPerSecond = ticksPerSecond;
         _serialReader = serialReader;
         _serialReader.TimestampedDataReceived += OnUartDataReceived;
     }
@@ -50,13 +56,23 @@ public class UartDataChannel : IDataChannel
     // ---------- Implementation-specific helper methods ---------- //
     private void OnUartDataReceived(object? sender, TimestampedDataReceivedEvent e)
     {
+        long requested = Stopwatch.GetTimestamp();
         lock (_graphDataModel)
         {
-            foreach (var package in e.Packages)
+            long acquired = Stopwatch.GetTimestamp();
+            // Timestamps wrap around at the width the protocol transmits them with.
+            _graphDataModel.XValBitSize = (uint)e.TimestampBits;
+
+            foreach (var package in e.Packages.Span)
             {
-                // Add timestamp and accompanied data.
-                _graphDataModel.AddPoint(package.Time, package.Data);
+                // Add timestamp and accompanied data, to the variable given by the frame if any.
+                if (package.Variable < 0)
+                    _graphDataModel.AddPoint(package.Time, package.Data);
+                else if (package.Variable < _graphDataModel.VariableCount)
+                    _graphDataModel.AddPoint(package.Variable, package.Time, package.Data);
             }
+            _graphDataModel.CommitSamples();
+            PipelineMetrics.RecordLock(requested, acquired);
         }
     }
 }
\ No newline at end of file
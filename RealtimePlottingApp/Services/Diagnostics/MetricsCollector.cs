@@ -0,0 +1,273 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Diagnostics.Metrics;
+using System.Globalization;
+using System.IO;
+using System.Threading;
+
+namespace RealtimePlottingApp.Services.Diagnostics;
+
+/// <summary>
+/// How a reading's values are to be read, given by the kind of instrument it comes from.
+/// </summary>
+public enum MetricKind
+{
+    Counter,   // Value is the rate per second, Total the running total
+    Gauge,     // Value is the current value
+    Histogram  // Value is the mean over the period, Max its largest measurement, Total the number of measurements
+}
+
+/// <summary>
+/// One instrument's (and tag's) aggregated measurements over a collection period.
+/// </summary>
+public readonly record struct MetricReading(string Name, string Unit, MetricKind Kind, double Value, double Max, double Total)
+{
+    public override string ToString()
+    {
+        // Annotations such as "{frame}" name what is counted, show them without the braces.
+        string unit = Unit.Trim('{', '}');
+        return Kind switch
+        {
+            MetricKind.Counter => $"{Name}: {Value:N0} {unit}/s ({Total:N0} total)",
+            MetricKind.Gauge => $"{Name}: {Value:N0} {unit}",
+            _ => $"{Name}: {Value:F2} {unit} avg, {Max:F2} {unit} max ({Total:N0} measured)"
+        };
+    }
+}
+
+/// <summary>
+/// Listens to the PipelineMetrics instruments in-process, and once per second aggregates their measurements
+/// into readings for the UI, optionally appending them to a CSV file as well.
+/// Works side by side with out-of-process listeners such as dotnet-counters.
+/// </summary>
+public sealed class MetricsCollector : IDisposable
+{
+    // ===== Constants ===== //
+    private static readonly TimeSpan Period = TimeSpan.FromSeconds(1);
+    private const string CsvHeader = "timestamp,metric,unit,value,max,total";
+
+    // ===== Instance Variables ===== //
+    // An instrument's measurements with one set of tags, guarded by the instrument's lock.
+    private sealed class Series(string name, KeyValuePair<string, object?>? tag)
+    {
+        public readonly string Name = name;
+        public readonly KeyValuePair<string, object?>? Tag = tag;
+        public double Total;  // Counters: sum of all measurements. Gauges: the last measurement.
+        public double Sum;    // Histograms: measurements this period
+        public double Max;
+        public long Count;
+        public double PreviousTotal;
+    }
+
+    // Instruments are tagged with at most one tag, so its series are told apart by the first one.
+    private sealed class InstrumentState(Instrument instrument)
+    {
+        public readonly Instrument Instrument = instrument;
+        public readonly MetricKind Kind = instrument switch
+        {
+            Histogram<double> => MetricKind.Histogram,
+            Counter<long> or Counter<double> => MetricKind.Counter,
+            _ => MetricKind.Gauge
+        };
+        public readonly List<Series> Series = [];
+
+        public Series GetSeries(ReadOnlySpan<KeyValuePair<string, object?>> tags)
+        {
+            foreach (Series series in Series)
+            {
+                if (tags.Length == 0 ? series.Tag == null
+                        : series.Tag?.Key == tags[0].Key && Equals(series.Tag?.Value, tags[0].Value))
+                    return series;
+            }
+            KeyValuePair<string, object?>? tag = tags.Length == 0 ? null : tags[0];
+            Series created = new(tag == null ? Instrument.Name : $"{Instrument.Name}{{{tag.Value.Key}={tag.Value.Value}}}", tag);
+            Series.Add(created);
+            return created;
+        }
+    }
+
+    private readonly MeterListener _listener = new();
+    private readonly List<InstrumentState> _instruments = []; // Guarded by itself
+    private readonly Timer _timer;
+    private long _lastCollect = Environment.TickCount64;
+    private IReadOnlyList<MetricReading> _readings = [];
+
+    private readonly object _recordingLock = new();
+    private StreamWriter? _recording;
+    private bool _disposed;
+
+    // ===== Constructor ===== //
+    /// <summary>
+    /// Starts listening to the pipeline metrics.
+    /// </summary>
+    public MetricsCollector()
+    {
+        _listener.InstrumentPublished = (instrument, listener) =>
+        {
+            if (instrument.Meter.Name != PipelineMetrics.MeterName)
+                return;
+            InstrumentState state = new(instrument);
+            lock (_instruments)
+                _instruments.Add(state);
+            listener.EnableMeasurementEvents(instrument, state);
+        };
+        _listener.SetMeasurementEventCallback<long>((_, value, tags, state) => Record(state, value, tags));
+        _listener.SetMeasurementEventCallback<double>((_, value, tags, state) => Record(state, value, tags));
+        _listener.Start();
+
+        _timer = new Timer(_ => Collect(), null, Period, Period);
+    }
+
+    // ===== API Methods ===== //
+    /// <summary>
+    /// Readings of the last period, ordered by name.
+    /// </summary>
+    public IReadOnlyList<MetricReading> Readings => Volatile.Read(ref _readings);
+
+    /// <summary>
+    /// Whether readings are being appended to a file.
+    /// </summary>
+    public bool IsRecording
+    {
+        get { lock (_recordingLock) return _recording != null; }
+    }
+
+    /// <summary>
+    /// Raised on a thread pool thread once per second, after the readings have been updated.
+    /// </summary>
+    public event EventHandler? Updated;
+
+    /// <summary>
+    /// Starts appending every period's readings to a CSV file, replacing the one being recorded to if any.
+    /// </summary>
+    /// <param name="path">Path of the CSV file to create</param>
+    /// <exception cref="IOException">Thrown if the file can't be created.</exception>
+    public void StartRecording(string path)
+    {
+        StreamWriter writer = new(path, append: false);
+        writer.WriteLine(CsvHeader);
+        lock (_recordingLock)
+        {
+            _recording?.Dispose();
+            _recording = writer;
+        }
+    }
+
+    /// <summary>
+    /// Stops recording, closing the file.
+    /// </summary>
+    public void StopRecording()
+    {
+        lock (_recordingLock)
+        {
+            _recording?.Dispose();
+            _recording = null;
+        }
+    }
+
+    public void Dispose()
+    {
+        if (_disposed)
+            return;
+        _disposed = true;
+        _timer.Dispose();
+        _listener.Dispose();
+        StopRecording();
+    }
+
+    // ===== Private Helpers ===== //
+    private static void Record(object? state, double value, ReadOnlySpan<KeyValuePair<string, object?>> tags)
+    {
+        if (state is not InstrumentState instrument)
+            return;
+
+        lock (instrument)
+        {
+            Series series = instrument.GetSeries(tags);
+            switch (instrument.Kind)
+            {
+                case MetricKind.Histogram:
+                    series.Max = series.Count == 0 ? value : Math.Max(series.Max, value);
+                    series.Sum += value;
+                    series.Count++;
+                    break;
+                case MetricKind.Counter:
+                    series.Total += value;
+                    break;
+                default:
+                    // Up-down counters are summed, observable gauges report the whole value.
+                    series.Total = instrument.Instrument.IsObservable ? value : series.Total + value;
+                    break;
+            }
+        }
+    }
+
+    // Aggregates the measurements of the period that just ended.
+    private void Collect()
+    {
+        _listener.RecordObservableInstruments();
+
+        long now = Environment.TickCount64;
+        double seconds = Math.Max((now - Interlocked.Exchange(ref _lastCollect, now)) / 1000.0, 0.001);
+
+        InstrumentState[] instruments;
+        lock (_instruments)
+            instruments = _instruments.ToArray();
+
+        List<MetricReading> readings = [];
+        foreach (InstrumentState instrument in instruments)
+        {
+            string unit = instrument.Instrument.Unit ?? "";
+            lock (instrument)
+            {
+                foreach (Series series in instrument.Series)
+                {
+                    readings.Add(instrument.Kind switch
+                    {
+                        MetricKind.Histogram => new MetricReading(series.Name, unit, instrument.Kind,
+                            series.Count == 0 ? 0 : series.Sum / series.Count, series.Max, series.Count),
+                        MetricKind.Counter => new MetricReading(series.Name, unit, instrument.Kind,
+                            (series.Total - series.PreviousTotal) / seconds, 0, series.Total),
+                        _ => new MetricReading(series.Name, unit, instrument.Kind, series.Total, series.Total, series.Total)
+                    });
+                    series.PreviousTotal = series.Total;
+                    series.Sum = 0;
+                    series.Max = 0;
+                    series.Count = 0;
+                }
+            }
+        }
+        readings.Sort((a, b) => string.CompareOrdinal(a.Name, b.Name));
+        Volatile.Write(ref _readings, readings);
+
+        WriteRecording(readings);
+        Updated?.Invoke(this, EventArgs.Empty);
+    }
+
+    // Appends the readings to the file being recorded to, if any.
+    private void WriteRecording(List<MetricReading> readings)
+    {
+        lock (_recordingLock)
+        {
+            if (_recording == null)
+                return;
+
+            try
+            {
+                string timestamp = DateTime.UtcNow.ToString("o", CultureInfo.InvariantCulture);
+                foreach (MetricReading reading in readings)
+                {
+                    _recording.WriteLine(string.Create(CultureInfo.InvariantCulture,
+                        $"{timestamp},{reading.Name},{reading.Unit},{reading.Value:R},{reading.Max:R},{reading.Total:R}"));
+                }
+                _recording.Flush();
+            }
+            catch (IOException e)
+            {
+                Console.WriteLine($"Error recording metrics: {e.Message}");
+                _recording.Dispose();
+                _recording = null;
+            }
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,107 @@
+﻿using System;
+using System.Diagnostics;
+using System.Diagnostics.Metrics;
+using RealtimePlottingApp.Models;
+
+namespace RealtimePlottingApp.Services.Diagnostics;
+
+/// <summary>
+/// Instruments of every stage that samples pass through: ingest (bytes and frames read), parse (decoding
+/// into samples), storage (the graph data and its lock) and render (extracting, plotting and drawing).
+/// Published as the "RealtimePlottingApp" System.Diagnostics.Metrics meter, so they can be read live with
+/// e.g. `dotnet-counters monitor -n RealtimePlottingApp --counters RealtimePlottingApp`, or in-process
+/// by a MetricsCollector. Recording a measurement costs next to nothing while nothing is listening.
+/// </summary>
+public static class PipelineMetrics
+{
+    public const string MeterName = "RealtimePlottingApp";
+
+    private static readonly Meter Meter = new(MeterName);
+
+    // The graph data whose memory usage is observed, set once it's created.
+    private static GraphDataModel? _graphData;
+
+    // ===== Ingest ===== //
+    public static readonly Counter<long> UartBytesRead =
+        Meter.CreateCounter<long>("rpa.uart.bytes_read", "By", "Bytes read from the serial port");
+    public static readonly Counter<long> UartBytesDropped =
+        Meter.CreateCounter<long>("rpa.uart.bytes_dropped", "By", "Bytes discarded because the receive buffer was full");
+    public static readonly Counter<long> UartCorruptFrames =
+        Meter.CreateCounter<long>("rpa.uart.corrupt_frames", "{frame}", "Corrupted frames skipped by resynchronizing");
+    public static readonly Counter<long> UartDeviceOverruns =
+        Meter.CreateCounter<long>("rpa.uart.device_overruns", "{sample}", "Samples the device dropped because its transmit buffer was full");
+    public static readonly Counter<long> CanFramesReceived =
+        Meter.CreateCounter<long>("rpa.can.frames_received", "{frame}", "CAN frames received from the bus");
+    public static readonly UpDownCounter<long> CanQueueDepth =
+        Meter.CreateUpDownCounter<long>("rpa.can.queue_depth", "{frame}", "CAN frames waiting to be processed");
+    public static readonly Counter<long> CanPoolAllocations =
+        Meter.CreateCounter<long>("rpa.can.pool_allocations", "{buffer}", "Receive buffers allocated because the pool was empty");
+
+    // ===== Parse ===== //
+    public static readonly Counter<long> ParsedSamples =
+        Meter.CreateCounter<long>("rpa.parse.samples", "{sample}", "Samples decoded from received data");
+    public static readonly Histogram<double> ParseDuration =
+        Meter.CreateHistogram<double>("rpa.parse.duration", "ms", "Time spent decoding a batch of received data");
+
+    // ===== Storage ===== //
+    public static readonly Counter<long> StoredSamples =
+        Meter.CreateCounter<long>("rpa.storage.samples", "{sample}", "Samples added to the graph data");
+    public static readonly Histogram<double> LockWait =
+        Meter.CreateHistogram<double>("rpa.storage.lock_wait", "ms", "Time a data source spent waiting for the graph data's lock");
+    public static readonly Histogram<double> LockHold =
+        Meter.CreateHistogram<double>("rpa.storage.lock_hold", "ms", "Time a data source held the graph data's lock");
+
+    // ===== Render ===== //
+    public static readonly Histogram<double> ExtractDuration =
+        Meter.CreateHistogram<double>("rpa.render.extract_duration", "ms", "Time spent extracting the line plot's series");
+    public static readonly Histogram<double> UpdateDuration =
+        Meter.CreateHistogram<double>("rpa.render.update_duration", "ms", "Time spent updating the line plot's plottables");
+    public static readonly Histogram<double> DrawDuration =
+        Meter.CreateHistogram<double>("rpa.render.draw_duration", "ms", "Time spent rendering a plot");
+    public static readonly Histogram<double> Latency =
+        Meter.CreateHistogram<double>("rpa.render.latency", "ms", "Time from samples being stored until they are rendered");
+    public static readonly Counter<long> Frames =
+        Meter.CreateCounter<long>("rpa.render.frames", "{frame}", "Frames drawn");
+    public static readonly Counter<long> DroppedFrames =
+        Meter.CreateCounter<long>("rpa.render.dropped_frames", "{frame}", "Frames held back because the previous one was still being rendered");
+
+    static PipelineMetrics()
+    {
+        Meter.CreateObservableGauge("rpa.storage.memory", ObserveMemory, "By", "Memory allocated for sample storage");
+    }
+
+    /// <summary>
+    /// Sets the graph data whose memory usage is reported.
+    /// </summary>
+    public static void Observe(GraphDataModel graphData)
+    {
+        _graphData = graphData;
+    }
+
+    /// <summary>
+    /// Records the time a data source spent waiting for and holding the graph data's lock. Call while still holding it.
+    /// </summary>
+    /// <param name="requested">Stopwatch timestamp from before taking the lock</param>
+    /// <param name="acquired">Stopwatch timestamp from right after taking the lock</param>
+    public static void RecordLock(long requested, long acquired)
+    {
+        if (LockWait.Enabled)
+            LockWait.Record(Stopwatch.GetElapsedTime(requested, acquired).TotalMilliseconds);
+        if (LockHold.Enabled)
+            LockHold.Record(Stopwatch.GetElapsedTime(acquired).TotalMilliseconds);
+    }
+
+    /// <summary>
+    /// Records the milliseconds elapsed since the given Stopwatch timestamp.
+    /// </summary>
+    public static void RecordSince(Histogram<double> histogram, long start)
+    {
+        if (histogram.Enabled)
+            histogram.Record(Stopwatch.GetElapsedTime(start).TotalMilliseconds);
+    }
+
+    private static long ObserveMemory()
+    {
+        return _graphData?.Snapshot().MemoryUsageBytes ?? 0;
+    }
+}
\ No newline at end of file
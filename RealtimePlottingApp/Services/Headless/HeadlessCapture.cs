@@ -0,0 +1,250 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.Globalization;
+using System.IO;
+using System.Linq;
+using System.Runtime.InteropServices;
+using System.Threading;
+using RealtimePlottingApp.Models;
+using RealtimePlottingApp.Services.CAN;
+using RealtimePlottingApp.Services.Capture;
+using RealtimePlottingApp.Services.ConfigHandler;
+using RealtimePlottingApp.Services.ConfigParsers;
+using RealtimePlottingApp.Services.DataChannels;
+using RealtimePlottingApp.Services.Diagnostics;
+using RealtimePlottingApp.Services.UART;
+
+namespace RealtimePlottingApp.Services.Headless;
+
+/// <summary>
+/// Runs a capture without any UI, for soak tests and bench rigs on machines without a display.
+/// Connects the same data channels as the application, configured from a saved configuration file,
+/// and records every decoded sample to rotating (compressed) files through a RotatingCaptureWriter.
+/// Throughput and drop statistics from the pipeline metrics are printed periodically.
+/// With no UI thread or rendering competing for the CPU, this shows the ceiling of the acquisition path.
+/// </summary>
+public static class HeadlessCapture
+{
+    // ===== Constants ===== //
+    // Samples are only kept in memory until recorded, which happens on every commit.
+    // A few chunks per variable leaves room for large batches.
+    private const long RetainedSamples = 4L * SampleColumn.ChunkSize;
+    private const int AttachParentProcess = -1;
+
+    // Labels of the sidebar's bit rate and data size dropdowns, whose indexes the configuration file holds.
+    private static readonly string[] BitRates =
+    [
+        "5 kBit/s", "10 kBit/s", "20 kBit/s", "33 kBit/s", "47 kBit/s", "50 kBit/s", "83 kBit/s",
+        "95 kBit/s", "100 kBit/s", "125 kBit/s", "250 kBit/s", "500 kBit/s", "800 kBit/s", "1 MBit/s"
+    ];
+    private static readonly string[] DataSizes = ["8 bits", "16 bits", "32 bits"];
+
+    // ===== Entry Point ===== //
+    /// <summary>
+    /// Runs a headless capture with the given command line until it is stopped.
+    /// </summary>
+    /// <returns>The process exit code: 0 on success, 1 if the capture failed, 2 for invalid arguments.</returns>
+    public static int Run(string[] args)
+    {
+        // The application is built as a GUI executable, which has no console of its own on Windows.
+        if (OperatingSystem.IsWindows())
+            AttachConsole(AttachParentProcess);
+
+        HeadlessOptions options;
+        string connectMessage;
+        try
+        {
+            options = HeadlessOptions.Parse(args);
+            connectMessage = LoadConnectMessage(options);
+        }
+        catch (Exception e)
+        {
+            Console.Error.WriteLine(e.Message);
+            Console.Error.WriteLine();
+            Console.Error.WriteLine(HeadlessOptions.Usage);
+            return 2;
+        }
+
+        GraphDataModel graphData = new() { Retention = RetentionPolicy.LastSamples(RetainedSamples) };
+        IConfigParser configParser = new ConfigParser();
+        using ManualResetEventSlim stop = new(false);
+        ConsoleCancelEventHandler onCancel = (_, e) =>
+        {
+            e.Cancel = true; // Stop the capture orderly, so the files are finalized.
+            stop.Set();
+        };
+
+        IDataChannel? dataChannel = null;
+        CaptureRecorder? recorder = null;
+        RotatingCaptureWriter? writer = null;
+        using MetricsCollector metrics = new();
+        PipelineMetrics.Observe(graphData);
+        Console.CancelKeyPress += onCancel;
+        try
+        {
+            dataChannel = CreateDataChannel(options.Interface, connectMessage, configParser, graphData);
+            recorder = new CaptureRecorder(graphData, header => writer = new RotatingCaptureWriter(
+                    options.OutputDirectory, options.Prefix, header, options.Format,
+                    options.MaxFileBytes, options.MaxFileAge, options.Compress),
+                connectMessage);
+            dataChannel.Connect();
+
+            Console.WriteLine($"Capturing {connectMessage}");
+            Console.WriteLine($"Writing to {Path.GetFullPath(options.OutputDirectory)}, press Ctrl+C to stop.");
+
+            StatisticsPrinter printer = new(options.StatsInterval, recorder, writer!);
+            metrics.Updated += (_, _) => printer.OnMetricsUpdated(metrics.Readings);
+
+            if (options.Duration > TimeSpan.Zero)
+                stop.Wait(options.Duration);
+            else
+                stop.Wait();
+
+            dataChannel.Disconnect();
+            dataChannel = null;
+            recorder.Dispose(); // Waits for the last files to be compressed.
+            printer.PrintSummary();
+            return 0;
+        }
+        catch (Exception e)
+        {
+            Console.Error.WriteLine($"Capture failed: {e.Message}");
+            return 1;
+        }
+        finally
+        {
+            Console.CancelKeyPress -= onCancel;
+            try
+            {
+                dataChannel?.Disconnect();
+            }
+            catch (Exception e)
+            {
+                Console.Error.WriteLine($"Error disconnecting: {e.Message}");
+            }
+            recorder?.Dispose();
+        }
+    }
+
+    // ===== Private Helpers ===== //
+    // Builds the connect message the sidebar would send for the configuration file's settings.
+    private static string LoadConnectMessage(HeadlessOptions options)
+    {
+        IConfigService config = ConfigService.Instance;
+        config.FilePath = options.ConfigPath;
+
+        if (options.Interface == HeadlessInterface.Uart)
+        {
+            double tickRate = config.LoadConfig<double?>("TimestampRate") ?? ConfigParser.DefaultUartTickRate;
+            return $"ConnectUart:ComPort:{config.LoadConfig<string?>("ComPort")}," +
+                   $"BaudRate:{config.LoadConfig<int?>("BaudRate")}," +
+                   $"DataSize:{Label(DataSizes, config.LoadConfig<int>("PayloadDataSize"))}," +
+                   $"UniqueVars:{config.LoadConfig<int?>("UniqueVars")}," +
+                   $"TickRate:{tickRate.ToString(CultureInfo.InvariantCulture)}";
+        }
+
+        return $"ConnectCan:CanInterface:{config.LoadConfig<string?>("CanInterface")}," +
+               $"BitRate:{Label(BitRates, config.LoadConfig<int>("BitRate"))}," +
+               $"CanIdFilter:{config.LoadConfig<int?>("CanIdFilter")}," +
+               $"DataPayloadMask:{config.LoadConfig<string?>("CanDataMask")}";
+    }
+
+    private static string Label(string[] labels, int index) =>
+        index >= 0 && index < labels.Length ? labels[index] : "";
+
+    // Creates the data channel for a connect message, as GraphDiagramViewModel does on connect.
+    private static IDataChannel CreateDataChannel(HeadlessInterface dataInterface, string connectMessage,
+        IConfigParser configParser, GraphDataModel graphData)
+    {
+        if (dataInterface == HeadlessInterface.Uart)
+        {
+            if (!configParser.ParseUartConfig(connectMessage, out string comPort, out int baudRate,
+                    out UARTDataPayloadSize dataSize, out int uniqueVars, out double ticksPerSecond))
+                throw new FormatException("The configuration file has no complete UART configuration.");
+
+            lock (graphData)
+                graphData.VariableCount = uniqueVars;
+            return new UartDataChannel(new UARTSerialReader(), comPort, baudRate, dataSize, ticksPerSecond, graphData);
+        }
+
+        if (!configParser.ParseCanConfig(connectMessage, out string canInterface, out string bitRate,
+                out int canIdFilter, out string canDataPayloadMask))
+            throw new FormatException("The configuration file has no complete CAN configuration.");
+
+        Dictionary<uint, CanPayloadPlan> canRoutes = configParser.ParseCanRoutes(canIdFilter, canDataPayloadMask);
+        lock (graphData)
+            graphData.VariableCount = canRoutes.Values.Sum(plan => plan.VariableCount);
+        return new CanDataChannel(ControllerAreaNetwork.Create(), canInterface,
+            // On Linux bitrate is not set via the application, but socketcan.
+            OperatingSystem.IsWindows() ? bitRate : null,
+            canRoutes, graphData);
+    }
+
+    [DllImport("kernel32.dll")]
+    private static extern bool AttachConsole(int processId);
+
+    // ===== Statistics ===== //
+    // Prints the pipeline's counters averaged over each interval, from the collector's once per second readings.
+    // Updated on the collector's thread, so the printing is guarded by the printer's lock.
+    private sealed class StatisticsPrinter(TimeSpan interval, CaptureRecorder recorder, RotatingCaptureWriter writer)
+    {
+        private readonly object _lock = new();
+        private readonly Stopwatch _elapsed = Stopwatch.StartNew();
+        private readonly Dictionary<string, double> _previousTotals = [];
+        private TimeSpan _lastPrint = TimeSpan.Zero;
+        private IReadOnlyList<MetricReading> _readings = [];
+
+        public void OnMetricsUpdated(IReadOnlyList<MetricReading> readings)
+        {
+            lock (_lock)
+            {
+                _readings = readings;
+                TimeSpan now = _elapsed.Elapsed;
+                if (now - _lastPrint < interval)
+                    return;
+
+                double seconds = (now - _lastPrint).TotalSeconds;
+                _lastPrint = now;
+                Print(now, seconds);
+            }
+        }
+
+        public void PrintSummary()
+        {
+            lock (_lock)
+            {
+                TimeSpan now = _elapsed.Elapsed;
+                Print(now, (now - _lastPrint).TotalSeconds);
+                _lastPrint = now;
+                Console.WriteLine($"Captured {recorder.SampleCount:N0} samples into {writer.FileCount} file(s) " +
+                                  $"in {now:hh\\:mm\\:ss}, {recorder.SampleCount / Math.Max(now.TotalSeconds, 0.001):N0} samples/s.");
+            }
+        }
+
+        private void Print(TimeSpan now, double seconds)
+        {
+            List<string> values = [];
+            foreach (MetricReading reading in _readings)
+            {
+                string unit = reading.Unit.Trim('{', '}');
+                switch (reading.Kind)
+                {
+                    case MetricKind.Counter:
+                        _previousTotals.TryGetValue(reading.Name, out double previous);
+                        _previousTotals[reading.Name] = reading.Total;
+                        values.Add($"{reading.Name} {(reading.Total - previous) / Math.Max(seconds, 0.001):N0} {unit}/s ({reading.Total:N0})");
+                        break;
+                    case MetricKind.Gauge:
+                        values.Add($"{reading.Name} {reading.Value:N0} {unit}");
+                        break;
+                }
+            }
+
+            Console.WriteLine($"[{now:hh\\:mm\\:ss}] {recorder.SampleCount:N0} samples written, {writer.FileCount} file(s), " +
+                              $"current: {writer.CurrentPath ?? "-"}");
+            if (values.Count > 0)
+                Console.WriteLine("    " + string.Join(" | ", values));
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,157 @@
+﻿using System;
+using System.Globalization;
+using RealtimePlottingApp.Services.Capture;
+
+namespace RealtimePlottingApp.Services.Headless;
+
+/// <summary>
+/// Data source a headless capture connects to.
+/// </summary>
+public enum HeadlessInterface
+{
+    Uart,
+    Can
+}
+
+/// <summary>
+/// Command line options of a headless capture, see Usage.
+/// </summary>
+public sealed class HeadlessOptions
+{
+    /// <summary>
+    /// Command line argument that starts the application headless instead of opening its window.
+    /// </summary>
+    public const string Flag = "--headless";
+
+    public const string Usage =
+        """
+        Usage: RealtimePlottingApp --headless --config <file.json> --interface <uart|can> [options]
+
+        Connects to UART or CAN with the settings of a saved configuration file, and streams
+        every decoded sample to rotating files until stopped by Ctrl+C or --duration.
+
+          --config <file>         Configuration file saved from the application (File > Save Config)
+          --interface <uart|can>  Which of the configuration's connections to use
+          --output <dir>          Directory to write the files to (default: current directory)
+          --prefix <name>         Start of the file names (default: capture)
+          --format <rpcap|csv>    Capture files or CSV (default: rpcap)
+          --rotate-mb <n>         Start a new file after n megabytes, uncompressed (default: 256)
+          --rotate-minutes <n>    Start a new file after n minutes, 0 to only rotate by size (default: 60)
+          --compress              Gzip compress closed files (default for csv). Compressed capture
+                                  files must be decompressed before the application can replay them
+          --no-compress           Keep closed files as they are (default for rpcap)
+          --stats <seconds>       Interval of the throughput and drop statistics (default: 10)
+          --duration <seconds>    Stop after the given time, 0 to run until Ctrl+C (default: 0)
+        """;
+
+    // ===== Options ===== //
+    public string ConfigPath { get; private set; } = "";
+    public HeadlessInterface Interface { get; private set; }
+    public string OutputDirectory { get; private set; } = ".";
+    public string Prefix { get; private set; } = "capture";
+    public CaptureFileFormat Format { get; private set; } = CaptureFileFormat.Capture;
+    public long MaxFileBytes { get; private set; } = 256L * 1024 * 1024;
+    public TimeSpan MaxFileAge { get; private set; } = TimeSpan.FromMinutes(60);
+    public bool Compress => _compress ?? Format == CaptureFileFormat.Csv;
+    public TimeSpan StatsInterval { get; private set; } = TimeSpan.FromSeconds(10);
+    public TimeSpan Duration { get; private set; } = TimeSpan.Zero;
+
+    // Unless given, capture files are kept replayable and CSV files are compressed.
+    private bool? _compress;
+
+    // ===== Parsing ===== //
+    /// <summary>
+    /// Whether the command line asks for a headless capture.
+    /// </summary>
+    public static bool IsRequested(string[] args) => Array.IndexOf(args, Flag) >= 0;
+
+    /// <summary>
+    /// Parses the command line of a headless capture.
+    /// </summary>
+    /// <exception cref="FormatException">Thrown if an option is unknown, missing its value or invalid.</exception>
+    public static HeadlessOptions Parse(string[] args)
+    {
+        HeadlessOptions options = new();
+        bool hasInterface = false;
+
+        for (int i = 0; i < args.Length; i++)
+        {
+            string option = args[i];
+            switch (option)
+            {
+                case Flag:
+                    break;
+                case "--config":
+                    options.ConfigPath = Value(args, ref i);
+                    break;
+                case "--interface":
+                    options.Interface = Value(args, ref i).ToLowerInvariant() switch
+                    {
+                        "uart" => HeadlessInterface.Uart,
+                        "can" => HeadlessInterface.Can,
+                        var other => throw new FormatException($"Unknown interface \"{other}\".")
+                    };
+                    hasInterface = true;
+                    break;
+                case "--output":
+                    options.OutputDirectory = Value(args, ref i);
+                    break;
+                case "--prefix":
+                    options.Prefix = Value(args, ref i);
+                    break;
+                case "--format":
+                    options.Format = Value(args, ref i).ToLowerInvariant() switch
+                    {
+                        "rpcap" => CaptureFileFormat.Capture,
+                        "csv" => CaptureFileFormat.Csv,
+                        var other => throw new FormatException($"Unknown format \"{other}\".")
+                    };
+                    break;
+                case "--rotate-mb":
+                    options.MaxFileBytes = (long)(Number(args, ref i, 0.001) * 1024 * 1024);
+                    break;
+                case "--rotate-minutes":
+                    options.MaxFileAge = TimeSpan.FromMinutes(Number(args, ref i, 0));
+                    break;
+                case "--compress":
+                    options._compress = true;
+                    break;
+                case "--no-compress":
+                    options._compress = false;
+                    break;
+                case "--stats":
+                    options.StatsInterval = TimeSpan.FromSeconds(Number(args, ref i, 1));
+                    break;
+                case "--duration":
+                    options.Duration = TimeSpan.FromSeconds(Number(args, ref i, 0));
+                    break;
+                default:
+                    throw new FormatException($"Unknown option \"{option}\".");
+            }
+        }
+
+        if (options.ConfigPath.Length == 0)
+            throw new FormatException("A configuration file must be given with --config.");
+        if (!hasInterface)
+            throw new FormatException("An interface must be given with --interface.");
+        return options;
+    }
+
+    // Takes the value following an option.
+    private static string Value(string[] args, ref int i)
+    {
+        if (i + 1 >= args.Length)
+            throw new FormatException($"Option \"{args[i]}\" needs a value.");
+        return args[++i];
+    }
+
+    // Takes the numeric value following an option, which must be at least min.
+    private static double Number(string[] args, ref int i, double min)
+    {
+        string option = args[i];
+        if (!double.TryParse(Value(args, ref i), NumberStyles.Float, CultureInfo.InvariantCulture, out double value) ||
+            value < min)
+            throw new FormatException($"Option \"{option}\" needs a number of at least {min}.");
+        return value;
+    }
+}
\ No newline at end of file
@@ -1,4 +1,5 @@
 ﻿using RealtimePlottingApp.Models;
+using RealtimePlottingApp.Services.Statistics;
 
 namespace RealtimePlottingApp.Services.Plotting.BlockDiagram;
 
@@ -6,13 +7,14 @@ public class BlockDataService : IBlockDataService
 {
     // ===== Instance Variables ===== //
     private readonly GraphDataModel _graphDataModel;
-    private int _uniqueVars = 1;
+    private readonly IStatisticsService _statistics;
     
     // ===== Constructor ===== //
-    public BlockDataService(GraphDataModel graphDataModel)
+    public BlockDataService(GraphDataModel graphDataModel, IStatisticsService statistics)
     {
-        // Take an instance of a graph data model via constructor injection
+        // Take an instance of a graph data model and its statistics via constructor injection
         _graphDataModel = graphDataModel;
+        _statistics = statistics;
     }
     
     // ===== API Methods ===== //
@@ -22,42 +24,20 @@ public class BlockDataService : IBlockDataService
         get => _graphDataModel;
     }
 
-    public int UniqueVars
-    {
-        get => _uniqueVars;
-        set => _uniqueVars = value;
-    }
+    public int UniqueVars => _graphDataModel.VariableCount;
     
-    public double[] ExtractVariableValues()
+    public VariableStatistics[] ExtractVariableStatistics()
     {
-        // List to contain latest value for each variable:
+        // List to contain the statistics of each variable:
         // [Var1, Var2, ... Var_uniqueVars]
-        double[] variableValues = new double[_uniqueVars];
-
-        // Track which variables we've found so we can stop early.
-        bool[] varFound = new bool[_uniqueVars];
-        int remaining = _uniqueVars; // Number of remaining variables to find value for.
+        VariableStatistics[] variableStatistics = new VariableStatistics[UniqueVars];
         
-        // Lock datamodel to extract
-        lock (_graphDataModel)
-        {
-            // Go backwards in the data array to find most recent
-            for (int i = _graphDataModel.YData.Count - 1; i >= 0 && remaining > 0; i--)
-            {
-                int varIndex = i % _uniqueVars;
-                
-                // If variable already found ,skip
-                if (varFound[varIndex]) continue;
-                
-                // Variable's last value found. Add into result and mark as found.
-                variableValues[varIndex] = _graphDataModel.YData[i];
-                varFound[varIndex] = true;
-                remaining--;
-            }
-        }
+        // Kept up to date at ingest, so reading them is constant time however long the session is.
+        for (int v = 0; v < variableStatistics.Length; v++)
+            variableStatistics[v] = _statistics.GetWindow(v);
         
         // Return the resulting list
-        return variableValues;
+        return variableStatistics;
     }
     
     public void ClearData()
@@ -1,6 +1,6 @@
-﻿using System.Collections.ObjectModel;
+﻿using System;
+using System.Collections.ObjectModel;
 using System.Linq;
-using Avalonia.Threading;
 using RealtimePlottingApp.Models;
 using ScottPlot;
 using ScottPlot.Avalonia;
@@ -26,6 +26,8 @@ public class BlockUiService :IBlockUiService
         get => _blockPlot;
         set
         {
+            if (_blockPlot != null)
+                _blockPlot.Plot.RenderManager.RenderFinished -= OnRenderFinished;
             _blockPlot = value;
             _blockPlot?.Plot.XLabel("Variable");
             _blockPlot?.Plot.YLabel("Value");
@@ -34,6 +36,8 @@ public class BlockUiService :IBlockUiService
             _blockPlot.Plot.Title("Block Diagram");
             _blockPlot.Plot.Axes.Bottom.Label.Bold = false;
             _blockPlot.Plot.Axes.Left.Label.Bold = false;
+            _blockPlot.Plot.ShowLegend(); // Lists each variable's statistics
+            _blockPlot.Plot.RenderManager.RenderFinished += OnRenderFinished;
         }
     }
 
@@ -48,47 +52,59 @@ public class BlockUiService :IBlockUiService
         }
     }
         
-    public void UpdateBlockUI(double[] data)
+    public event EventHandler<TimeSpan>? Rendered;
+        
+    public void UpdateBlockUI(VariableStatistics[] statistics)
     {
-        // Update UI asynchronously on Avalonia's UI Thread
-        Dispatcher.UIThread.InvokeAsync(() =>
+        // Return early if plot is not instantiated
+        if (BlockPlot == null) return;
+        
+        // Clear previous blocks:
+        BlockPlot.Plot.Clear();
+        
+        // Add new blocks using the latest values, position them accordingly and configure visuals
+        for (int i = 0; i < statistics.Length; i++)
         {
-            // Return early if plot is not instantiated
-            if (BlockPlot == null) return;
+            VariableStatistics stats = statistics[i];
+            var bar = BlockPlot.Plot.Add.Bar(0 + ( 0.85 * i ), stats.Count > 0 ? stats.Latest : 0);
             
-            // Clear previous blocks:
-            BlockPlot.Plot.Clear();
-            
-            // Add new blocks using the given data, position them accordingly and configure visuals
-            for (int i = 0; i < data.Length; i++)
-            {
-                var bar = BlockPlot.Plot.Add.Bar(0 + ( 0.85 * i ), data[i]);
-                
-                // Customize bar. Set color, legend, visibility..
-                bar.Color = _palette.GetColor(i % _palette.Colors.Length); 
-                bar.LegendText = PlotConfigVariables?.Count > i
-                    ? PlotConfigVariables[i].Name : $"Var {i+1}"; // Fallback
-                bar.Color = _palette.GetColor(i % _palette.Colors.Length); // Each var nr. has a preset color. 
-                   
-                // Do not plot the variable if visibility is unchecked by the user in the UI
-                if (PlotConfigVariables?.Count > i && !PlotConfigVariables[i].IsChecked)
-                    bar.IsVisible = false;
+            // Customize bar. Set color, legend, visibility..
+            bar.Color = _palette.GetColor(i % _palette.Colors.Length); 
+            string name = PlotConfigVariables?.Count > i
+                ? PlotConfigVariables[i].Name : $"Var {i+1}"; // Fallback
+            bar.LegendText = stats.Count > 0 ? $"{name}: {FormatStatistics(stats)}" : name;
+            bar.Color = _palette.GetColor(i % _palette.Colors.Length); // Each var nr. has a preset color. 
+               
+            // Do not plot the variable if visibility is unchecked by the user in the UI
+            if (PlotConfigVariables?.Count > i && !PlotConfigVariables[i].IsChecked)
+                bar.IsVisible = false;
 
-            }
-            
-            // Adjust the view-window automatically and refresh UI
-            AdjustGraphView(data);
-            BlockPlot.Refresh();
-        });
+        }
+        
+        // Adjust the view-window automatically and refresh UI
+        AdjustGraphView(statistics);
+        BlockPlot.Refresh();
     }
 
     // ===== UI Helper ===== //
-    private void AdjustGraphView(double[] data)
+    private void OnRenderFinished(object? sender, RenderDetails details)
+    {
+        Rendered?.Invoke(this, details.Elapsed);
+    }
+
+    // Summary of a variable's recent samples, shown in the legend.
+    private static string FormatStatistics(VariableStatistics stats) =>
+        $"mean {stats.Mean:G4}, rms {stats.Rms:G4}, range {stats.Min:G6} to {stats.Max:G6}, " +
+        $"median {stats.Median:G4}, p95 {stats.Percentile95:G4}" +
+        (double.IsNaN(stats.SampleRate) ? "" : $", {stats.SampleRate:N0} samples/s");
+
+    private void AdjustGraphView(VariableStatistics[] statistics)
     {
-        // Check if a new high has been reached and set it as max on Y axis view.
+        // Check if a new high has been reached within the window and set it as max on Y axis view.
         // Used to prevent axis from re-scaling too much.
-        if (data.Max() > maxValueY)
-            maxValueY = data.Max() * 1.1; // Adjust top of window to be 10% above max point
+        double max = statistics.Where(s => s.Count > 0).Select(s => s.Max).DefaultIfEmpty(0).Max();
+        if (max > maxValueY)
+            maxValueY = max * 1.1; // Adjust top of window to be 10% above max point
 
         // Update Axis Ranges
         BlockPlot?.Plot.Axes.SetLimitsY(-1, maxValueY);
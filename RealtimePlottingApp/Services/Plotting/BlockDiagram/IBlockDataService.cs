@@ -3,8 +3,8 @@
 namespace RealtimePlottingApp.Services.Plotting.BlockDiagram;
 
 /// <summary>
-/// Buffers or receives the latest values for each variable,
-/// exposes only a double array of values for extraction.
+/// Provides the latest value and running statistics of each variable,
+/// exposed as an array of statistics for extraction.
 /// </summary>
 public interface IBlockDataService
 {
@@ -16,14 +16,15 @@ public interface IBlockDataService
     /// <summary>
     /// Represents the number of unique variables
     /// to be extracted from the underlying datastructure.
+    /// Read from the data model, whose variable count is set through the graph data service.
     /// </summary>
-    int UniqueVars { get; set; }
+    int UniqueVars { get; }
     
     /// <summary>
-    /// The most recent value for each variable,
-    /// in display order (Var1, Var2...).
+    /// The statistics of each variable over the sliding window, including its
+    /// most recent value, in display order (Var1, Var2...).
     /// </summary>
-    double[] ExtractVariableValues();
+    VariableStatistics[] ExtractVariableStatistics();
     
     /// <summary>
     /// Clears all data in the underlying data structures.
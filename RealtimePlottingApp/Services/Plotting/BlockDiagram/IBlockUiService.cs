@@ -1,4 +1,5 @@
-﻿using System.Collections.ObjectModel;
+﻿using System;
+using System.Collections.ObjectModel;
 using RealtimePlottingApp.Models;
 using ScottPlot.Avalonia;
 
@@ -21,7 +22,14 @@ public interface IBlockUiService
     ObservableCollection<IVariableModel>? PlotConfigVariables { get; set; }
     
     /// <summary>
-    /// Redraws the block diagram (blocks + legend).
+    /// Raised whenever the plot has been rendered, with the time the render took.
+    /// May be raised on the render thread.
     /// </summary>
-    void UpdateBlockUI(double[] data);
+    event EventHandler<TimeSpan>? Rendered;
+    
+    /// <summary>
+    /// Redraws the block diagram (blocks of the latest values + legend with each variable's statistics)
+    /// and requests a render. Must be called on the UI thread.
+    /// </summary>
+    void UpdateBlockUI(VariableStatistics[] statistics);
 }
\ No newline at end of file
@@ -0,0 +1,83 @@
+﻿using System;
+
+namespace RealtimePlottingApp.Services.Plotting;
+
+/// <summary>
+/// Decides when the plots are redrawn. A plot is only redrawn once new samples have been committed
+/// or it has been invalidated, at most once per frame interval, and never while its previous frame
+/// is still waiting to be rendered, so that slow renders coalesce updates rather than queueing them.
+/// </summary>
+public interface IRenderScheduler
+{
+    /// <summary>
+    /// Upper bound of the frame rate. The achieved rate adapts below it when rendering is slow.
+    /// </summary>
+    double TargetFps { get; set; }
+
+    /// <summary>
+    /// Frames drawn per second, measured over the last statistics period.
+    /// </summary>
+    double AchievedFps { get; }
+
+    /// <summary>
+    /// Smoothed time in milliseconds spent per frame, updating the plots plus rendering them.
+    /// </summary>
+    double RenderTimeMs { get; }
+
+    /// <summary>
+    /// Smoothed time in milliseconds from a batch of samples being committed to the graph data,
+    /// until the plot showing them has been rendered.
+    /// </summary>
+    double LatencyMs { get; }
+
+    /// <summary>
+    /// Number of frames skipped because a plot's previous frame was still being rendered.
+    /// </summary>
+    long DroppedFrames { get; }
+
+    /// <summary>
+    /// Whether committed samples cause redraws. Invalidated plots are redrawn regardless.
+    /// </summary>
+    bool IsRunning { get; }
+
+    /// <summary>
+    /// Raised on the UI thread once per second, after the frame rate has been measured.
+    /// </summary>
+    event EventHandler? StatisticsUpdated;
+
+    /// <summary>
+    /// Adds a plot to schedule frames for.
+    /// </summary>
+    /// <param name="render">Updates the plot with the latest data, and requests it to be rendered.
+    /// Called on the UI thread. Returns false if nothing will be rendered, e.g. as the plot is hidden,
+    /// in which case the frame completes without waiting for Presented.</param>
+    /// <returns>The plot's number, to pass to Invalidate and Presented.</returns>
+    int AddPlot(Func<bool> render);
+
+    /// <summary>
+    /// Starts redrawing the plots as samples are committed.
+    /// </summary>
+    void Start();
+
+    /// <summary>
+    /// Stops redrawing the plots as samples are committed. Can be called from any thread.
+    /// </summary>
+    void Stop();
+
+    /// <summary>
+    /// Requests every plot to be redrawn, e.g. after a view change. Can be called from any thread.
+    /// </summary>
+    void Invalidate();
+
+    /// <summary>
+    /// Requests a plot to be redrawn, e.g. after a view change. Can be called from any thread.
+    /// </summary>
+    void Invalidate(int plot);
+
+    /// <summary>
+    /// Notifies that a plot has been rendered, which completes its frame. Can be called from any thread.
+    /// </summary>
+    /// <param name="plot">The plot's number.</param>
+    /// <param name="renderTime">Time the render took.</param>
+    void Presented(int plot, TimeSpan renderTime);
+}
\ No newline at end of file
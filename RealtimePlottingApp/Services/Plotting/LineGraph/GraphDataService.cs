@@ -1,7 +1,9 @@
 ﻿using System;
 using System.Collections.Generic;
-using System.Linq;
+using System.Diagnostics;
+using System.Numerics;
 using RealtimePlottingApp.Models;
+using RealtimePlottingApp.Services.Diagnostics;
 
 namespace RealtimePlottingApp.Services.Plotting.LineGraph
 {
@@ -9,15 +11,15 @@ namespace RealtimePlottingApp.Services.Plotting.LineGraph
     {
         // --- Models --- //
         private readonly GraphDataModel _graphData;
-        
+
         // --- Plotting modes & restraints --- //
-        private int _uniqueVars = 1; // 1 Variable as default. Could change alongside UI config.
         private bool _plotFullHistory; // False default
-        private double _windowWidth = 75; // X-Axis unit width (how many points to show) 
-        
-        // --- Buffers to avoid torturing the heap --- //
-        private double[] _xBuffer = [];
-        private double[] _yBuffer = [];
+        private double _windowWidth = 5; // X-Axis width in seconds
+        private int _pixelWidth = 1000; // Plot width in pixels, bounds the points produced per variable
+        private (double Min, double Max)? _historyView; // Visible X range in history mode (seconds), null for all
+
+        // --- Buffers to avoid torturing the heap, one series per variable reused across frames --- //
+        private PlotSeries[] _series = [];
 
         public GraphDataService(GraphDataModel graphData)
         {
@@ -29,8 +31,14 @@ namespace RealtimePlottingApp.Services.Plotting.LineGraph
 
         public int UniqueVars
         {
-            get => _uniqueVars;
-            set => _uniqueVars = value;
+            get => _graphData.VariableCount;
+            set
+            {
+                lock (_graphData)
+                {
+                    _graphData.VariableCount = value;
+                }
+            }
         }
 
         public double WindowWidth
@@ -39,176 +47,241 @@ namespace RealtimePlottingApp.Services.Plotting.LineGraph
             set => _windowWidth = value;
         }
 
+        public int PixelWidth
+        {
+            get => _pixelWidth;
+            set => _pixelWidth = Math.Max(value, 1);
+        }
+
+        public int PreTriggerSamples { get; set; }
+
+        public int PostTriggerSamples { get; set; }
+
         public bool IsFullHistory => _plotFullHistory;
 
         public void ClearData()
         {
-            _graphData.Clear();
+            lock (_graphData)
+            {
+                _graphData.Clear();
+            }
         }
 
         public void SetFullHistory(bool fullHistory)
         {
             // Set full history mode, indicates we should plot entire data history.
             _plotFullHistory = fullHistory;
+            _historyView = null; // Start out showing the entire history.
         }
 
-        public void GetSubData(out double[] xDataDouble, out double[] yDataDouble, out int localTriggerIndex, 
-            int? currentTriggerIndex, int? lastTriggerIndex, TriggerMode triggerMode)
+        public void SetHistoryView(double minX, double maxX)
         {
-            // Lock the graph data while reading it to ensure consistency
-            lock (_graphData)
-            {
-                int totalPoints = _graphData.XData.Count;
-                
-                // Simple check whether duplicates exist, to help deciding normal trigger window size adjustments.
-                int expected = 100 / _uniqueVars;
-                int actual = new HashSet<uint>(_graphData.XData.Skip(totalPoints - 100)).Count;
-                bool dupesExist = actual < expected * 0.85 || actual > expected * 1.15;
-                
-                // Determine candidate for where to start plotting data from on this UI update.
-                int candidate = 0;
-
-                if (!_plotFullHistory && totalPoints > (int)(_windowWidth * _uniqueVars))
-                {
-                    // Set initial candidate
-                    candidate = totalPoints - ((int)_windowWidth * _uniqueVars + 1);
-                    candidate = Math.Max(0, candidate);
-
-                    uint targetTimestamp = _graphData.XData[^1];
-                    uint cutoffGuess = _graphData.XData[candidate];
-
-                    // If initial candidat isn't spaced enough (#points > one per timestamp), search backwards
-                    if (targetTimestamp - cutoffGuess < _windowWidth)
-                    {
-                        uint cutoff = targetTimestamp > (uint)_windowWidth
-                            ? targetTimestamp - (uint)_windowWidth
-                            : 0;
-
-                        // Binary search for last value <= cutoff
-                        int low = 0;
-                        int high = totalPoints - 1;
-                        int foundIndex = candidate;
-
-                        while (low <= high)
-                        {
-                            int mid = (low + high) / 2;
-                            uint ts = _graphData.XData[mid];
-
-                            if (ts <= cutoff)
-                            {
-                                foundIndex = mid;
-                                low = mid + 1;
-                            }
-                            else
-                            {
-                                high = mid - 1;
-                            }
-                        }
-
-                        candidate = foundIndex;
-                    }
-                }
+            _historyView = (minX, maxX);
+        }
 
-                // Indexes to determine subarray ranges for xDataDouble and yDataDouble
-                int startIndex;
-                int endIndex;
-                localTriggerIndex = -1;
+        public void GetSubData(out IReadOnlyList<PlotSeries> series, out int localTriggerIndex,
+            TriggerPoint? currentTrigger, TriggerPoint? lastTrigger, TriggerMode triggerMode)
+        {
+            // Read a snapshot of the graph data, so that the data source keeps adding samples meanwhile.
+            long start = Stopwatch.GetTimestamp();
+            GraphSnapshot snapshot = _graphData.Snapshot();
+            IReadOnlyList<ColumnSnapshot> columns = snapshot.Columns;
+
+            // Windows are defined in seconds and converted to the data source's ticks, so they cover
+            // the same time whatever the sample rate, and whichever rates the variables arrive at.
+            double ticksPerSecond = _graphData.TicksPerSecond > 0 ? _graphData.TicksPerSecond : 1000;
+            long width = ClampToTimestamp(Math.Ceiling(Math.Max(_windowWidth, 0) * ticksPerSecond));
+
+            // Timestamp range [fromX, toX] to extract for every variable. Null means unbounded.
+            long? fromX = null;
+            long? toX = null;
+            TriggerPoint? trigger = null;
+            localTriggerIndex = -1;
+
+            // Check whether trigger point has been reached.
+            if (currentTrigger.HasValue && !_plotFullHistory)
+            {
+                trigger = currentTrigger;
+                long triggerX = TriggerX(columns, currentTrigger.Value);
 
-                // Check whether trigger point has been reached.
-                // If it has, set candidate to 0 such that all historical points are included.
-                if (currentTriggerIndex.HasValue && !_plotFullHistory)
+                // Single trigger: include all historical points (fromX stays unbounded).
+                // Normal trigger: plot from a couple of windows (or the pre-trigger samples)
+                // before the trigger until the newest data.
+                if (triggerMode == TriggerMode.Normal_Trigger)
+                    fromX = Math.Min(triggerX - 2 * width,
+                        TriggerNeighbourX(columns, currentTrigger.Value, -PreTriggerSamples));
+            }
+            else if (!_plotFullHistory)
+            {
+                // Check if a last trigger exists, normal trigger is enabled:
+                if (lastTrigger.HasValue && triggerMode == TriggerMode.Normal_Trigger &&
+                    IsRetained(columns, lastTrigger.Value))
                 {
-                    switch (triggerMode)
-                    {
-                        case TriggerMode.Single_Trigger:
-                            localTriggerIndex = currentTriggerIndex.Value;
-                            candidate = 0;
-                            break;
-
-                        case TriggerMode.Normal_Trigger:
-                            // Ensure candidate is always >= 0. _uniqueVars+3 for extra variable headroom.
-                            candidate = !dupesExist 
-                                ? Math.Max(currentTriggerIndex.Value - ((int)_windowWidth * (_uniqueVars * 2)), 0) 
-                                : Math.Max(currentTriggerIndex.Value - ((int)_windowWidth * (_uniqueVars * 8)), 0);
-                            // Since trigger occured and we do not use full array,
-                            // adjust trigger index relative to the subarray we provide.
-                            localTriggerIndex = currentTriggerIndex.Value - candidate;
-                            break;
-                    }
-
-                    // Set range to from candidate until end of full data array
-                    startIndex = candidate - (candidate % _uniqueVars);
-                    endIndex = totalPoints;
+                    // Keep showing the most recent trigger, limited to a couple of windows
+                    // around it to stay performant while no new trigger occurs.
+                    trigger = lastTrigger;
+                    long triggerX = TriggerX(columns, lastTrigger.Value);
+                    fromX = Math.Min(triggerX - 2 * width,
+                        TriggerNeighbourX(columns, lastTrigger.Value, -PreTriggerSamples));
+                    toX = Math.Max(triggerX + 2 * width,
+                        TriggerNeighbourX(columns, lastTrigger.Value, PostTriggerSamples));
                 }
-                else if (!_plotFullHistory)
+                else if (!snapshot.IsEmpty) // Fallback for no trigger & no history mode
                 {
-                    // Check if a last trigger exists, normal trigger is enabled:
-                    if (lastTriggerIndex.HasValue && triggerMode == TriggerMode.Normal_Trigger)
-                    {
-                        // Set candidate to the most recent trigger, such that the subarray x/yDataDouble
-                        // will be the most recent trigger and forward. _uniqueVars+3 for extra variable headroom.
-                        candidate = !dupesExist 
-                            ? Math.Max(lastTriggerIndex.Value - ((int)_windowWidth * (_uniqueVars * 2)), 0) 
-                            : Math.Max(lastTriggerIndex.Value - ((int)_windowWidth * (_uniqueVars * 8)), 0);
-                        // set triggerindex relative to the subarray from the last trigger.
-                        localTriggerIndex = lastTriggerIndex.Value - candidate;
-
-                        // Limit number of points when no new trigger occurs to stay performant
-                        startIndex = candidate - (candidate % _uniqueVars);
-                        
-                        // Limit the size of the plotted slice to a smaller window for performance
-                        int maxPointsToPlot;
-                        if (!dupesExist)
-                            maxPointsToPlot = 2 * (int)_windowWidth * (_uniqueVars * 2);
-                        else
-                            maxPointsToPlot = 2 * (int)_windowWidth * (_uniqueVars * 8);
-                        endIndex = Math.Min(startIndex + maxPointsToPlot, totalPoints);
-                        endIndex -= endIndex % _uniqueVars; // Align to variable interleaving.
-                    }
-                    else // Fallback for no trigger & no history mode
-                    {
-                        startIndex = candidate - (candidate % _uniqueVars);
-                        endIndex = totalPoints;
-                    }
+                    // Follow the newest data with a sliding window.
+                    fromX = NewestX(columns) - width;
                 }
-                else
+            }
+            else
+            {
+                // Full history mode, every retained point is included,
+                // unless the user has panned or zoomed to a part of it.
+                if (_historyView.HasValue)
                 {
-                    // Full history mode, ensure indexes are set.
-                    startIndex = candidate - (candidate % _uniqueVars);
-                    endIndex = totalPoints;
-
-                    // if no new trigger but _lastTriggerIndex is set,
-                    // update triggerIndex to be _lastTriggerIndex.
-                    if (!currentTriggerIndex.HasValue && lastTriggerIndex.HasValue && 
-                        triggerMode == TriggerMode.Normal_Trigger)
-                    {
-                        // Subtraction by candidate (0) in full-history mode
-                        localTriggerIndex = lastTriggerIndex.Value;
-                    }
+                    fromX = ClampToTimestamp(Math.Floor(_historyView.Value.Min * ticksPerSecond));
+                    toX = ClampToTimestamp(Math.Ceiling(_historyView.Value.Max * ticksPerSecond));
                 }
-                
-                int count = endIndex - startIndex;
 
-                if (_xBuffer.Length != count)
+                // If no new trigger but a last trigger is set, keep marking it.
+                if (!currentTrigger.HasValue && lastTrigger.HasValue &&
+                    triggerMode == TriggerMode.Normal_Trigger)
                 {
-                    _xBuffer = new double[count];
-                    _yBuffer = new double[count];
+                    trigger = lastTrigger;
                 }
+            }
 
-                for (int i = 0; i < count; i++)
-                {
-                    _xBuffer[i] = _graphData.XData[startIndex + i];
-                    _yBuffer[i] = _graphData.YData[startIndex + i];
-                }
+            EnsureSeriesCount(columns.Count);
 
-                xDataDouble = _xBuffer;
-                yDataDouble = _yBuffer;
+            for (int v = 0; v < columns.Count; v++)
+            {
+                ColumnSnapshot column = columns[v];
 
-                // Fallback in case index is out of the arroy
-                if (localTriggerIndex < 0 || localTriggerIndex >= xDataDouble.Length)
-                    localTriggerIndex = -1;
+                // Samples of the time range are found through the column's time index, in O(log n).
+                // Include one point before the range so the line enters from the left edge.
+                long startIndex = fromX.HasValue
+                    ? Math.Max(column.LowerBound(fromX.Value) - 1, column.FirstIndex)
+                    : column.FirstIndex;
+                // Likewise one point after it, so the line leaves through the right edge.
+                long endIndex = toX.HasValue
+                    ? Math.Min(column.UpperBound(toX.Value) + 1, column.EndIndex)
+                    : column.EndIndex;
+
+                // Adjust trigger index relative to the subarray we provide.
+                if (trigger.HasValue && trigger.Value.Variable == v)
+                    localTriggerIndex = FillSeries(_series[v], column, startIndex, endIndex, trigger.Value.SampleIndex);
+                else
+                    FillSeries(_series[v], column, startIndex, endIndex, -1);
+
+                // Plot in seconds, so the X-axis reads the same whatever the data source's timebase.
+                ScaleToSeconds(_series[v], ticksPerSecond);
             }
+
+            series = _series;
+            PipelineMetrics.RecordSince(PipelineMetrics.ExtractDuration, start);
         }
 
+        // --- Private helpers (reading a snapshot of the graph data) --- //
+        private static bool IsRetained(IReadOnlyList<ColumnSnapshot> columns, TriggerPoint trigger)
+        {
+            if (trigger.Variable >= columns.Count) return false;
+            ColumnSnapshot column = columns[trigger.Variable];
+            return trigger.SampleIndex >= column.FirstIndex && trigger.SampleIndex < column.EndIndex;
+        }
+
+        private static long TriggerX(IReadOnlyList<ColumnSnapshot> columns, TriggerPoint trigger)
+        {
+            // Fall back to the newest data if the trigger sample has been dropped by retention.
+            return IsRetained(columns, trigger)
+                ? columns[trigger.Variable].GetX(trigger.SampleIndex)
+                : NewestX(columns);
+        }
+
+        // X value of the sample the given number of samples away from a trigger, clamped to the retained samples.
+        private static long TriggerNeighbourX(IReadOnlyList<ColumnSnapshot> columns, TriggerPoint trigger, long offset)
+        {
+            if (!IsRetained(columns, trigger)) return TriggerX(columns, trigger);
+            ColumnSnapshot column = columns[trigger.Variable];
+            return column.GetX(Math.Clamp(trigger.SampleIndex + offset, column.FirstIndex, column.EndIndex - 1));
+        }
+
+        private static long NewestX(IReadOnlyList<ColumnSnapshot> columns)
+        {
+            long newest = 0;
+            for (int v = 0; v < columns.Count; v++)
+            {
+                ColumnSnapshot column = columns[v];
+                if (column.Count > 0 && column.LastX > newest)
+                    newest = column.LastX;
+            }
+            return newest;
+        }
+
+        // Copies [start, end) of a column into the variable's series. Ranges holding more than two
+        // samples per pixel are min/max decimated down to between one and two points per pixel,
+        // so the cost of plotting depends on the plot's width rather than the capture's length.
+        // The trigger sample and the one before it are always kept exactly, returns the
+        // trigger's index in the series or -1 if it is outside the range.
+        private int FillSeries(PlotSeries series, ColumnSnapshot column, long start, long end, long triggerIndex)
+        {
+            long count = Math.Max(end - start, 0);
+            bool hasTrigger = triggerIndex >= start && triggerIndex < end;
+
+            if (count <= 2L * _pixelWidth)
+            {
+                series.SetCount((int)count);
+                column.CopyTo(start, series.Xs.AsSpan(0, series.Count), series.Ys.AsSpan(0, series.Count));
+                return hasTrigger ? (int)(triggerIndex - start) : -1;
+            }
+
+            // Group size is rounded up to a power of two, keeping the groups stable while panning.
+            long groupSize = (long)BitOperations.RoundUpToPowerOf2((ulong)((count + _pixelWidth - 1) / _pixelWidth));
+            series.EnsureCapacity((int)(2 * (count / groupSize + 4) + 2));
+            Span<double> xs = series.Xs;
+            Span<double> ys = series.Ys;
+
+            int written;
+            int localTrigger = -1;
+            if (hasTrigger)
+            {
+                long exactStart = Math.Max(triggerIndex - 1, start);
+                int exactCount = (int)(triggerIndex + 1 - exactStart);
+
+                written = column.CopyDecimatedTo(start, exactStart, groupSize, xs, ys);
+                column.CopyTo(exactStart, xs.Slice(written, exactCount), ys.Slice(written, exactCount));
+                localTrigger = written + exactCount - 1;
+                written += exactCount;
+                written += column.CopyDecimatedTo(triggerIndex + 1, end, groupSize, xs[written..], ys[written..]);
+            }
+            else
+            {
+                written = column.CopyDecimatedTo(start, end, groupSize, xs, ys);
+            }
+
+            series.SetCount(written);
+            return localTrigger;
+        }
+
+        // Saturates well within the range of a long, so that windows can still be added to and subtracted from it.
+        private static long ClampToTimestamp(double value)
+        {
+            const long limit = long.MaxValue / 8;
+            return double.IsNaN(value) ? 0 : (long)Math.Clamp(value, -limit, limit);
+        }
+
+        private static void ScaleToSeconds(PlotSeries series, double ticksPerSecond)
+        {
+            double secondsPerTick = 1 / ticksPerSecond;
+            Span<double> xs = series.Xs.AsSpan(0, series.Count);
+            for (int i = 0; i < xs.Length; i++)
+                xs[i] *= secondsPerTick;
+        }
+
+        private void EnsureSeriesCount(int variables)
+        {
+            if (_series.Length == variables) return;
+            _series = new PlotSeries[variables];
+            for (int v = 0; v < variables; v++)
+                _series[v] = new PlotSeries();
+        }
     }
-}
+}
\ No newline at end of file
@@ -1,4 +1,5 @@
-﻿using RealtimePlottingApp.Models;
+﻿using System.Collections.Generic;
+using RealtimePlottingApp.Models;
 
 namespace RealtimePlottingApp.Services.Plotting.LineGraph;
 
@@ -15,15 +16,34 @@ public interface IGraphDataService
     GraphDataModel GraphData { get; }
 
     /// <summary>
-    /// The number of interleaved variables in the graph data arrays.
+    /// The number of variables stored in the graph data.
+    /// Setting it reconfigures the underlying data model, clearing its data.
     /// </summary>
     int UniqueVars { get; set; }
 
     /// <summary>
-    /// Width for the X-axis, for dynamic scaling of the view window
+    /// Width for the X-axis in seconds, for dynamic scaling of the view window.
+    /// Converted to the data source's ticks with GraphData.TicksPerSecond, so the window
+    /// covers the same time when the sample rate changes or variables arrive at different rates.
     /// </summary>
     double WindowWidth { get; set; }
 
+    /// <summary>
+    /// Width of the plot area in pixels. Ranges holding more than two samples per pixel
+    /// are min/max decimated, keeping the peaks, to bound the points produced per variable.
+    /// </summary>
+    int PixelWidth { get; set; }
+
+    /// <summary>
+    /// Minimum number of samples before a trigger to include when plotting around it.
+    /// </summary>
+    int PreTriggerSamples { get; set; }
+
+    /// <summary>
+    /// Minimum number of samples after a trigger to include when plotting around it.
+    /// </summary>
+    int PostTriggerSamples { get; set; }
+
     /// <summary>
     /// Flag indicating whether the entire data history should show.
     /// True once SetFullHistory() has been set true.
@@ -42,10 +62,19 @@ public interface IGraphDataService
     void SetFullHistory(bool fullHistory);
 
     /// <summary>
-    /// Produces X/Y sub-arrays to hand off to the plot‑UI.
-    /// Additionally provides a local trigger index representing the index in the
-    /// subarray for which a trigger has occurred (or -1 if no trigger found)
+    /// Limits full-history mode to the X range currently visible (in seconds), such as after
+    /// the user pans or zooms. Reset to the entire history by SetFullHistory().
+    /// </summary>
+    void SetHistoryView(double minX, double maxX);
+
+    /// <summary>
+    /// Produces an X/Y series for each variable (indexed by variable number) to hand off to the plot‑UI,
+    /// with X values in seconds.
+    /// The series are reused and overwritten by the next call, so they should be plotted on the same
+    /// thread as this is called on (the UI thread), to never be changed while being rendered.
+    /// Additionally provides a local trigger index representing the index in the triggering
+    /// variable's series for which a trigger has occurred (or -1 if no trigger found)
     /// </summary>
-    void GetSubData(out double[] xDataDouble, out double[] yDataDouble, out int localTriggerIndex,
-        int? currentTriggerIndex, int? lastTriggerIndex, TriggerMode triggerMode);
+    void GetSubData(out IReadOnlyList<PlotSeries> series, out int localTriggerIndex,
+        TriggerPoint? currentTrigger, TriggerPoint? lastTrigger, TriggerMode triggerMode);
 }
\ No newline at end of file
@@ -1,5 +1,9 @@
-﻿using System.Collections.ObjectModel;
+﻿using System;
+using System.Collections.Generic;
+using System.Collections.ObjectModel;
 using RealtimePlottingApp.Models;
+using RealtimePlottingApp.Services.Statistics;
+using ScottPlot;
 using ScottPlot.Avalonia;
 using ScottPlot.Plottables;
 
@@ -27,7 +31,7 @@ public interface IPlotUiService
     bool PlotFullHistory { get; set; }
 
     /// <summary>
-    /// X-Axis width when not in history mode.
+    /// X-Axis width in seconds when not in history mode.
     /// </summary>
     double WindowWidth { get; set; }
     
@@ -42,20 +46,39 @@ public interface IPlotUiService
     bool LockTriggerLevel { get; set; }
 
     /// <summary>
-    /// Redraws the entire graph (signals + trigger marker (if one exists) + legend).
+    /// Width of the plot's data area in pixels, as of the last render.
     /// </summary>
-    void UpdateGraphUI(double[] xDataDouble, double[] yDataDouble, 
-        int triggerIndex, int globalTriggerIndex);
+    int PixelWidth { get; }
+
+    /// <summary>
+    /// Raised in history mode when the axis limits change, e.g. by the user panning or zooming,
+    /// such that the data for the newly visible range can be provided.
+    /// </summary>
+    event EventHandler<AxisLimits>? HistoryViewChanged;
+
+    /// <summary>
+    /// Raised whenever the plot has been rendered, with the time the render took.
+    /// May be raised on the render thread.
+    /// </summary>
+    event EventHandler<TimeSpan>? Rendered;
+
+    /// <summary>
+    /// Updates the graph (signals + trigger marker (if one exists) + legend) and requests a render.
+    /// Each variable keeps one signal plotting its series' arrays, which is only recreated when the
+    /// arrays are replaced. The series are indexed by variable number, and the trigger index is
+    /// local to the triggering variable's series. Must be called on the UI thread.
+    /// </summary>
+    void UpdateGraphUI(IReadOnlyList<PlotSeries> series, int triggerIndex, int triggerVariable);
 
     /// <summary>
     /// Adjusts axis limits or autoscale depending on history mode, such that
     /// the view updates to show the relevant data at a given time.
     /// </summary>
-    void AdjustGraphView(double[] xDataDouble, int triggerIndex);
+    void AdjustGraphView(IReadOnlyList<PlotSeries> series, int triggerIndex, int triggerVariable);
 
     /// <summary>
     /// Adds, moves or removes the draggable trigger line.
     /// </summary>
-    void SetTriggerLevel(GraphDataModel graphData, bool placeTriggerAbove, 
+    void SetTriggerLevel(IStatisticsService statistics, bool placeTriggerAbove, 
         double offset, string startText, bool isEnabled);
 }
\ No newline at end of file
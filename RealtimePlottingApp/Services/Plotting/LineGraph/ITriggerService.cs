@@ -2,7 +2,6 @@
 using RealtimePlottingApp.Models;
 using RealtimePlottingApp.Services.DataChannels;
 using ScottPlot.Plottables;
-using Timer = System.Timers.Timer;
 
 namespace RealtimePlottingApp.Services.Plotting.LineGraph;
 
@@ -12,9 +11,9 @@ namespace RealtimePlottingApp.Services.Plotting.LineGraph;
 public interface ITriggerService
 {
     /// <summary>
-    /// The last global index at which a trigger occurred (or –1 if none has occurred).
+    /// The sample at which the last trigger occurred (or null if none has occurred).
     /// </summary>
-    int LastTriggerIndex { get; }
+    TriggerPoint? LastTrigger { get; }
 
     /// <summary>
     /// True once a single‑trigger has fired and entered "the trigger view".
@@ -26,16 +25,38 @@ public interface ITriggerService
     /// </summary>
     TriggerMode Mode { get; set; }
 
+    /// <summary>
+    /// Which crossings of the trigger level cause a trigger (rising, falling or either).
+    /// </summary>
+    TriggerEdge Edge { get; set; }
+
+    /// <summary>
+    /// How far past the trigger level the signal must first go, in the opposite direction
+    /// of the edge, before the edge can trigger. Prevents noise from causing repeated triggers.
+    /// </summary>
+    double Hysteresis { get; set; }
+
+    /// <summary>
+    /// Number of samples which must be captured after arming before a trigger may occur.
+    /// </summary>
+    int PreTriggerSamples { get; set; }
+
+    /// <summary>
+    /// Number of samples captured after a trigger before a single trigger stops the capture,
+    /// or a normal trigger re-arms.
+    /// </summary>
+    int PostTriggerSamples { get; set; }
+
     /// <summary>
     /// Called when the user enables/disables the trigger checkbox.
-    /// Initializes the start index.
+    /// Only samples added from here on can cause a trigger.
     /// </summary>
-    void EnableTrigger(int currentDataCount);
+    void EnableTrigger();
 
     /// <summary>
     /// Called when the trigger line is manually moved by dragging.
     /// </summary>
-    void OnTriggerMoved(int currentDataCount);
+    void OnTriggerMoved();
 
     /// <summary>
     /// Resets all internal trigger states.
@@ -43,14 +64,14 @@ public interface ITriggerService
     void ResetTrigger();
 
     /// <summary>
-    /// Checks for a rising‑edge trigger. Returns the global index for it or –1 if not found.
+    /// Updates the trigger level and triggerable variables used for detection, which happens as
+    /// samples are ingested. Returns the sample that fired a trigger since the last call, or null if none.
     /// </summary>
-    int CheckForTrigger(
-        GraphDataModel graphData, ObservableCollection<IVariableModel>? plotConfigVariables,
-        int uniqueVars, HorizontalLine? triggerLevel);
+    TriggerPoint? CheckForTrigger(
+        ObservableCollection<IVariableModel>? plotConfigVariables, HorizontalLine? triggerLevel);
 
     /// <summary>
     /// Executes the trigger behavior.
     /// </summary>
-    void HandleTrigger(IDataChannel? dataChannel, Timer timer, GraphDataModel graphData);
+    void HandleTrigger(IDataChannel? dataChannel, IRenderScheduler renderScheduler);
 }
\ No newline at end of file
@@ -1,7 +1,10 @@
-﻿using System.Collections.ObjectModel;
-using System.Linq;
-using Avalonia.Threading;
+﻿using System;
+using System.Collections.Generic;
+using System.Collections.ObjectModel;
+using System.Diagnostics;
 using RealtimePlottingApp.Models;
+using RealtimePlottingApp.Services.Diagnostics;
+using RealtimePlottingApp.Services.Statistics;
 using ScottPlot;
 using ScottPlot.Avalonia;
 using ScottPlot.Plottables;
@@ -16,6 +19,14 @@ public class PlotUiService : IPlotUiService
 
     private AvaPlot? _linePlot;
 
+    // History mode autoscales once when entered, after that the user's pan & zoom is kept.
+    private bool _plotFullHistory;
+    private bool _historyAutoScaled;
+
+    // One long-lived signal per variable, with the X array it currently plots (to notice when it was replaced).
+    private readonly List<SignalXY> _signals = [];
+    private readonly List<double[]> _signalXs = [];
+
     // Palette for predictable & consistent color assignment regardless of Trigger lines, etc.
     // Uses a 25-color palette adapted from Tsitsulin's 12-color xgfs palette
     // Aims to help distinguishing the colors for people with color vision deficiency and when printed B&W.
@@ -28,19 +39,37 @@ public class PlotUiService : IPlotUiService
         get => _linePlot;
         set
         {
+            if (_linePlot != null)
+            {
+                _linePlot.Plot.RenderManager.AxisLimitsChanged -= OnAxisLimitsChanged;
+                _linePlot.Plot.RenderManager.RenderFinished -= OnRenderFinished;
+            }
+            _signals.Clear(); // Signals belong to the previous plot.
+            _signalXs.Clear();
             _linePlot = value;
-            _linePlot?.Plot.XLabel("Timestamp");
+            _linePlot?.Plot.XLabel("Time (s)");
             _linePlot?.Plot.YLabel("Value");
             
             if (_linePlot == null) return;
             _linePlot.Plot.Title("Line Graph");
             _linePlot.Plot.Axes.Bottom.Label.Bold = false;
             _linePlot.Plot.Axes.Left.Label.Bold = false;
+            _linePlot.Plot.RenderManager.AxisLimitsChanged += OnAxisLimitsChanged;
+            _linePlot.Plot.RenderManager.RenderFinished += OnRenderFinished;
         }
     }
     public ObservableCollection<IVariableModel>? PlotConfigVariables { get; set; }
-    public bool PlotFullHistory { get; set; }
-    public double WindowWidth { get; set; } = 75;
+    public bool PlotFullHistory
+    {
+        get => _plotFullHistory;
+        set
+        {
+            if (value != _plotFullHistory)
+                _historyAutoScaled = false;
+            _plotFullHistory = value;
+        }
+    }
+    public double WindowWidth { get; set; } = 5;
     public bool LockTriggerLevel { get; set; } = false;
 
     public HorizontalLine? TriggerLevel
@@ -48,148 +77,200 @@ public class PlotUiService : IPlotUiService
         get => _triggerLevel;
     }
 
-    public void UpdateGraphUI(double[] xDataDouble, double[] yDataDouble, 
-        int triggerIndex, int globalTriggerIndex)
+    public int PixelWidth
     {
-        // Update UI asynchronously on Avalonia's UI Thread
-        Dispatcher.UIThread.InvokeAsync(() =>
+        get
         {
-            if (LinePlot == null) return;
-            
-            // Check if trigger should toggle between locked/unlocked
-            if (_triggerLevel != null)
-                _triggerLevel.IsDraggable = !LockTriggerLevel;
-            
-            LinePlot.Plot.Clear<SignalXY>();
-            LinePlot.Plot.Clear<Scatter>();
+            // Fall back to a typical width until the plot has been rendered once.
+            int width = (int)(LinePlot?.Plot.RenderManager.LastRender.DataRect.Width ?? 0);
+            return width > 0 ? width : 1000;
+        }
+    }
 
-            // Loop over each variable and extract its data.
-            for (int v = 0; v < (PlotConfigVariables?.Count ?? 1); v++)
-            {
-                // Use LINQ's index-aware overload of the Where method to filter data by % operations on index.
-                double[] xVar = xDataDouble.Where((_, idx) => idx % (PlotConfigVariables?.Count ?? 1) == v).ToArray();
-                double[] yVar = yDataDouble.Where((_, idx) => idx % (PlotConfigVariables?.Count ?? 1) == v).ToArray();
+    public event EventHandler<AxisLimits>? HistoryViewChanged;
+    public event EventHandler<TimeSpan>? Rendered;
 
-                if (xVar.Length <= 0) continue;
+    public void UpdateGraphUI(IReadOnlyList<PlotSeries> series, int triggerIndex, int triggerVariable)
+    {
+        if (LinePlot == null) return;
+        long start = Stopwatch.GetTimestamp();
+
+        // Check if trigger should toggle between locked/unlocked
+        if (_triggerLevel != null)
+            _triggerLevel.IsDraggable = !LockTriggerLevel;
 
-                // SignalXY Preconditions, which when met allows for greater performance than ScatterLine Plotting:
-                // "New data points must have an X value that is greater to or equal to the previous one."
-                SignalXY signal = LinePlot.Plot.Add.SignalXY(xVar, yVar);
-                signal.LegendText = PlotConfigVariables?.Count > v
-                    ? PlotConfigVariables[v].Name : $"Var {v+1}"; // Fallback
-                signal.Color = _palette.GetColor(v % _palette.Colors.Length); // Each var nr. has a preset color.
+        LinePlot.Plot.Clear<Scatter>();
+        RemoveSignals(series.Count); // Drop signals of variables which no longer exist.
+
+        // Loop over each variable, updating its long-lived signal in place.
+        for (int v = 0; v < series.Count; v++)
+        {
+            PlotSeries data = series[v];
+            SignalXY signal = GetOrAddSignal(v, data);
 
-                // Do not plot the variable if visibility is unchecked by the user in the UI
-                if (PlotConfigVariables?.Count > v && !PlotConfigVariables[v].IsChecked)
-                    signal.IsVisible = false;
+            // Only the first Count values of the reused arrays are valid this frame.
+            signal.IsVisible = data.Count > 0 &&
+                               !(PlotConfigVariables?.Count > v && !PlotConfigVariables[v].IsChecked);
+            signal.Data.MinimumIndex = 0;
+            signal.Data.MaximumIndex = Math.Max(data.Count - 1, 0);
+            signal.LegendText = PlotConfigVariables?.Count > v
+                ? PlotConfigVariables[v].Name : $"Var {v+1}"; // Fallback
 
-                // If a triggerIndex is plotted, mark it such that the user can see which point triggered.
-                if (triggerIndex >= 0 && globalTriggerIndex % (PlotConfigVariables?.Count ?? 1) == v)
+            // If a triggerIndex is plotted, mark it such that the user can see which point triggered.
+            if (triggerIndex >= 0 && triggerVariable == v)
+            {
+                int localIndex = triggerIndex;
+
+                if (localIndex > 0 && localIndex < data.Count)
                 {
-                    // (Local Index for aligning index to interleaved arrays)
-                    int localIndex = (PlotConfigVariables == null || PlotConfigVariables.Count == 1)
-                        ? triggerIndex
-                        : triggerIndex / PlotConfigVariables.Count;
+                    // Triggered point
+                    double triggerX = data.Xs[localIndex];
+                    double triggerY = data.Ys[localIndex];
+
+                    // Point before trigger (for calculating (x,y) interpolations)
+                    double xBefore = data.Xs[localIndex - 1];
+                    double yBefore = data.Ys[localIndex - 1];
 
-                    if (localIndex > 0 && localIndex < xVar.Length)
+                    // Check whether we can find intersection/interpolaton of the edge and triggerlevel
+                    if (_triggerLevel != null &&
+                        Math.Min(yBefore, triggerY) < _triggerLevel.Y &&
+                        Math.Max(yBefore, triggerY) > _triggerLevel.Y &&
+                        (triggerX - xBefore) != 0)
                     {
-                        // Triggered point
-                        double triggerX = xVar[localIndex];
-                        double triggerY = yVar[localIndex];
-
-                        // Point before trigger (for calculating (x,y) interpolations)
-                        double xBefore = xVar[localIndex - 1];
-                        double yBefore = yVar[localIndex - 1];
-
-                        // Check whether we can find intersection/interpolaton of rising edge and triggerlevel
-                        if (_triggerLevel != null &&
-                            _triggerLevel.Y > yBefore &&
-                            _triggerLevel.Y < triggerY &&
-                            (triggerX - xBefore) != 0)
-                        {
-                            // Find intersection of triggerLevel and the line between trigger point and prev. point.
-                            double slope = (triggerY - yBefore) / (triggerX - xBefore);
-                            double intersectionX = triggerX + (_triggerLevel.Y - triggerY) / slope;
-
-                            // Place trigger point marker on the rising edge where the triggerLevel was passed
-                            // for better visual representation.
-                            var marker = LinePlot.Plot.Add.Scatter(intersectionX, _triggerLevel.Y, Colors.Black);
-                            marker.MarkerShape = MarkerShape.FilledDiamond;
-                            marker.MarkerSize = 6;
-                        }
-                        else // Fallback
-                        {
-                            // Add the marker at the trigger point
-                            var marker = LinePlot.Plot.Add.Scatter(triggerX, triggerY, color: Colors.Black);
-                            marker.MarkerShape = MarkerShape.FilledDiamond;
-                            marker.MarkerSize = 6;
-                        }
+                        // Find intersection of triggerLevel and the line between trigger point and prev. point.
+                        double slope = (triggerY - yBefore) / (triggerX - xBefore);
+                        double intersectionX = triggerX + (_triggerLevel.Y - triggerY) / slope;
+
+                        // Place trigger point marker on the edge where the triggerLevel was passed
+                        // for better visual representation.
+                        var marker = LinePlot.Plot.Add.Scatter(intersectionX, _triggerLevel.Y, Colors.Black);
+                        marker.MarkerShape = MarkerShape.FilledDiamond;
+                        marker.MarkerSize = 6;
+                    }
+                    else // Fallback
+                    {
+                        // Add the marker at the trigger point
+                        var marker = LinePlot.Plot.Add.Scatter(triggerX, triggerY, color: Colors.Black);
+                        marker.MarkerShape = MarkerShape.FilledDiamond;
+                        marker.MarkerSize = 6;
                     }
                 }
             }
+        }
 
-            // Call helper to adjust the graph view for the new data (or trigger points)
-            AdjustGraphView(xDataDouble, triggerIndex);
+        // Call helper to adjust the graph view for the new data (or trigger points)
+        AdjustGraphView(series, triggerIndex, triggerVariable);
 
-            // Add legend so each variable is identifiable.
-            LinePlot.Plot.ShowLegend();
-            LinePlot.Refresh();
-        });
+        // Add legend so each variable is identifiable.
+        LinePlot.Plot.ShowLegend();
+        LinePlot.Refresh();
+        PipelineMetrics.RecordSince(PipelineMetrics.UpdateDuration, start);
     }
 
-    public void AdjustGraphView(double[] xDataDouble, int triggerIndex)
+    public void AdjustGraphView(IReadOnlyList<PlotSeries> series, int triggerIndex, int triggerVariable)
     {
-        if (!PlotFullHistory && xDataDouble.Length > 0)
+        // Find the newest timestamp across all variables.
+        double? lastX = null;
+        foreach (PlotSeries data in series)
         {
-            if (triggerIndex >= 0 && triggerIndex < xDataDouble.Length)
+            if (data.Count > 0 && (lastX == null || data.Xs[data.Count - 1] > lastX))
+                lastX = data.Xs[data.Count - 1];
+        }
+        
+        if (!PlotFullHistory && lastX.HasValue)
+        {
+            if (triggerVariable >= 0 && triggerVariable < series.Count &&
+                triggerIndex >= 0 && triggerIndex < series[triggerVariable].Count)
             {
                 // Center the plot around trigger point
-                double triggerX = xDataDouble[triggerIndex];
+                double triggerX = series[triggerVariable].Xs[triggerIndex];
                 LinePlot?.Plot.Axes.SetLimitsX(triggerX - WindowWidth / 2, triggerX + WindowWidth / 2);
             }
             else
             {
                 // Make X-Axis limit & "follow" the plotting while not in "history mode"
-                double lastX = xDataDouble.Last();
-                LinePlot?.Plot.Axes.SetLimitsX(lastX - WindowWidth, lastX);
+                LinePlot?.Plot.Axes.SetLimitsX(lastX.Value - WindowWidth, lastX.Value);
             }
         }
-        else
+        else if (!_historyAutoScaled)
         {
             // History mode entered, don't set limits and autoscale the plot.
+            // The data is decimated to the plot's width, so this no longer scales with the capture length.
             LinePlot?.Plot.Axes.AutoScale();
+            _historyAutoScaled = true;
         }
     }
 
-    public void SetTriggerLevel(GraphDataModel graphData, bool placeTriggerAbove, 
+    // Returns the variable's signal, (re)creating it only if it doesn't exist yet or the series' arrays grew.
+    private SignalXY GetOrAddSignal(int variable, PlotSeries data)
+    {
+        if (variable < _signals.Count && ReferenceEquals(_signalXs[variable], data.Xs))
+            return _signals[variable];
+
+        // SignalXY Preconditions, which when met allows for greater performance than ScatterLine Plotting:
+        // "New data points must have an X value that is greater to or equal to the previous one."
+        SignalXY signal = LinePlot!.Plot.Add.SignalXY(data.Xs, data.Ys);
+        signal.Color = _palette.GetColor(variable % _palette.Colors.Length); // Each var nr. has a preset color.
+
+        if (variable < _signals.Count)
+        {
+            LinePlot.Plot.Remove(_signals[variable]);
+            _signals[variable] = signal;
+            _signalXs[variable] = data.Xs;
+        }
+        else
+        {
+            _signals.Add(signal);
+            _signalXs.Add(data.Xs);
+        }
+        return signal;
+    }
+
+    private void RemoveSignals(int keep)
+    {
+        while (_signals.Count > keep)
+        {
+            LinePlot?.Plot.Remove(_signals[^1]);
+            _signals.RemoveAt(_signals.Count - 1);
+            _signalXs.RemoveAt(_signalXs.Count - 1);
+        }
+    }
+
+    private void OnAxisLimitsChanged(object? sender, RenderDetails details)
+    {
+        // Only history mode is navigated by the user, otherwise the view follows the data.
+        if (!PlotFullHistory || !_historyAutoScaled) return;
+        HistoryViewChanged?.Invoke(this, details.AxisLimits);
+    }
+
+    private void OnRenderFinished(object? sender, RenderDetails details)
+    {
+        Rendered?.Invoke(this, details.Elapsed);
+    }
+
+    public void SetTriggerLevel(IStatisticsService statistics, bool placeTriggerAbove, 
         double offset, string startText, bool isEnabled)
     {
-        // If graphData.YData is empty, we set the trigger level to a default value
+        // If there is no data, we set the trigger level to a default value
         // otherwise we place it depending on the max & minimum values, to reduce
-        // risk of accidental "instant trigger"
+        // risk of accidental "instant trigger". The running statistics make this constant time.
         double triggerPosition;
+        bool hasData = statistics.TryGetRange(out double minY, out double maxY);
 
-        if (graphData.YData.Count == 0)
+        if (!hasData)
         {
             // Place it at 10 if placing above or at -10 if placing below
             triggerPosition = placeTriggerAbove ? 10 : -10;
         }
+        else if (placeTriggerAbove)
+        {
+            // Set the trigger level slightly above the maximum Y value in the data
+            triggerPosition = maxY + offset;
+        }
         else
         {
-            // Calculate the trigger level position based on the input parameters
-            lock (graphData)
-            {
-                if (placeTriggerAbove)
-                {
-                    // Set the trigger level slightly above the maximum Y value in the data
-                    triggerPosition = graphData.YData.Max() + offset;
-                }
-                else
-                {
-                    // Set the trigger level slightly below the minimum Y value in the data
-                    triggerPosition = graphData.YData.Min() - offset;
-                }
-            }
+            // Set the trigger level slightly below the minimum Y value in the data
+            triggerPosition = minY - offset;
         }
 
         // Set the trigger level only if it's enabled
@@ -0,0 +1,204 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Numerics;
+using System.Runtime.InteropServices;
+using RealtimePlottingApp.Models;
+
+namespace RealtimePlottingApp.Services.Plotting.LineGraph;
+
+/// <summary>
+/// Incremental edge detector for the trigger level. Keeps a scan cursor per variable, so every
+/// sample is only looked at once, and jumps over samples that cannot change the trigger state
+/// using SIMD comparisons of whole vectors of samples.
+///
+/// Hysteresis works like a Schmitt trigger: a rising edge is only armed once a sample is below
+/// (level - hysteresis), and fires on the first sample above the level after that. Falling edges
+/// are mirrored. Noise around the level can therefore not cause repeated triggers.
+/// Not threadsafe by itself, callers are expected to serialize access to it.
+/// Scanning reads the samples as written, so it must be done by the graph data's writer.
+/// </summary>
+public class TriggerEngine
+{
+    // ===== Instance Variables ===== //
+    private long[] _cursors = [];       // Per variable, the next sample index to scan
+    private long[] _earliestFire = [];  // Per variable, the first sample index allowed to fire
+    private bool[] _armedRising = [];
+    private bool[] _armedFalling = [];
+
+    // ===== Configuration ===== //
+    /// <summary>
+    /// The trigger level, or null to pause detection. While paused no samples are consumed.
+    /// </summary>
+    public double? Level { get; set; }
+
+    /// <summary>
+    /// Which crossings of the level cause a trigger.
+    /// </summary>
+    public TriggerEdge Edge { get; set; } = TriggerEdge.Rising;
+
+    /// <summary>
+    /// Distance the signal must move to the other side of the level before an edge is armed.
+    /// </summary>
+    public double Hysteresis { get; set; }
+
+    /// <summary>
+    /// Number of samples that must have arrived after re-arming before a trigger may fire,
+    /// so that the samples shown before the trigger were captured while armed.
+    /// </summary>
+    public int PreTriggerSamples { get; set; }
+
+    // ===== API Methods ===== //
+    /// <summary>
+    /// Re-arms the engine to only look at samples committed from now on. Can be called from any thread.
+    /// </summary>
+    public void Rearm(GraphDataModel graphData)
+    {
+        IReadOnlyList<ColumnSnapshot> columns = graphData.Snapshot().Columns;
+        int count = columns.Count;
+        _cursors = new long[count];
+        _earliestFire = new long[count];
+        _armedRising = new bool[count];
+        _armedFalling = new bool[count];
+
+        for (int v = 0; v < count; v++)
+        {
+            _cursors[v] = columns[v].EndIndex;
+            _earliestFire[v] = _cursors[v] + PreTriggerSamples;
+        }
+    }
+
+    /// <summary>
+    /// Scans the samples added since the last scan for a trigger. Only to be called by the graph data's writer,
+    /// i.e. while holding its lock, such as in its SamplesCommitted handlers.
+    /// Variables are checked in order, and scanning stops at the first trigger found,
+    /// the remaining samples are scanned on the next call.
+    /// </summary>
+    /// <param name="graphData">The data to scan</param>
+    /// <param name="isTriggerable">Tells whether a variable index may cause triggers, null allows all</param>
+    /// <returns>The sample which fired the trigger, or null if none did.</returns>
+    public TriggerPoint? Scan(GraphDataModel graphData, Func<int, bool>? isTriggerable = null)
+    {
+        if (Level is not double level)
+            return null;
+
+        IReadOnlyList<SampleColumn> columns = graphData.Columns;
+        if (_cursors.Length != columns.Count)
+            Rearm(graphData); // Variable count changed, previous cursors are meaningless.
+
+        for (int v = 0; v < columns.Count; v++)
+        {
+            ColumnSnapshot column = columns[v].Current;
+            long start = Math.Max(_cursors[v], column.FirstIndex);
+            _cursors[v] = column.EndIndex;
+
+            // Samples of variables which can't trigger are skipped, but still consumed.
+            if (isTriggerable != null && !isTriggerable(v))
+                continue;
+
+            foreach (ColumnSnapshot.Segment segment in column.GetSegments(start, column.EndIndex))
+            {
+                ReadOnlySpan<uint> values = segment.Y;
+                int i = 0;
+                while (i < values.Length)
+                {
+                    // Find the next sample which arms or fires an edge, anything else is skipped.
+                    GetSearchBounds(v, level, out uint below, out uint above);
+                    int hit = IndexOfOutside(values[i..], below, above);
+                    if (hit < 0) break;
+                    i += hit;
+
+                    long index = segment.StartIndex + i;
+                    if (Process(v, level, values[i]) && index >= _earliestFire[v])
+                    {
+                        // Continue after the trigger on the next scan.
+                        _cursors[v] = index + 1;
+                        return new TriggerPoint(v, index);
+                    }
+                    i++;
+                }
+            }
+        }
+
+        return null;
+    }
+
+    // ===== Private Helpers ===== //
+    // Computes the bounds such that only samples below `below` or above `above` can change the state
+    // of the variable's edges. Anything in between is skipped by the vectorized search.
+    private void GetSearchBounds(int v, double level, out uint below, out uint above)
+    {
+        below = 0;              // Nothing is below 0, i.e. no lower bound.
+        above = uint.MaxValue;  // Nothing is above the maximum, i.e. no upper bound.
+
+        if (Edge != TriggerEdge.Falling)
+        {
+            if (!_armedRising[v]) below = Math.Max(below, BelowBound(level - Hysteresis));
+            else above = Math.Min(above, AboveBound(level));
+        }
+        if (Edge != TriggerEdge.Rising)
+        {
+            if (!_armedFalling[v]) above = Math.Min(above, AboveBound(level + Hysteresis));
+            else below = Math.Max(below, BelowBound(level));
+        }
+    }
+
+    // Updates the edge states of a variable for a sample, returns true if an edge fired.
+    private bool Process(int v, double level, uint value)
+    {
+        bool fired = false;
+        if (Edge != TriggerEdge.Falling)
+        {
+            if (value < level - Hysteresis) _armedRising[v] = true;
+            else if (_armedRising[v] && value > level)
+            {
+                _armedRising[v] = false;
+                fired = true;
+            }
+        }
+        if (Edge != TriggerEdge.Rising)
+        {
+            if (value > level + Hysteresis) _armedFalling[v] = true;
+            else if (_armedFalling[v] && value < level)
+            {
+                _armedFalling[v] = false;
+                fired = true;
+            }
+        }
+        return fired;
+    }
+
+    // For integer samples, value < x holds exactly when value < ceil(x).
+    private static uint BelowBound(double x) => (uint)Math.Clamp(Math.Ceiling(x), 0, uint.MaxValue);
+
+    // For integer samples, value > x holds exactly when value > floor(x).
+    private static uint AboveBound(double x) => (uint)Math.Clamp(Math.Floor(x), 0, uint.MaxValue);
+
+    /// <summary>
+    /// Returns the index of the first value which is less than below or greater than above, or -1.
+    /// Compares Vector&lt;uint&gt;.Count values per instruction while no match is found.
+    /// </summary>
+    public static int IndexOfOutside(ReadOnlySpan<uint> values, uint below, uint above)
+    {
+        int i = 0;
+        if (Vector.IsHardwareAccelerated && values.Length >= Vector<uint>.Count)
+        {
+            Vector<uint> low = new(below);
+            Vector<uint> high = new(above);
+            ReadOnlySpan<Vector<uint>> vectors = MemoryMarshal.Cast<uint, Vector<uint>>(values);
+
+            int v = 0;
+            while (v < vectors.Length &&
+                   Vector.EqualsAll(Vector.LessThan(vectors[v], low) | Vector.GreaterThan(vectors[v], high),
+                       Vector<uint>.Zero))
+                v++;
+            i = v * Vector<uint>.Count; // Continue scalar from the vector containing the match, or the tail.
+        }
+
+        for (; i < values.Length; i++)
+        {
+            if (values[i] < below || values[i] > above)
+                return i;
+        }
+        return -1;
+    }
+}
\ No newline at end of file
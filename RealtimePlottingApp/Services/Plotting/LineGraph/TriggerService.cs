@@ -1,23 +1,47 @@
 ﻿using System;
 using System.Collections.ObjectModel;
-using System.Linq;
 using System.Threading;
 using ReactiveUI;
 using RealtimePlottingApp.Models;
 using RealtimePlottingApp.Services.DataChannels;
 using ScottPlot.Plottables;
-using Timer = System.Timers.Timer;
 
 namespace RealtimePlottingApp.Services.Plotting.LineGraph;
 
 public class TriggerService : ITriggerService
 {
-    private int _triggerStartIndex = 0; // Represents the start index when trigger was enabled
-    private int _lastTriggerIndex = -1; // index of most recent trigger
+    // Longest time a single trigger waits for its post-trigger samples before capture is stopped anyway.
+    private const int PostTriggerTimeoutMs = 2000;
+
+    private readonly GraphDataModel _graphData;
+    private readonly TriggerEngine _engine = new(); // Guarded by itself, the graph data's lock is left to its writer
+    private readonly ManualResetEventSlim _postTriggerCaptured = new(false);
+
+    // Guarded by the engine's lock, as they are read at ingest on the data source's thread.
+    private bool[]? _triggerableVariables; // Which variables may trigger, copied from the UI's variables
+    private TriggerPoint? _detectedTrigger; // trigger found at ingest, not yet handed to the UI
+    private TriggerPoint? _capturingTrigger; // trigger still waiting for its post-trigger samples
+    private TriggerPoint? _lastTrigger; // most recent trigger, if any
     private bool _plotTriggerView = false; // true when single trigger has occurred
+    private bool _singleTriggerFired; // true once a single trigger has been detected, stops detection
     private TriggerMode _triggerMode = TriggerMode.Single_Trigger;
 
-    public int LastTriggerIndex => _lastTriggerIndex;
+    public TriggerService(GraphDataModel graphData)
+    {
+        // Detect triggers as samples are committed, rather than when the UI next updates.
+        _graphData = graphData;
+        _graphData.SamplesCommitted += OnSamplesCommitted;
+    }
+
+    public TriggerPoint? LastTrigger
+    {
+        get
+        {
+            lock (_engine)
+                return _lastTrigger;
+        }
+    }
+
     public bool PlotTriggerView => _plotTriggerView;
 
     public TriggerMode Mode
@@ -26,79 +50,108 @@ public class TriggerService : ITriggerService
         set => _triggerMode = value;
     }
 
-    public void EnableTrigger(int currentDataCount)
+    public TriggerEdge Edge
+    {
+        get => _engine.Edge;
+        set
+        {
+            lock (_engine)
+            {
+                _engine.Edge = value;
+            }
+        }
+    }
+
+    public double Hysteresis
+    {
+        get => _engine.Hysteresis;
+        set
+        {
+            lock (_engine)
+            {
+                _engine.Hysteresis = Math.Max(value, 0);
+            }
+        }
+    }
+
+    public int PreTriggerSamples
+    {
+        get => _engine.PreTriggerSamples;
+        set
+        {
+            lock (_engine)
+            {
+                _engine.PreTriggerSamples = Math.Max(value, 0);
+            }
+        }
+    }
+
+    public int PostTriggerSamples { get; set; } = 1000;
+
+    public void EnableTrigger()
     {
         // Only look for trigger occurrences from here on forward.
-        _triggerStartIndex = currentDataCount;
+        lock (_engine)
+        {
+            _engine.Rearm(_graphData);
+            _singleTriggerFired = false;
+        }
     }
 
-    public void OnTriggerMoved(int currentDataCount)
+    public void OnTriggerMoved()
     {
         // If we move the trigger point via mouse dragging,
         // we don't want values from when we enabled it to cause it to trigger.
-        if ((_triggerStartIndex == currentDataCount) || _plotTriggerView)
+        if (_plotTriggerView)
             return;
-        _triggerStartIndex = currentDataCount;
+        EnableTrigger();
     }
 
     public void ResetTrigger()
     {
-        _triggerStartIndex = 0;
-        _lastTriggerIndex = -1;
+        lock (_engine)
+        {
+            _engine.Level = null;
+            _engine.Rearm(_graphData);
+            _detectedTrigger = null;
+            _capturingTrigger = null;
+            _lastTrigger = null;
+            _singleTriggerFired = false;
+        }
         _plotTriggerView = false;
+        _postTriggerCaptured.Reset();
         MessageBus.Current.SendMessage(!_plotTriggerView, "TrigCheckboxEnabled");
     }
 
-    public int CheckForTrigger(GraphDataModel graphData, ObservableCollection<IVariableModel>? plotConfigVariables,
-        int uniqueVars, HorizontalLine? triggerLevel)
+    public TriggerPoint? CheckForTrigger(
+        ObservableCollection<IVariableModel>? plotConfigVariables, HorizontalLine? triggerLevel)
     {
-        if (triggerLevel != null)
+        lock (_engine)
         {
-            // Calculate start index to be used in loop below
-            int startIndex = Math.Max(_triggerStartIndex - uniqueVars, 0);
-
-            // Loop over each variable to check trigger for each variable individually
-            for (int v = 0; v < uniqueVars; v++)
-            {
-                // Skip checking triggers on this variable if it is not set as triggerable
-                if (plotConfigVariables != null && v < plotConfigVariables.Count && plotConfigVariables[v].IsTriggerable == false)
-                    continue;
-
-                // Loop over Y-data as IEnumberable after filtering for variable v.
+            // Keep the engine in sync with the UI, detection itself happens at ingest.
+            _engine.Level = triggerLevel?.Y;
+            CopyTriggerableVariables(plotConfigVariables);
 
-                foreach (var data in graphData.YData
-                             .Skip(startIndex)
-                             .Select((val, index) => new { GlobalIdx = startIndex + index, Value = val })
-                             .Where(x => x.GlobalIdx % uniqueVars == v))
-                {
-                    // Fetch variable before data, to compare with.
-                    uint prevValue = graphData.YData[data.GlobalIdx - uniqueVars];
-                    
-                    if (prevValue < triggerLevel.Y && data.Value > triggerLevel.Y && prevValue < data.Value)
-                    {
-                        _lastTriggerIndex = data.GlobalIdx;
-                        return _lastTriggerIndex;
-                    }
-                }
-            }
+            TriggerPoint? trigger = _detectedTrigger;
+            _detectedTrigger = null;
+            return trigger;
         }
-
-        return -1;
     }
 
-    public void HandleTrigger(IDataChannel? dataChannel, Timer timer, GraphDataModel graphData)
+    public void HandleTrigger(IDataChannel? dataChannel, IRenderScheduler renderScheduler)
     {
         switch (_triggerMode)
         {
             case TriggerMode.Single_Trigger:
-                // Enable TriggerView and notify MessageBus 
+                // Enable TriggerView and notify MessageBus
                 _plotTriggerView = true;
                 MessageBus.Current.SendMessage(!_plotTriggerView, "TrigCheckboxEnabled");
-                
+
                 new Thread(() =>
                 {
-                    Thread.Sleep(2000);
-                    timer.Stop(); // Stop Graph UI updates
+                    // Keep capturing until the post-trigger samples have arrived (or data stops coming).
+                    _postTriggerCaptured.Wait(PostTriggerTimeoutMs);
+                    renderScheduler.Stop(); // Stop Graph UI updates
                     switch (dataChannel)
                     {
                         case UartDataChannel:
@@ -113,13 +166,69 @@ public class TriggerService : ITriggerService
                 break;
 
             case TriggerMode.Normal_Trigger:
-                {
-                    lock (graphData)
-                    {
-                        _triggerStartIndex = graphData.YData.Count;
-                    }
-                    break;
-                }
+                // Re-arming after the post-trigger samples is handled at ingest.
+                break;
         }
     }
+
+    // Runs on the data source's thread after each batch, while the graph data is locked.
+    private void OnSamplesCommitted(object? sender, EventArgs e)
+    {
+        lock (_engine)
+            ScanCommittedSamples();
+    }
+
+    private void ScanCommittedSamples()
+    {
+        if (_capturingTrigger is TriggerPoint capturing)
+        {
+            // Hold off until the samples following the trigger have been captured.
+            if (capturing.Variable < _graphData.Columns.Count &&
+                _graphData.Columns[capturing.Variable].Current.EndIndex - capturing.SampleIndex <= PostTriggerSamples)
+                return;
+
+            _capturingTrigger = null;
+            _postTriggerCaptured.Set();
+
+            // Samples during the hold-off are not scanned, the next trigger is looked for from here.
+            _engine.Rearm(_graphData);
+        }
+
+        // Single trigger captures only once.
+        if (_singleTriggerFired)
+            return;
+
+        TriggerPoint? trigger = _engine.Scan(_graphData, IsTriggerable);
+        if (trigger == null)
+            return;
+
+        _detectedTrigger = trigger;
+        _lastTrigger = trigger;
+        _capturingTrigger = trigger;
+        _singleTriggerFired = _triggerMode == TriggerMode.Single_Trigger;
+        _postTriggerCaptured.Reset();
+    }
+
+    // Copies which variables may trigger, as the UI's collection may change while samples are scanned.
+    // Runs on the UI thread, while the engine is locked.
+    private void CopyTriggerableVariables(ObservableCollection<IVariableModel>? plotConfigVariables)
+    {
+        if (plotConfigVariables == null)
+        {
+            _triggerableVariables = null;
+            return;
+        }
+
+        if (_triggerableVariables?.Length != plotConfigVariables.Count)
+            _triggerableVariables = new bool[plotConfigVariables.Count];
+        for (int v = 0; v < _triggerableVariables.Length; v++)
+            _triggerableVariables[v] = plotConfigVariables[v].IsTriggerable;
+    }
+
+    private bool IsTriggerable(int variable)
+    {
+        // Skip checking triggers on a variable if it is not set as triggerable
+        bool[]? variables = _triggerableVariables;
+        return variables == null || variable >= variables.Length || variables[variable];
+    }
 }
\ No newline at end of file
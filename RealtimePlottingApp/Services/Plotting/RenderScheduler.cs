@@ -0,0 +1,291 @@
+﻿using System;
+using System.Diagnostics;
+using System.Threading;
+using Avalonia.Threading;
+using RealtimePlottingApp.Models;
+using RealtimePlottingApp.Services.Diagnostics;
+
+namespace RealtimePlottingApp.Services.Plotting;
+
+/// <summary>
+/// Schedules the plots' frames on the UI thread, driven by samples being committed to the graph data
+/// rather than by a fixed timer. Frames are coalesced: however many batches arrive between two frames,
+/// each plot is updated once with the latest data, and not before its previous frame has been rendered.
+/// The frame interval adapts to the measured render time, so that rendering uses at most half of the time.
+/// </summary>
+public class RenderScheduler : IRenderScheduler
+{
+    // ===== Constants ===== //
+    private const double MaxFps = 240;
+    private const double RenderBudget = 0.5; // Share of each frame interval that may be spent rendering
+    private const double PresentTimeoutMs = 500; // Renders may never complete, e.g. of a plot being hidden
+    private const double SmoothingFactor = 0.1;
+
+    // ===== Instance Variables ===== //
+    // A plot's frame state. Timestamps are Stopwatch timestamps, 0 meaning none.
+    private sealed class PlotSlot(Func<bool> render)
+    {
+        public readonly Func<bool> Render = render;
+        public long PendingSince;    // Commit of the oldest samples the plot doesn't show yet
+        public int Invalidated;      // Whether the plot must be redrawn without new samples
+        public long InFlightSince;   // Commit of the oldest samples in the frame being rendered
+        public long InFlightStarted; // Start of the frame being rendered
+    }
+
+    private PlotSlot[] _plots = [];
+    private volatile bool _running;
+    private int _frameRequested; // 1 while a frame is scheduled on the UI thread
+    private readonly DispatcherTimer _frameTimer;
+    private readonly DispatcherTimer _statisticsTimer;
+    private long _lastFrameStart;
+    private long _lastDroppedFrame;
+
+    // Statistics, guarded by _statisticsLock. Durations are in TimeSpan ticks.
+    private readonly object _statisticsLock = new();
+    private double _targetFps = 10;
+    private double _achievedFps;
+    private double _renderTimeMs;
+    private double _latencyMs;
+    private long _droppedFrames;
+    private int _framesThisPeriod;
+    private long _periodStart = Stopwatch.GetTimestamp();
+    private long _lastUpdateDuration = -1; // Time spent updating the plots in the last frame
+    private long _presentedDuration;       // Time spent rendering the plots since the last frame
+
+    // ===== Constructor ===== //
+    /// <summary>
+    /// Creates a scheduler redrawing the plots as samples are committed to the given graph data.
+    /// Must be created on the UI thread.
+    /// </summary>
+    public RenderScheduler(GraphDataModel graphData)
+    {
+        graphData.SamplesCommitted += OnSamplesCommitted;
+
+        _frameTimer = new DispatcherTimer();
+        _frameTimer.Tick += (_, _) =>
+        {
+            _frameTimer.Stop(); // One-shot, rescheduled whenever a frame is requested
+            RenderFrame();
+        };
+
+        _statisticsTimer = new DispatcherTimer { Interval = TimeSpan.FromSeconds(1) };
+        _statisticsTimer.Tick += (_, _) => UpdateStatistics();
+        _statisticsTimer.Start();
+    }
+
+    // ===== API Methods ===== //
+    public double TargetFps
+    {
+        get { lock (_statisticsLock) return _targetFps; }
+        set { lock (_statisticsLock) _targetFps = Math.Clamp(value, 1, MaxFps); }
+    }
+
+    public double AchievedFps
+    {
+        get { lock (_statisticsLock) return _achievedFps; }
+    }
+
+    public double RenderTimeMs
+    {
+        get { lock (_statisticsLock) return _renderTimeMs; }
+    }
+
+    public double LatencyMs
+    {
+        get { lock (_statisticsLock) return _latencyMs; }
+    }
+
+    public long DroppedFrames => Interlocked.Read(ref _droppedFrames);
+
+    public bool IsRunning => _running;
+
+    public event EventHandler? StatisticsUpdated;
+
+    public int AddPlot(Func<bool> render)
+    {
+        // Replaced rather than modified, as the array is read on the data sources' threads.
+        PlotSlot[] plots = new PlotSlot[_plots.Length + 1];
+        _plots.CopyTo(plots, 0);
+        plots[^1] = new PlotSlot(render);
+        _plots = plots;
+        return plots.Length - 1;
+    }
+
+    public void Start()
+    {
+        _running = true;
+    }
+
+    public void Stop()
+    {
+        _running = false;
+    }
+
+    public void Invalidate()
+    {
+        foreach (PlotSlot slot in _plots)
+            Volatile.Write(ref slot.Invalidated, 1);
+        RequestFrame();
+    }
+
+    public void Invalidate(int plot)
+    {
+        Volatile.Write(ref _plots[plot].Invalidated, 1);
+        RequestFrame();
+    }
+
+    public void Presented(int plot, TimeSpan renderTime)
+    {
+        PlotSlot slot = _plots[plot];
+        Interlocked.Add(ref _presentedDuration, renderTime.Ticks);
+        PipelineMetrics.DrawDuration.Record(renderTime.TotalMilliseconds);
+
+        // Renders that aren't caused by a frame, e.g. by resizing, don't show new samples.
+        long since = Interlocked.Exchange(ref slot.InFlightSince, 0);
+        Volatile.Write(ref slot.InFlightStarted, 0);
+        if (since != 0)
+        {
+            double latencyMs = Stopwatch.GetElapsedTime(since).TotalMilliseconds;
+            PipelineMetrics.Latency.Record(latencyMs);
+            lock (_statisticsLock)
+                _latencyMs = Smooth(_latencyMs, latencyMs);
+        }
+
+        // Updates held back while the frame was being rendered can be drawn now.
+        if (IsDirty(slot))
+            RequestFrame();
+    }
+
+    // ===== Frame scheduling ===== //
+    // Runs on the data source's thread after each batch, while the graph data is locked.
+    private void OnSamplesCommitted(object? sender, EventArgs e)
+    {
+        if (!_running)
+            return;
+
+        long now = Stopwatch.GetTimestamp();
+        foreach (PlotSlot slot in _plots)
+            Interlocked.CompareExchange(ref slot.PendingSince, now, 0);
+        RequestFrame();
+    }
+
+    // Schedules a frame on the UI thread, unless one is already scheduled.
+    private void RequestFrame()
+    {
+        if (Interlocked.Exchange(ref _frameRequested, 1) == 0)
+            Dispatcher.UIThread.Post(ScheduleFrame);
+    }
+
+    // Renders the frame now, or once a frame interval has passed since the last one.
+    private void ScheduleFrame()
+    {
+        double waitMs = FrameIntervalMs() - Stopwatch.GetElapsedTime(_lastFrameStart).TotalMilliseconds;
+        if (waitMs <= 0)
+        {
+            RenderFrame();
+            return;
+        }
+        _frameTimer.Interval = TimeSpan.FromMilliseconds(waitMs);
+        _frameTimer.Start();
+    }
+
+    // Updates every plot with changes to show, whose previous frame has been rendered.
+    private void RenderFrame()
+    {
+        // Requests from here on schedule another frame, so that samples committed meanwhile are drawn as well.
+        Volatile.Write(ref _frameRequested, 0);
+
+        long start = Stopwatch.GetTimestamp();
+        bool rendered = false, heldBack = false;
+        double timeoutMs = PresentTimeoutMs;
+        foreach (PlotSlot slot in _plots)
+        {
+            if (!IsDirty(slot))
+                continue;
+
+            long inFlight = Volatile.Read(ref slot.InFlightStarted);
+            double inFlightMs = inFlight != 0 ? Stopwatch.GetElapsedTime(inFlight, start).TotalMilliseconds : 0;
+            if (inFlight != 0 && inFlightMs < PresentTimeoutMs)
+            {
+                // Drawn once the previous frame has been rendered, which requests a frame, or has timed out.
+                heldBack = true;
+                timeoutMs = Math.Min(timeoutMs, PresentTimeoutMs - inFlightMs);
+                continue;
+            }
+
+            if (!rendered)
+                StartFrame(start);
+            rendered = true;
+
+            Volatile.Write(ref slot.Invalidated, 0);
+            Volatile.Write(ref slot.InFlightSince, Interlocked.Exchange(ref slot.PendingSince, 0));
+            Volatile.Write(ref slot.InFlightStarted, start);
+            if (!slot.Render())
+            {
+                // Nothing was drawn, so no render will complete the frame.
+                Volatile.Write(ref slot.InFlightSince, 0);
+                Volatile.Write(ref slot.InFlightStarted, 0);
+            }
+        }
+
+        if (rendered)
+            _lastUpdateDuration = Stopwatch.GetElapsedTime(start).Ticks;
+        if (heldBack)
+        {
+            // A frame is dropped at most once per frame interval, however often samples are committed meanwhile.
+            if (_lastDroppedFrame == 0
+                || Stopwatch.GetElapsedTime(_lastDroppedFrame, start).TotalMilliseconds >= FrameIntervalMs())
+            {
+                _lastDroppedFrame = start;
+                Interlocked.Increment(ref _droppedFrames);
+                PipelineMetrics.DroppedFrames.Add(1);
+            }
+
+            if (!_frameTimer.IsEnabled)
+            {
+                _frameTimer.Interval = TimeSpan.FromMilliseconds(timeoutMs);
+                _frameTimer.Start();
+            }
+        }
+    }
+
+    // Accounts for the previous frame's cost, now that its renders have completed.
+    private void StartFrame(long start)
+    {
+        long presented = Interlocked.Exchange(ref _presentedDuration, 0);
+        lock (_statisticsLock)
+        {
+            if (_lastUpdateDuration >= 0)
+                _renderTimeMs = Smooth(_renderTimeMs, TimeSpan.FromTicks(_lastUpdateDuration + presented).TotalMilliseconds);
+            _framesThisPeriod++;
+        }
+        PipelineMetrics.Frames.Add(1);
+        _lastFrameStart = start;
+    }
+
+    // Frames are at least as far apart as the target rate allows, and far enough apart to stay within the budget.
+    private double FrameIntervalMs()
+    {
+        lock (_statisticsLock)
+            return Math.Max(1000 / _targetFps, _renderTimeMs / RenderBudget);
+    }
+
+    private void UpdateStatistics()
+    {
+        long now = Stopwatch.GetTimestamp();
+        lock (_statisticsLock)
+        {
+            _achievedFps = _framesThisPeriod / Stopwatch.GetElapsedTime(_periodStart, now).TotalSeconds;
+            _framesThisPeriod = 0;
+            _periodStart = now;
+        }
+        StatisticsUpdated?.Invoke(this, EventArgs.Empty);
+    }
+
+    private static bool IsDirty(PlotSlot slot) =>
+        Volatile.Read(ref slot.PendingSince) != 0 || Volatile.Read(ref slot.Invalidated) != 0;
+
+    // Exponential moving average, starting from the first value.
+    private static double Smooth(double average, double value) =>
+        average == 0 ? value : average + (value - average) * SmoothingFactor;
+}
\ No newline at end of file
@@ -0,0 +1,52 @@
+﻿using System;
+using RealtimePlottingApp.Models;
+
+namespace RealtimePlottingApp.Services.Statistics;
+
+/// <summary>
+/// Keeps running statistics of every variable, updated as samples are ingested,
+/// so that they can be read in constant time however long the session has been running.
+/// Can be read from any thread.
+/// </summary>
+public interface IStatisticsService
+{
+    /// <summary>
+    /// Duration of the sliding window that windowed statistics are computed over.
+    /// Changing it starts the windows over.
+    /// </summary>
+    TimeSpan Window { get; set; }
+
+    /// <summary>
+    /// Number of variables statistics are kept for.
+    /// </summary>
+    int VariableCount { get; }
+
+    /// <summary>
+    /// Statistics of all samples of a variable since the data was last cleared.
+    /// </summary>
+    /// <param name="variable">Index of the variable</param>
+    /// <returns>The statistics, or VariableStatistics.Empty for an unknown variable.</returns>
+    VariableStatistics GetTotal(int variable);
+
+    /// <summary>
+    /// Statistics of a variable's samples within the sliding window ending at its newest sample.
+    /// </summary>
+    /// <param name="variable">Index of the variable</param>
+    /// <returns>The statistics, or VariableStatistics.Empty for an unknown variable.</returns>
+    VariableStatistics GetWindow(int variable);
+
+    /// <summary>
+    /// Estimates a quantile of a variable's samples, see QuantileSketch.
+    /// </summary>
+    /// <param name="variable">Index of the variable</param>
+    /// <param name="quantile">Fraction between 0 and 1, e.g. 0.99 for the 99th percentile</param>
+    /// <param name="window">True for the samples within the sliding window, false for all samples</param>
+    /// <returns>The estimate, or NaN if there are no samples.</returns>
+    double GetQuantile(int variable, double quantile, bool window);
+
+    /// <summary>
+    /// Finds the smallest and largest value of any variable since the data was last cleared.
+    /// </summary>
+    /// <returns>False if there is no data.</returns>
+    bool TryGetRange(out double min, out double max);
+}
\ No newline at end of file
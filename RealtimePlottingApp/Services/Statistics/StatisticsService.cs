@@ -0,0 +1,159 @@
+﻿using System;
+using System.Collections.Generic;
+using RealtimePlottingApp.Models;
+
+namespace RealtimePlottingApp.Services.Statistics;
+
+/// <summary>
+/// Keeps a StatisticsAccumulator per variable of a GraphDataModel, which is fed the samples of every
+/// batch as it is committed, so each sample costs O(1) at ingest and no reader ever scans the history.
+/// </summary>
+public class StatisticsService : IStatisticsService
+{
+    private readonly GraphDataModel _graphData;
+    private readonly object _lock = new(); // Guards the state below, the graph data's lock is left to its writer
+
+    private StatisticsAccumulator[] _variables = [];
+    private long[] _cursors = []; // Per variable, the next sample index to accumulate
+    private TimeSpan _window = TimeSpan.FromSeconds(10);
+    private double _ticksPerSecond;
+
+    public StatisticsService(GraphDataModel graphData)
+    {
+        // Accumulate samples as they are committed, and start over whenever the data is cleared.
+        _graphData = graphData;
+        _ticksPerSecond = graphData.TicksPerSecond;
+        _graphData.SamplesCommitted += OnSamplesCommitted;
+        _graphData.Cleared += OnCleared;
+    }
+
+    public TimeSpan Window
+    {
+        get => _window;
+        set
+        {
+            lock (_lock)
+            {
+                _window = value;
+                foreach (StatisticsAccumulator variable in _variables)
+                    variable.SetWindow(_window.TotalSeconds * _ticksPerSecond);
+            }
+        }
+    }
+
+    public int VariableCount
+    {
+        get
+        {
+            lock (_lock)
+                return _variables.Length;
+        }
+    }
+
+    public VariableStatistics GetTotal(int variable)
+    {
+        lock (_lock)
+        {
+            return variable >= 0 && variable < _variables.Length
+                ? _variables[variable].GetTotal(_ticksPerSecond)
+                : VariableStatistics.Empty;
+        }
+    }
+
+    public VariableStatistics GetWindow(int variable)
+    {
+        lock (_lock)
+        {
+            return variable >= 0 && variable < _variables.Length
+                ? _variables[variable].GetWindow(_ticksPerSecond)
+                : VariableStatistics.Empty;
+        }
+    }
+
+    public double GetQuantile(int variable, double quantile, bool window)
+    {
+        lock (_lock)
+        {
+            return variable >= 0 && variable < _variables.Length
+                ? _variables[variable].GetQuantile(quantile, window)
+                : double.NaN;
+        }
+    }
+
+    public bool TryGetRange(out double min, out double max)
+    {
+        min = double.MaxValue;
+        max = double.MinValue;
+        bool hasData = false;
+        lock (_lock)
+        {
+            foreach (StatisticsAccumulator variable in _variables)
+            {
+                VariableStatistics total = variable.GetTotal(_ticksPerSecond);
+                if (total.Count == 0) continue;
+                min = Math.Min(min, total.Min);
+                max = Math.Max(max, total.Max);
+                hasData = true;
+            }
+        }
+        return hasData;
+    }
+
+    // Runs on the data source's thread after each batch, while the graph data is locked.
+    private void OnSamplesCommitted(object? sender, EventArgs e)
+    {
+        lock (_lock)
+            AccumulateCommittedSamples();
+    }
+
+    // Runs on the thread clearing the graph data, while it is locked.
+    private void OnCleared(object? sender, EventArgs e)
+    {
+        lock (_lock)
+            Reset(_graphData.Columns.Count);
+    }
+
+    private void AccumulateCommittedSamples()
+    {
+        IReadOnlyList<SampleColumn> columns = _graphData.Columns;
+        if (_variables.Length != columns.Count)
+            Reset(columns.Count); // Variable count changed, start over with the samples retained.
+
+        // The timebase may be set after the data was cleared, e.g. when replaying a capture.
+        if (_ticksPerSecond != _graphData.TicksPerSecond)
+        {
+            _ticksPerSecond = _graphData.TicksPerSecond;
+            foreach (StatisticsAccumulator variable in _variables)
+                variable.SetWindow(_window.TotalSeconds * _ticksPerSecond);
+        }
+
+        for (int v = 0; v < columns.Count; v++)
+        {
+            ColumnSnapshot column = columns[v].Current;
+            StatisticsAccumulator variable = _variables[v];
+            foreach (ColumnSnapshot.Segment segment in column.GetSegments(_cursors[v], column.EndIndex))
+            {
+                for (int i = 0; i < segment.X.Length; i++)
+                    variable.Add(segment.X[i], segment.Y[i]);
+            }
+            _cursors[v] = column.EndIndex;
+        }
+    }
+
+    private void Reset(int variableCount)
+    {
+        if (_variables.Length != variableCount)
+        {
+            _variables = new StatisticsAccumulator[variableCount];
+            for (int v = 0; v < variableCount; v++)
+                _variables[v] = new StatisticsAccumulator();
+        }
+
+        foreach (StatisticsAccumulator variable in _variables)
+        {
+            variable.Clear();
+            variable.SetWindow(_window.TotalSeconds * _ticksPerSecond);
+        }
+        _cursors = new long[variableCount];
+    }
+}
\ No newline at end of file
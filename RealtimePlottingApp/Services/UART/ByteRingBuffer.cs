@@ -0,0 +1,126 @@
+﻿using System;
+
+namespace RealtimePlottingApp.Services.UART;
+
+/// <summary>
+/// Fixed-capacity circular byte buffer for holding received serial bytes until complete
+/// packages can be decoded. The capacity is rounded up to a power of two, so that wrap-around
+/// is a single mask operation, and no memory is allocated after construction.
+/// Not threadsafe, UARTSerialReader locks on the buffer itself around every access.
+/// </summary>
+public class ByteRingBuffer
+{
+    // ===== Instance Variables ===== //
+    private readonly byte[] _buffer;
+    private readonly int _mask;
+    private int _tail;  // Read position (oldest unread byte)
+    private int _count; // Number of unread bytes
+
+    // ===== Constructor ===== //
+    /// <summary>
+    /// Creates a ring buffer which holds at least the requested number of bytes.
+    /// </summary>
+    /// <param name="minimumCapacity">Minimum number of bytes the buffer should hold</param>
+    /// <exception cref="ArgumentOutOfRangeException">Thrown if the capacity is not positive</exception>
+    public ByteRingBuffer(int minimumCapacity)
+    {
+        ArgumentOutOfRangeException.ThrowIfNegativeOrZero(minimumCapacity);
+
+        // Round up to the closest power of two to allow masking instead of modulo.
+        int capacity = 1;
+        while (capacity < minimumCapacity)
+            capacity <<= 1;
+
+        _buffer = new byte[capacity];
+        _mask = capacity - 1;
+    }
+
+    // ===== API Methods ===== //
+    /// <summary>
+    /// The total number of bytes the buffer can hold.
+    /// </summary>
+    public int Capacity => _buffer.Length;
+
+    /// <summary>
+    /// The number of unread bytes currently held in the buffer.
+    /// </summary>
+    public int Count => _count;
+
+    /// <summary>
+    /// Appends as many bytes as there is room for to the buffer.
+    /// </summary>
+    /// <param name="data">The bytes to append</param>
+    /// <returns>The number of bytes written, which is less than the length of data if the buffer ran full.</returns>
+    public int Write(ReadOnlySpan<byte> data)
+    {
+        int toWrite = Math.Min(data.Length, _buffer.Length - _count);
+        int head = (_tail + _count) & _mask;
+
+        // Copy in (at most) two blocks: up to the end of the array, then the wrapped remainder from the start.
+        int firstPart = Math.Min(toWrite, _buffer.Length - head);
+        data[..firstPart].CopyTo(_buffer.AsSpan(head));
+        data[firstPart..toWrite].CopyTo(_buffer);
+
+        _count += toWrite;
+        return toWrite;
+    }
+
+    /// <summary>
+    /// Returns the unread byte at the given offset from the read position, without consuming it.
+    /// </summary>
+    /// <param name="offset">Offset from the oldest unread byte</param>
+    public byte Peek(int offset)
+    {
+        if ((uint)offset >= (uint)_count)
+            throw new ArgumentOutOfRangeException(nameof(offset));
+        return _buffer[(_tail + offset) & _mask];
+    }
+
+    /// <summary>
+    /// Copies unread bytes into destination, starting at the given offset from the read position,
+    /// without consuming them. Handles wrap-around transparently.
+    /// </summary>
+    /// <param name="offset">Offset from the oldest unread byte</param>
+    /// <param name="destination">Span to fill, its length decides how many bytes are copied</param>
+    public void Peek(int offset, Span<byte> destination)
+    {
+        if (offset < 0 || offset + destination.Length > _count)
+            throw new ArgumentOutOfRangeException(nameof(offset));
+
+        int start = (_tail + offset) & _mask;
+        int firstPart = Math.Min(destination.Length, _buffer.Length - start);
+        _buffer.AsSpan(start, firstPart).CopyTo(destination);
+        _buffer.AsSpan(0, destination.Length - firstPart).CopyTo(destination[firstPart..]);
+    }
+
+    /// <summary>
+    /// Copies the oldest unread bytes into destination and consumes them.
+    /// </summary>
+    /// <param name="destination">Span to fill, its length decides how many bytes are read</param>
+    public void Read(Span<byte> destination)
+    {
+        Peek(0, destination);
+        Skip(destination.Length);
+    }
+
+    /// <summary>
+    /// Consumes (discards) the given number of unread bytes.
+    /// </summary>
+    /// <param name="count">Number of bytes to discard</param>
+    public void Skip(int count)
+    {
+        if ((uint)count > (uint)_count)
+            throw new ArgumentOutOfRangeException(nameof(count));
+        _tail = (_tail + count) & _mask;
+        _count -= count;
+    }
+
+    /// <summary>
+    /// Discards all unread bytes.
+    /// </summary>
+    public void Clear()
+    {
+        _tail = 0;
+        _count = 0;
+    }
+}
\ No newline at end of file
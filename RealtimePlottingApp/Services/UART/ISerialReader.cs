@@ -11,7 +11,8 @@ public interface ISerialReader
 {
     /// <summary>
     /// Starts serial communication on given comPort with the provided baud rate.
-    /// Sends a start byte 'S' to the serial connection, opens a port, and begins asynchronous reading.
+    /// Opens a port, begins asynchronous reading, and sends a start byte to the serial connection:
+    /// 'F' to request framed transmission, falling back to 'S' for unframed packages if there's no response.
     /// </summary>
     /// <param name="comPort">The COM port (ex: "COM1" or "/dev/ttyS0")</param>
     /// <param name="baudRate">The baud rate for the serial connection</param>
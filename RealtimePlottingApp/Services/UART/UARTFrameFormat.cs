@@ -0,0 +1,81 @@
+﻿using System;
+
+namespace RealtimePlottingApp.Services.UART;
+
+/// <summary>
+/// Layout of the framed UART protocol, requested with an 'F' start byte. All values are big-endian.
+/// <code>
+/// Frame:  byte sync (0xA5) | byte header | ushort/uint timestamp | variables * (byte/ushort/uint data) | byte CRC-8
+/// Header: bits 0-4 variables - 1 | bits 5-6 payload size (0 = 8, 1 = 16, 2 = 32 bits) | bit 7 32-bit timestamp
+/// Status: byte sync (0xA5) | byte header (0x60) | uint overrun count | byte CRC-8
+/// </code>
+/// Every frame holds the values stored by one UART_StoreData call of the UartCLibrary, which share one timestamp.
+/// Status frames are marked by payload size 3, and report the values the device dropped because its buffer was full.
+/// The CRC-8 (polynomial 0x07, initial value 0) covers all bytes before it, including the sync byte.
+/// </summary>
+public static class UARTFrameFormat
+{
+    public const byte Sync = 0xA5;
+    public const int MinFrameSize = 6;   // One 8-bit value with a 16-bit timestamp
+    public const int MaxFrameSize = 135; // 32 variables of 32 bits with a 32-bit timestamp
+    public const int StatusFrameSize = 7;
+    public const byte OverrunStatusHeader = 0x60;
+
+    private static readonly byte[] CrcTable = CreateCrcTable();
+
+    /// <summary>
+    /// Decodes a frame's header byte.
+    /// </summary>
+    /// <returns>False if the header is invalid, in which case the frame can't be decoded.</returns>
+    public static bool TryParseHeader(byte header, out int variables, out int payloadBytes, out int timestampBytes)
+    {
+        variables = (header & 0x1F) + 1;
+        payloadBytes = 1 << ((header >> 5) & 0x3);
+        timestampBytes = (header & 0x80) != 0 ? 4 : 2;
+        return payloadBytes <= 4; // Size code 3 marks a status frame
+    }
+
+    /// <summary>
+    /// Whether a header byte starts a status frame rather than a frame of values.
+    /// </summary>
+    public static bool IsStatusHeader(byte header) => (header & 0x60) == 0x60;
+
+    /// <summary>
+    /// Encodes a frame's header byte.
+    /// </summary>
+    public static byte CreateHeader(int variables, int payloadBytes, int timestampBytes)
+    {
+        int sizeCode = payloadBytes switch { 1 => 0, 2 => 1, _ => 2 };
+        return (byte)((variables - 1) | (sizeCode << 5) | (timestampBytes == 4 ? 0x80 : 0));
+    }
+
+    /// <summary>
+    /// Total size in bytes of a frame with the given layout, including sync and CRC.
+    /// </summary>
+    public static int FrameSize(int variables, int payloadBytes, int timestampBytes) =>
+        2 + timestampBytes + variables * payloadBytes + 1;
+
+    /// <summary>
+    /// Calculates the CRC-8 (polynomial 0x07, initial value 0) of the given bytes.
+    /// </summary>
+    public static byte Crc8(ReadOnlySpan<byte> bytes)
+    {
+        byte crc = 0;
+        foreach (byte b in bytes)
+            crc = CrcTable[crc ^ b];
+        return crc;
+    }
+
+    private static byte[] CreateCrcTable()
+    {
+        byte[] table = new byte[256];
+        for (int i = 0; i < table.Length; i++)
+        {
+            int crc = i;
+            for (int bit = 0; bit < 8; bit++)
+                crc = (crc & 0x80) != 0 ? (crc << 1) ^ 0x07 : crc << 1;
+            table[i] = (byte)crc;
+        }
+        return table;
+    }
+}
\ No newline at end of file
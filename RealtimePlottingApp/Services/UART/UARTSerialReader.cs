@@ -1,10 +1,13 @@
 ﻿using System;
-using System.Collections.Generic;
+using System.Buffers.Binary;
+using System.Diagnostics;
 using System.IO;
 using System.IO.Ports;
 using System.Runtime.InteropServices;
+using System.Threading;
 using RealtimePlottingApp.Events;
 using RealtimePlottingApp.Models;
+using RealtimePlottingApp.Services.Diagnostics;
 
 namespace RealtimePlottingApp.Services.UART;
 
@@ -16,11 +19,62 @@ public class UARTSerialReader : ISerialReader
     private byte[] _readBuffer = [];
     private int _dataPayloadBytes = 0;
     private int _packageSize = 0;
-    private readonly List<byte> _receiveBuffer = []; // To be used with locking, ensure threadsafe.
+    private const int MaxPackageSize = 5; // 4 bytes data + 1 byte timestamp.
+    private const int ReadBufferSize = 4096;
+    
+    // How long to wait for a response to the framed start byte 'F', before assuming
+    // that the microcontroller only supports unframed packages and starting it with 'S'.
+    private const int NegotiationTimeoutMs = 1000;
+    
+    // Protocol state. Framed until negotiation falls back, guarded by the receive buffer's lock.
+    private bool _framed;
+    private bool _resyncing; // Looking for the next frame after a corrupted one
+    private int _timestampBits = 8;
+    private bool _bytesReceived;
+    private Timer? _negotiationTimer;
+    
+    // Received bytes waiting to be decoded. To be used with locking, ensure threadsafe.
+    // Holds two full reads so that a partial package from the previous read always fits.
+    private readonly ByteRingBuffer _receiveBuffer = new ByteRingBuffer(ReadBufferSize * 2);
+    
+    // Decoded packages handed to subscribers. Reused between reads to avoid allocating per package,
+    // sized to fit every package that the receive buffer could possibly hold.
+    private UARTTimestampedData[] _decodedPackages = [];
+    
+    // Number of received bytes discarded because the receive buffer was full.
+    private long _droppedBytes;
+    
+    // Number of times a corrupted frame was detected and the stream had to be resynchronized.
+    private long _corruptFrames;
+    
+    // Latest overrun count reported by the device through a status frame.
+    private long _deviceOverruns;
     
     //----- ISerialReader API events -----//
     public event EventHandler<TimestampedDataReceivedEvent>? TimestampedDataReceived;
     
+    /// <summary>
+    /// Total number of received bytes that were discarded because they could not be decoded in time.
+    /// </summary>
+    public long DroppedBytes => Interlocked.Read(ref _droppedBytes);
+    
+    /// <summary>
+    /// Number of corrupted frames detected in a framed transmission, each of which was skipped
+    /// by resynchronizing on the next valid frame.
+    /// </summary>
+    public long CorruptFrames => Interlocked.Read(ref _corruptFrames);
+    
+    /// <summary>
+    /// Number of values the device dropped because its transmit buffer was full, as last reported
+    /// in a framed transmission. Samples are missing from the plot whenever this increases.
+    /// </summary>
+    public long DeviceOverruns => Interlocked.Read(ref _deviceOverruns);
+    
+    /// <summary>
+    /// Whether the connection transmits frames, rather than unframed packages.
+    /// </summary>
+    public bool IsFramed => _framed;
+    
     //----- Constructor -----//
     public UARTSerialReader()
     {
@@ -41,15 +95,6 @@ public class UARTSerialReader : ISerialReader
         AppDomain.CurrentDomain.ProcessExit += ForceStopCleanup; // Register or re-register
         Console.CancelKeyPress += ForceStopCleanup;
 
-        _dataPayloadBytes = payloadDataSize switch
-        {
-            UARTDataPayloadSize.UART_PAYLOAD_8 => 1,
-            UARTDataPayloadSize.UART_PAYLOAD_16 => 2,
-            UARTDataPayloadSize.UART_PAYLOAD_32 => 4,
-            _ => 1 // Assume 8bit data if payloadDataSize was somehow messed up
-        };
-
-        _packageSize = _dataPayloadBytes + 1; // Package size including timestamp (8bits)
         try
         {
             // Create the serial port with manually set buffer sizes (increasing read buffer) and open the port. 
@@ -82,14 +127,17 @@ public class UARTSerialReader : ISerialReader
         }
         
         // Prepare buffers for async reads, start the read loop.
-        _readBuffer = new byte[4096];
+        _readBuffer = new byte[ReadBufferSize];
+        PrepareDecoding(payloadDataSize, framed: true);
         _isReading = true;
         StartReadingLoop();
         
-        // Tell UART we're ready to receive (start message)
+        // Tell UART we're ready to receive (start message), asking for frames.
+        // Microcontrollers which don't support frames ignore the request, and are started unframed instead.
         try
         {
-            _serialPort.Write([(byte)'S'], 0, 1);
+            _serialPort.Write([(byte)'F'], 0, 1);
+            _negotiationTimer = new Timer(FallBackToUnframed, null, NegotiationTimeoutMs, Timeout.Infinite);
         }
         catch (Exception e)
         {
@@ -116,6 +164,8 @@ public class UARTSerialReader : ISerialReader
         }
         
         _isReading = false;
+        _negotiationTimer?.Dispose();
+        _negotiationTimer = null;
         
         // Close serial port
         try
@@ -157,17 +207,7 @@ public class UARTSerialReader : ISerialReader
                         int actualLength = _serialPort.BaseStream.EndRead(ar);
                         if (actualLength > 0)
                         {
-                            // Append the newly read bytes to our internal buffer.
-                            lock (_receiveBuffer)
-                            {
-                                for (int i = 0; i < actualLength; i++)
-                                {
-                                    _receiveBuffer.Add(_readBuffer[i]);
-                                }
-                            }
-                            
-                            // Process complete packages.
-                            ProcessReceiveBuffer();
+                            OnBytesReceived(_readBuffer.AsSpan(0, actualLength));
                         }
                     }
                     catch (IOException e)
@@ -198,59 +238,224 @@ public class UARTSerialReader : ISerialReader
         kickoffRead();
     }
 
+    // Sets up decoding of packages with the given payload size, or of frames, discarding anything previously received.
+    // Internal so that the decoding can be benchmarked without a serial port.
+    internal void PrepareDecoding(UARTDataPayloadSize payloadDataSize, bool framed = false)
+    {
+        _dataPayloadBytes = payloadDataSize switch
+        {
+            UARTDataPayloadSize.UART_PAYLOAD_8 => 1,
+            UARTDataPayloadSize.UART_PAYLOAD_16 => 2,
+            UARTDataPayloadSize.UART_PAYLOAD_32 => 4,
+            _ => 1 // Assume 8bit data if payloadDataSize was somehow messed up
+        };
+
+        _packageSize = _dataPayloadBytes + 1; // Package size including timestamp (8bits)
+        
+        // Frames carry at most one package per byte.
+        _decodedPackages = new UARTTimestampedData[framed ? _receiveBuffer.Capacity : _receiveBuffer.Capacity / _packageSize];
+        lock (_receiveBuffer)
+        {
+            _receiveBuffer.Clear(); // Discard any partial package from a previous connection
+            _framed = framed;
+            _resyncing = false;
+            _timestampBits = 8;
+            _bytesReceived = false;
+        }
+    }
+
+    // Appends newly read bytes to the receive buffer and decodes the complete packages.
+    internal void OnBytesReceived(ReadOnlySpan<byte> bytes)
+    {
+        PipelineMetrics.UartBytesRead.Add(bytes.Length);
+
+        // Append the newly read bytes to our internal buffer.
+        lock (_receiveBuffer)
+        {
+            _bytesReceived = true;
+            int written = _receiveBuffer.Write(bytes);
+            if (written < bytes.Length)
+            {
+                // Reported through the counters only, the read path is already behind when this happens.
+                Interlocked.Add(ref _droppedBytes, bytes.Length - written);
+                PipelineMetrics.UartBytesDropped.Add(bytes.Length - written);
+            }
+        }
+        
+        // Process complete packages.
+        ProcessReceiveBuffer();
+    }
+
     private void ProcessReceiveBuffer()
     {
-        List<UARTTimestampedData> packages = new List<UARTTimestampedData>();
+        int packageCount = 0;
+        int timestampBits;
+        long start = Stopwatch.GetTimestamp();
 
         lock (_receiveBuffer)
         {
-            // While there is at least one complete package available...
-            while (_receiveBuffer.Count >= _packageSize)
+            if (_framed)
+                packageCount = DecodeFrames();
+            else
+                packageCount = DecodePackages();
+            timestampBits = _timestampBits;
+        }
+
+        if (packageCount > 0)
+        {
+            PipelineMetrics.RecordSince(PipelineMetrics.ParseDuration, start);
+            PipelineMetrics.ParsedSamples.Add(packageCount);
+
+            // Raise our custom event with the parsed packages.
+            // The next read is not started until subscribers return, so the array is not overwritten meanwhile.
+            TimestampedDataReceived?.Invoke(this, 
+                new TimestampedDataReceivedEvent(_decodedPackages.AsMemory(0, packageCount), timestampBits));
+        }
+    }
+
+    // Decodes all complete unframed packages in the receive buffer. Must hold the buffer's lock.
+    private int DecodePackages()
+    {
+        int packageCount = 0;
+
+        // Scratch space for one package, so decoding never has to deal with ring wrap-around.
+        Span<byte> packageBytes = stackalloc byte[MaxPackageSize];
+        packageBytes = packageBytes[.._packageSize];
+        
+        // While there is at least one complete package available...
+        while (_receiveBuffer.Count >= _packageSize)
+        {
+            // Extract the package bytes, removing them from the buffer.
+            _receiveBuffer.Read(packageBytes);
+
+            // Data is transmitted in big-endian order, followed by an 8-bit timestamp.
+            _decodedPackages[packageCount++] = new UARTTimestampedData
             {
-                // Extract the package bytes.
-                byte[] packageBytes = _receiveBuffer.GetRange(0, _packageSize).ToArray();
-
-                // Remove the processed bytes from the buffer.
-                _receiveBuffer.RemoveRange(0, _packageSize);
-                
-                // Extract payload bytes (first _dataPayloadBytes bytes)
-                byte[] payloadBytes = new byte[_dataPayloadBytes];
-                Array.Copy(packageBytes, 0, payloadBytes, 0, _dataPayloadBytes);
-                // Data is transmitted in big-endian order.
-                // If the system is little-endian, reverse the payload bytes.
-                if (BitConverter.IsLittleEndian && _dataPayloadBytes > 1)
-                {
-                    Array.Reverse(payloadBytes);
-                }
+                Data = DecodePayload(packageBytes[.._dataPayloadBytes]),
+                Time = packageBytes[_dataPayloadBytes],
+                Variable = -1 // Given by the order of the packages
+            };
+        }
+        return packageCount;
+    }
 
-                // Use switch-case to convert payload bytes to an unsigned integer.
-                uint dataValue = _dataPayloadBytes switch
-                {
-                    1 => payloadBytes[0],
-                    2 => BitConverter.ToUInt16(payloadBytes, 0),
-                    4 => BitConverter.ToUInt32(payloadBytes, 0),
-                    _ => 0
-                };
+    // Decodes all complete frames in the receive buffer into one package per variable,
+    // skipping bytes until the next valid frame whenever a frame is corrupted. Must hold the buffer's lock.
+    private int DecodeFrames()
+    {
+        int packageCount = 0;
+        Span<byte> frame = stackalloc byte[UARTFrameFormat.MaxFrameSize];
 
-                // Parse 8-bit timestamp.
-                byte tsByte = packageBytes[_dataPayloadBytes];
-                ushort timeStamp = tsByte;
+        while (_receiveBuffer.Count >= UARTFrameFormat.MinFrameSize)
+        {
+            // Find the next frame's sync byte, and check that a frame with a valid header and CRC follows it.
+            if (_receiveBuffer.Peek(0) == UARTFrameFormat.Sync && UARTFrameFormat.IsStatusHeader(_receiveBuffer.Peek(1)))
+            {
+                if (_receiveBuffer.Count < UARTFrameFormat.StatusFrameSize)
+                    break; // Wait for the rest of the frame
+                DecodeStatusFrame(frame[..UARTFrameFormat.StatusFrameSize]);
+                continue;
+            }
+            if (_receiveBuffer.Peek(0) != UARTFrameFormat.Sync ||
+                !UARTFrameFormat.TryParseHeader(_receiveBuffer.Peek(1), out int variables, out int payloadBytes, out int timestampBytes))
+            {
+                SkipCorruptByte();
+                continue;
+            }
 
-                UARTTimestampedData package = new UARTTimestampedData
+            int frameSize = UARTFrameFormat.FrameSize(variables, payloadBytes, timestampBytes);
+            if (_receiveBuffer.Count < frameSize)
+                break; // Wait for the rest of the frame
+            
+            Span<byte> frameBytes = frame[..frameSize];
+            _receiveBuffer.Peek(0, frameBytes);
+            if (UARTFrameFormat.Crc8(frameBytes[..^1]) != frameBytes[^1])
+            {
+                // Not a frame after all, or a corrupted one. Resynchronize from the next byte.
+                SkipCorruptByte();
+                continue;
+            }
+
+            _receiveBuffer.Skip(frameSize);
+            _resyncing = false;
+            _timestampBits = timestampBytes * 8;
+            
+            uint time = DecodePayload(frameBytes.Slice(2, timestampBytes));
+            ReadOnlySpan<byte> payloads = frameBytes.Slice(2 + timestampBytes, variables * payloadBytes);
+            for (int v = 0; v < variables; v++)
+            {
+                _decodedPackages[packageCount++] = new UARTTimestampedData
                 {
-                    Data = dataValue,
-                    Time = timeStamp
+                    Data = DecodePayload(payloads.Slice(v * payloadBytes, payloadBytes)),
+                    Time = time,
+                    Variable = v
                 };
-
-                packages.Add(package);
             }
         }
+        return packageCount;
+    }
+
+    // Decodes a status frame at the start of the receive buffer, or skips a byte if it's corrupted.
+    private void DecodeStatusFrame(Span<byte> frameBytes)
+    {
+        _receiveBuffer.Peek(0, frameBytes);
+        if (frameBytes[1] != UARTFrameFormat.OverrunStatusHeader || UARTFrameFormat.Crc8(frameBytes[..^1]) != frameBytes[^1])
+        {
+            SkipCorruptByte();
+            return;
+        }
 
-        if (packages.Count > 0)
+        _receiveBuffer.Skip(frameBytes.Length);
+        _resyncing = false;
+        // The device reports its running total, count what it dropped since the last report.
+        long overruns = DecodePayload(frameBytes.Slice(2, 4));
+        long previous = Interlocked.Exchange(ref _deviceOverruns, overruns);
+        if (overruns > previous)
+            PipelineMetrics.UartDeviceOverruns.Add(overruns - previous);
+    }
+
+    // Discards a byte which doesn't start a valid frame, counting a corrupted frame when alignment was just lost.
+    private void SkipCorruptByte()
+    {
+        _receiveBuffer.Skip(1);
+        if (_resyncing)
+            return;
+        _resyncing = true;
+        Interlocked.Increment(ref _corruptFrames);
+        PipelineMetrics.UartCorruptFrames.Add(1);
+    }
+
+    // Starts an unframed transmission if the request for frames went unanswered.
+    private void FallBackToUnframed(object? state)
+    {
+        lock (_receiveBuffer)
         {
-            // Raise our custom event with the parsed packages.
-            TimestampedDataReceived?.Invoke(this, new TimestampedDataReceivedEvent(packages.ToArray()));
+            if (!_isReading || _bytesReceived)
+                return;
+            _framed = false;
         }
+
+        try
+        {
+            Console.WriteLine("No response to the framed start byte, starting unframed transmission.");
+            _serialPort?.Write([(byte)'S'], 0, 1);
+        }
+        catch (Exception e)
+        {
+            Console.WriteLine("Error while writing start byte to serial port: " + e.Message);
+        }
+    }
+
+    // Converts big-endian payload bytes to an unsigned integer, independent of system endianness.
+    private static uint DecodePayload(ReadOnlySpan<byte> payloadBytes)
+    {
+        return payloadBytes.Length switch
+        {
+            1 => payloadBytes[0],
+            2 => BinaryPrimitives.ReadUInt16BigEndian(payloadBytes),
+            4 => BinaryPrimitives.ReadUInt32BigEndian(payloadBytes),
+            _ => 0
+        };
     }
 
     // Called upon application force shutdown to gracefully reset (and make ready) the
@@ -262,7 +467,7 @@ public class UARTSerialReader : ISerialReader
             if (_serialPort == null || !_serialPort.IsOpen) return;
             _serialPort.Write([(byte)'R'], 0, 1);
             _serialPort.BaseStream.Flush(); // Ensure the stop byte is sent
-            System.Threading.Thread.Sleep(50); // Small delay to allow transmission
+            Thread.Sleep(50); // Small delay to allow transmission
         }
         catch (Exception ex)
         {
@@ -1,7 +1,9 @@
 ﻿using System;
 using System.Diagnostics;
 using System.Windows.Input;
+using Avalonia.Threading;
 using ReactiveUI;
+using RealtimePlottingApp.Services.Diagnostics;
 
 namespace RealtimePlottingApp.ViewModels
 {
@@ -9,6 +11,8 @@ namespace RealtimePlottingApp.ViewModels
     public class FooterViewModel : ViewModelBase
     {
         // --- Private variables --- //
+        private readonly MetricsCollector _metricsCollector = new();
+        private string? _metricsPath; // File the metrics are being recorded to, if any
         
         // --- Data binding variables --- // 
         // Data binding text to show connection status:
@@ -20,10 +24,29 @@ namespace RealtimePlottingApp.ViewModels
             set => this.RaiseAndSetIfChanged(ref _commInterfaceStatus, value);
         }
         
+        // Data binding text to show the plots' frame rate and latency:
+        private string _renderStatus = "";
+
+        public string RenderStatus
+        {
+            get => _renderStatus;
+            set => this.RaiseAndSetIfChanged(ref _renderStatus, value);
+        }
+        
+        // Data binding text listing the pipeline metrics, one per line, for the diagnostics panel:
+        private string _diagnostics = "Waiting for metrics...";
+
+        public string Diagnostics
+        {
+            get => _diagnostics;
+            set => this.RaiseAndSetIfChanged(ref _diagnostics, value);
+        }
+        
         // The constructor
         public FooterViewModel()
         {
             MessageBusSubscriptionInit();
+            _metricsCollector.Updated += OnMetricsUpdated;
             
             // Initialize ICommands
             OnGithubClick = ReactiveCommand.Create(OpenGithubRepo);
@@ -49,6 +72,13 @@ namespace RealtimePlottingApp.ViewModels
             }
         }
         
+        // Shows the latest readings in the diagnostics panel.
+        private void OnMetricsUpdated(object? sender, EventArgs e)
+        {
+            string diagnostics = string.Join(Environment.NewLine, _metricsCollector.Readings);
+            Dispatcher.UIThread.Post(() => Diagnostics = diagnostics);
+        }
+        
         // =============== Message Bus Initializer =============== //
         private void MessageBusSubscriptionInit()
         {
@@ -90,6 +120,67 @@ namespace RealtimePlottingApp.ViewModels
                 {
                     CommInterfaceStatus = $"CAN Error: {msg[9..]}";
                 }
+                
+                else if (msg.StartsWith("ReplayConnected:"))
+                {
+                    CommInterfaceStatus = "Replay: Playing";
+                }
+                
+                else if (msg.Equals("ReplayDisconnected"))
+                {
+                    CommInterfaceStatus = "Replay: Stopped";
+                }
+                
+                // Message containing replay error statuses to display:
+                else if (msg.StartsWith("ReplayError:"))
+                {
+                    CommInterfaceStatus = $"Replay Error: {msg[12..]}";
+                }
+                
+                // Messages about recording of capture files:
+                else if (msg.Equals("CaptureStarted"))
+                {
+                    CommInterfaceStatus += " (Recording)";
+                }
+                
+                else if (msg.StartsWith("CaptureStopped:"))
+                {
+                    CommInterfaceStatus = $"Capture saved: {msg[16..]}";
+                }
+                
+                else if (msg.StartsWith("CaptureError:"))
+                {
+                    CommInterfaceStatus = $"Capture Error: {msg[14..]}";
+                }
+                
+                // Message containing the render statistics, formatted "RenderStats:target:achieved:latency"
+                else if (msg.StartsWith("RenderStats:"))
+                {
+                    string[] stats = msg[12..].Split(':');
+                    RenderStatus = $"{stats[1]} / {stats[0]} FPS, {stats[2]} ms latency";
+                }
+                
+                // Messages about recording the pipeline metrics to a file:
+                else if (msg.StartsWith("StartMetricsRecording:"))
+                {
+                    try
+                    {
+                        _metricsCollector.StartRecording(msg[22..]);
+                        _metricsPath = msg[22..];
+                        CommInterfaceStatus += " (Recording metrics)";
+                    }
+                    catch (Exception e)
+                    {
+                        CommInterfaceStatus = $"Metrics Error: {e.Message}";
+                    }
+                }
+                
+                else if (msg.Equals("StopMetricsRecording") && _metricsPath != null)
+                {
+                    _metricsCollector.StopRecording();
+                    CommInterfaceStatus = $"Metrics saved: {_metricsPath}";
+                    _metricsPath = null;
+                }
             });
         }
         
@@ -1,20 +1,23 @@
 ﻿using System;
 using System.Collections.Generic;
 using System.Collections.ObjectModel;
+using System.Globalization;
 using System.Linq;
-using System.Timers;
 using Avalonia.Controls;
-using Avalonia.Threading;
 using ReactiveUI;
 using RealtimePlottingApp.Models;
 using RealtimePlottingApp.Services.CAN;
+using RealtimePlottingApp.Services.Capture;
 using RealtimePlottingApp.Services.ConfigParsers;
 using RealtimePlottingApp.Services.DataChannels;
+using RealtimePlottingApp.Services.Diagnostics;
+using RealtimePlottingApp.Services.Plotting;
 using RealtimePlottingApp.Services.Plotting.BlockDiagram;
 using RealtimePlottingApp.Services.Plotting.LineGraph;
+using RealtimePlottingApp.Services.Statistics;
 using RealtimePlottingApp.Services.UART;
+using ScottPlot;
 using ScottPlot.Avalonia;
-using Timer = System.Timers.Timer;
 
 namespace RealtimePlottingApp.ViewModels
 {
@@ -31,9 +34,17 @@ namespace RealtimePlottingApp.ViewModels
         private readonly IPlotUiService _plotUiService;
         private readonly IBlockDataService _blockDataService;
         private readonly IBlockUiService _blockUiService;
+        private readonly IStatisticsService _statisticsService;
         
-        // --- UI Timers --- //
-        private readonly Timer _uiUpdateTimer;
+        // --- Capture recording --- //
+        private CaptureRecorder? _captureRecorder;
+        private string? _capturePath; // File to record the current, or next, session to
+        private string? _sessionConfig; // Connect message of the live session, null while not connected
+        
+        // --- UI Updates --- //
+        private readonly IRenderScheduler _renderScheduler;
+        private readonly int _linePlotFrame; // The plots' numbers in the render scheduler
+        private readonly int _blockPlotFrame;
         
         // --- Plot Assigner via View --- //
         public AvaPlot? LinePlot
@@ -57,21 +68,33 @@ namespace RealtimePlottingApp.ViewModels
             GraphDataModel dataModelForDepInjection= new GraphDataModel();
             // === Initialize services === //
             _configParser = new ConfigParser();
+            // Running statistics of each variable, kept up to date at ingest
+            _statisticsService = new StatisticsService(dataModelForDepInjection);
             // LineGraph Services
             _graphDataService = new GraphDataService(dataModelForDepInjection);
-            _triggerService = new TriggerService();
+            _triggerService = new TriggerService(dataModelForDepInjection);
+            _graphDataService.PreTriggerSamples = _triggerService.PreTriggerSamples;
+            _graphDataService.PostTriggerSamples = _triggerService.PostTriggerSamples;
             _plotUiService = new PlotUiService();
             _plotUiService.LinePlot = LinePlot;
+            _plotUiService.HistoryViewChanged += OnHistoryViewChanged;
             
             // BlockDiagram Services
-            _blockDataService = new BlockDataService(dataModelForDepInjection);
+            _blockDataService = new BlockDataService(dataModelForDepInjection, _statisticsService);
             _blockUiService = new BlockUiService();
             _blockUiService.BlockPlot = BlockPlot;
 
-            // === UI update timer === //
-            _uiUpdateTimer = new Timer(100); // ms between UI updates
-            _uiUpdateTimer.Elapsed += UpdateLinePlot;
-            _uiUpdateTimer.Elapsed += UpdateBlockPlot;
+            // === UI update scheduling === //
+            // Plots are redrawn as samples arrive, at most at the target frame rate.
+            _renderScheduler = new RenderScheduler(dataModelForDepInjection);
+            _linePlotFrame = _renderScheduler.AddPlot(UpdateLinePlot);
+            _blockPlotFrame = _renderScheduler.AddPlot(UpdateBlockPlot);
+            _plotUiService.Rendered += (_, renderTime) => _renderScheduler.Presented(_linePlotFrame, renderTime);
+            _blockUiService.Rendered += (_, renderTime) => _renderScheduler.Presented(_blockPlotFrame, renderTime);
+            _renderScheduler.StatisticsUpdated += OnRenderStatisticsUpdated;
+            
+            // Report the graph data's memory usage with the pipeline metrics.
+            PipelineMetrics.Observe(dataModelForDepInjection);
             
             // Initialize subscriptions for incoming message bus messages.
             MessageBusSubscriptionInit();
@@ -82,59 +105,135 @@ namespace RealtimePlottingApp.ViewModels
                 _plotUiService.PlotConfigVariables =
                     [new VariableModel { Name = "Var 1", IsChecked = true, IsTriggerable = true }];
                 _dataChannel = new DataGeneratorChannel(_graphDataService.GraphData);
-                _uiUpdateTimer.Start();
+                _renderScheduler.Start();
                 _dataChannel.Connect();
             }
         }
         
         // =============== Graph Update Loop =============== //
-        private void UpdateLinePlot(object? sender, ElapsedEventArgs? e)
+        // Called by the render scheduler on the UI thread, once the line plot has new data or view changes to show.
+        // Returns whether the plot will be rendered, which a hidden plot isn't.
+        private bool UpdateLinePlot()
         {
-            // Trigger index indicating whether trigger has occured.
-            int triggerIndex = _triggerService.CheckForTrigger(
-                _graphDataService.GraphData, _plotUiService.PlotConfigVariables,
-                _graphDataService.UniqueVars, _plotUiService.TriggerLevel);
+            // Trigger point indicating whether trigger has occured since the last update.
+            TriggerPoint? trigger = _triggerService.CheckForTrigger(
+                _plotUiService.PlotConfigVariables, _plotUiService.TriggerLevel);
             
-            if (triggerIndex >= 0)
+            if (trigger.HasValue)
             {
                 // Trigger has occured, handle it accordingly.
-                _triggerService.HandleTrigger(_dataChannel, _uiUpdateTimer, _graphDataService.GraphData);
+                _triggerService.HandleTrigger(_dataChannel, _renderScheduler);
             }
             
-            // Get sub-arrays and a relative trigger index
+            // Keep UI Service's flags up to date
+            _plotUiService.PlotFullHistory = _graphDataService.IsFullHistory;
+            _plotUiService.LockTriggerLevel = _triggerService.PlotTriggerView;
+
+            // Get per-variable series and a relative trigger index, sized for the plot's current width.
+            // Extracting on the UI thread ensures the reused plot series are never overwritten while being rendered.
+            _graphDataService.PixelWidth = _plotUiService.PixelWidth;
             _graphDataService.GetSubData(
-                out double[] xDataDouble,
-                out double[] yDataDouble,
+                out IReadOnlyList<PlotSeries> series,
                 out int subArrTriggerIndex,
-                triggerIndex >= 0 ? triggerIndex : null,
-                _triggerService.LastTriggerIndex >= 0 ? _triggerService.LastTriggerIndex : null,
+                trigger,
+                _triggerService.LastTrigger,
                 _triggerService.Mode
             );
-            
-            // Keep UI Service's flags up to date
-            _plotUiService.PlotFullHistory = _graphDataService.IsFullHistory;
-            _plotUiService.LockTriggerLevel = _triggerService.PlotTriggerView;
 
             // Update the graph's UI in regards to the extracted data and trigger indexes.
-            _plotUiService.UpdateGraphUI(xDataDouble, yDataDouble, 
-                subArrTriggerIndex, _triggerService.LastTriggerIndex);
+            _plotUiService.UpdateGraphUI(series, subArrTriggerIndex, _triggerService.LastTrigger?.Variable ?? -1);
             
-            // Manual disconnect, disable UI updates (timer calls of this method).
+            // Manual disconnect, stop following incoming data.
             if (_graphDataService.IsFullHistory)
             {
-                _uiUpdateTimer.Stop();
+                _renderScheduler.Stop();
             }
+            return Plot1Visible;
         }
 
-        private void UpdateBlockPlot(object? sender, ElapsedEventArgs? e)
+        private void OnHistoryViewChanged(object? sender, AxisLimits limits)
         {
+            // Re-extract the data for the range the user panned or zoomed to,
+            // the plot update is scheduled to run after the render that raised this has completed.
+            _graphDataService.SetHistoryView(limits.Left, limits.Right);
+            _renderScheduler.Invalidate(_linePlotFrame);
+        }
+
+        private bool UpdateBlockPlot()
+        {
+            // A hidden block diagram is updated once it's shown again.
+            if (!Plot2Visible) return false;
+            
             // Extract presentable data values
-            double[] extractedVals = _blockDataService.ExtractVariableValues();
+            VariableStatistics[] extractedStats = _blockDataService.ExtractVariableStatistics();
             
             // Provide presentable data values for UI updating
-            _blockUiService.UpdateBlockUI(extractedVals);
+            _blockUiService.UpdateBlockUI(extractedStats);
+            return true;
+        }
+
+        // Switches to history mode once a session has ended, which shows the full history once more.
+        private void EnterHistoryMode()
+        {
+            _graphDataService.SetFullHistory(true);
+            _renderScheduler.Invalidate();
+        }
+
+        private void OnRenderStatisticsUpdated(object? sender, EventArgs e)
+        {
+            MessageBus.Current.SendMessage(string.Create(CultureInfo.InvariantCulture,
+                $"RenderStats:{_renderScheduler.TargetFps:F0}:{_renderScheduler.AchievedFps:F0}:{_renderScheduler.LatencyMs:F0}"));
         }
         
+        // =============== Capture recording =============== //
+        // Marks a live session as started, and starts recording it if a capture file was requested.
+        private void StartSession(string connectMessage)
+        {
+            _sessionConfig = connectMessage;
+            if (_capturePath != null)
+                StartCapture();
+        }
+
+        // Marks the live session as ended, which finalizes its capture.
+        private void EndSession()
+        {
+            _sessionConfig = null;
+            StopCapture();
+        }
+
+        private void StartCapture()
+        {
+            try
+            {
+                _captureRecorder = new CaptureRecorder(_graphDataService.GraphData, _capturePath!, _sessionConfig!);
+                MessageBus.Current.SendMessage("CaptureStarted");
+            }
+            catch (Exception e)
+            {
+                _capturePath = null;
+                MessageBus.Current.SendMessage($"CaptureError: {e.Message}");
+            }
+        }
+
+        // Finalizes the capture file, if recording. A capture covers one session, so the file request is cleared too.
+        private void StopCapture()
+        {
+            _capturePath = null;
+            if (_captureRecorder == null) return;
+
+            try
+            {
+                long samples = _captureRecorder.SampleCount;
+                _captureRecorder.Dispose();
+                MessageBus.Current.SendMessage($"CaptureStopped: {samples} samples recorded");
+            }
+            catch (Exception e)
+            {
+                MessageBus.Current.SendMessage($"CaptureError: {e.Message}");
+            }
+            _captureRecorder = null;
+        }
+
         // =============== Handle graph visibility =============== //
         private bool _plot1Visible = true;
         private bool _plot2Visible; // false default
@@ -166,26 +265,29 @@ namespace RealtimePlottingApp.ViewModels
                 {
                     // Try to parse the config. If parsing goes well, connect.
                     if (_configParser.ParseUartConfig(msg, out string comPort, out int baudRate, 
-                            out UARTDataPayloadSize dataSize, out int uniqueVars))
+                            out UARTDataPayloadSize dataSize, out int uniqueVars, out double ticksPerSecond))
                     {
                         try
                         {
                             _dataChannel?.Disconnect(); // Ensure no channel exists for any medium
+                            EndSession();
                             _triggerService.ResetTrigger();
                             _graphDataService.ClearData(); // Clear graph data to plot new connection's data
                             _blockDataService.ClearData();
                             _graphDataService.UniqueVars = uniqueVars; // Set number of unique variables
-                            _blockDataService.UniqueVars = _graphDataService.UniqueVars;
                             _dataChannel = new UartDataChannel( // Set data channel to UART
-                                new UARTSerialReader(), comPort, baudRate, dataSize, _graphDataService.GraphData
+                                new UARTSerialReader(), comPort, baudRate, dataSize, ticksPerSecond,
+                                _graphDataService.GraphData
                             );
+                            StartSession(msg); // Record from the first sample, if requested.
                             _dataChannel.Connect();
                             _graphDataService.SetFullHistory(false); // Allow progressive plotting.
-                            _uiUpdateTimer.Start(); // Start UI updates
+                            _renderScheduler.Start(); // Start UI updates
                             MessageBus.Current.SendMessage("UARTConnected"); // Indicate success
                         }
                         catch (Exception e)
                         {
+                            EndSession();
                             MessageBus.Current.SendMessage($"UARTError: {e.Message}");
                         }
                     }
@@ -198,7 +300,7 @@ namespace RealtimePlottingApp.ViewModels
                     {
                         _dataChannel?.Disconnect();
                         MessageBus.Current.SendMessage("UARTDisconnected");
-                        _graphDataService.SetFullHistory(true);
+                        EnterHistoryMode();
                     }
                     catch (Exception e)
                     {
@@ -215,30 +317,34 @@ namespace RealtimePlottingApp.ViewModels
                         try
                         {
                             _dataChannel?.Disconnect(); // Ensure no channel exists for any medium
+                            EndSession();
                             _triggerService.ResetTrigger();
                             _graphDataService.ClearData(); // Clear graph data to plot new connection's data
                             
+                            // Compile the mask(s) once, rather than parsing them for every frame.
+                            Dictionary<uint, CanPayloadPlan> canRoutes =
+                                _configParser.ParseCanRoutes(canIdFilter, canDataPayloadMask);
+
                             _dataChannel = new CanDataChannel( // Set Data Channel to CAN
                                 ControllerAreaNetwork.Create(), canInterface,
                                 // On Linux bitrate is not set via gui, but socketcan.
                                 OperatingSystem.IsWindows() ? bitRate : null, 
-                                canIdFilter, canDataPayloadMask, _graphDataService.GraphData
+                                canRoutes, _graphDataService.GraphData
                             );
                             
-                            // Extract digits from mask to a Set to find out how many unique variables there are.
-                            _graphDataService.UniqueVars = new HashSet<char>(
-                                canDataPayloadMask.Where(c => char.IsDigit(c))
-                            ).Count;
-                            _blockDataService.UniqueVars = _graphDataService.UniqueVars;
+                            // Each mask's variables are numbered after the previous mask's.
+                            _graphDataService.UniqueVars = canRoutes.Values.Sum(plan => plan.VariableCount);
                             
+                            StartSession(msg); // Record from the first sample, if requested.
                             _dataChannel.Connect();
 
                             _graphDataService.SetFullHistory(false); // Allow progressive plotting.
-                            _uiUpdateTimer.Start(); // Start UI updates
+                            _renderScheduler.Start(); // Start UI updates
                             MessageBus.Current.SendMessage("CANConnected"); // Indicate success
                         }
                         catch (Exception e)
                         {
+                            EndSession();
                             MessageBus.Current.SendMessage($"CANError: {e.Message}");
                         }
                     }
@@ -251,7 +357,7 @@ namespace RealtimePlottingApp.ViewModels
                     {
                         _dataChannel?.Disconnect();
                         MessageBus.Current.SendMessage("CANDisconnected");
-                        _graphDataService.SetFullHistory(true);
+                        EnterHistoryMode();
                     }
                     catch (Exception e)
                     {
@@ -259,12 +365,84 @@ namespace RealtimePlottingApp.ViewModels
                     }
                 }
                 
+                // Try to parse replay config. If parsing goes well, replay the capture file.
+                else if (msg.StartsWith("ConnectReplay:"))
+                {
+                    if (_configParser.ParseReplayConfig(msg, out string filePath, out double speed))
+                    {
+                        try
+                        {
+                            _dataChannel?.Disconnect(); // Ensure no channel exists for any medium
+                            EndSession();
+                            _triggerService.ResetTrigger();
+                            _graphDataService.ClearData(); // Clear graph data to plot the replayed data
+                            _blockDataService.ClearData();
+
+                            ReplayDataChannel replay = new ReplayDataChannel(
+                                filePath, speed, _graphDataService.GraphData);
+                            replay.ReplayCompleted += (_, _) => MessageBus.Current.SendMessage("ReplayCompleted");
+                            _dataChannel = replay;
+
+                            // Restore the recorded session's variables, the channel restores its timebase.
+                            _graphDataService.UniqueVars = replay.Header.VariableCount;
+
+                            _dataChannel.Connect();
+                            _graphDataService.SetFullHistory(false); // Allow progressive plotting.
+                            _renderScheduler.Start(); // Start UI updates
+                            MessageBus.Current.SendMessage($"ReplayConnected:UniqueVars:{replay.Header.VariableCount}");
+                        }
+                        catch (Exception e)
+                        {
+                            MessageBus.Current.SendMessage($"ReplayError: {e.Message}");
+                        }
+                    }
+                }
+
+                // Message telling us to stop replaying, or that the replay has reached the end.
+                else if (msg.Equals("DisconnectReplay") || msg.Equals("ReplayCompleted"))
+                {
+                    try
+                    {
+                        if (_dataChannel is ReplayDataChannel)
+                        {
+                            _dataChannel.Disconnect();
+                            MessageBus.Current.SendMessage("ReplayDisconnected");
+                            EnterHistoryMode();
+                        }
+                    }
+                    catch (Exception e)
+                    {
+                        MessageBus.Current.SendMessage($"ReplayError: {e.Message}");
+                    }
+                }
+
+                // Record the current (or else the next) session to a capture file.
+                else if (msg.StartsWith("StartCapture:"))
+                {
+                    StopCapture();
+                    _capturePath = msg[13..];
+                    if (_sessionConfig != null)
+                        StartCapture();
+                }
+
+                else if (msg.Equals("StopCapture"))
+                {
+                    StopCapture();
+                }
+
+                // The live session has ended, which also ends its capture.
+                else if (msg.Equals("UARTDisconnected") || msg.Equals("CANDisconnected"))
+                {
+                    EndSession();
+                }
+
                 // Toggle Graph 1 (LineGraph)
                 else if (msg.Equals("ToggleLineGraph"))
                 {
                     _plot1Visible = !_plot1Visible;
                     this.RaisePropertyChanged(nameof(Plot1Visible));
                     this.RaisePropertyChanged(nameof(Row1Height));
+                    _renderScheduler.Invalidate(_linePlotFrame);
                 }
                 
                 // Toggle Graph 2 (BlockDiagram)
@@ -273,20 +451,62 @@ namespace RealtimePlottingApp.ViewModels
                     _plot2Visible = !_plot2Visible;
                     this.RaisePropertyChanged(nameof(Plot2Visible));
                     this.RaisePropertyChanged(nameof(Row2Height));
+                    _renderScheduler.Invalidate(_blockPlotFrame);
                 }
                 
                 else if (msg.StartsWith("updateFrequency:"))
                 {
-                    // Change the UI timer's update interval on request.
+                    // Change the minimum interval between UI updates (in ms) on request.
                     // Substring the value following `:`
-                    _uiUpdateTimer.Interval = Convert.ToDouble(msg[16..]);
+                    _renderScheduler.TargetFps = 1000 / Convert.ToDouble(msg[16..]);
                 }
                 
-                else if (msg.StartsWith("variableAmount:"))
+                else if (msg.StartsWith("retention:"))
                 {
-                    // Change the WindowWidth on request.
+                    // Change how much history the data model keeps on request.
+                    // Substring the policy following `:`
+                    try
+                    {
+                        RetentionPolicy policy = RetentionPolicy.Parse(msg[10..]);
+                        lock (_graphDataService.GraphData)
+                        {
+                            _graphDataService.GraphData.Retention = policy;
+                        }
+                    }
+                    catch (FormatException e)
+                    {
+                        Console.WriteLine(e.Message);
+                    }
+                }
+                
+                else if (msg.StartsWith("triggerHysteresis:"))
+                {
+                    // Change the trigger hysteresis on request.
+                    // Substring the value following `:`
+                    _triggerService.Hysteresis = Convert.ToDouble(msg[18..], CultureInfo.InvariantCulture);
+                }
+                
+                else if (msg.StartsWith("preTrigger:"))
+                {
+                    // Change the number of samples captured before a trigger on request.
                     // Substring the value following `:`
-                    _graphDataService.WindowWidth = Convert.ToInt32(msg[15..]);
+                    _triggerService.PreTriggerSamples = Convert.ToInt32(msg[11..]);
+                    _graphDataService.PreTriggerSamples = _triggerService.PreTriggerSamples;
+                }
+                
+                else if (msg.StartsWith("postTrigger:"))
+                {
+                    // Change the number of samples captured after a trigger on request.
+                    // Substring the value following `:`
+                    _triggerService.PostTriggerSamples = Convert.ToInt32(msg[12..]);
+                    _graphDataService.PostTriggerSamples = _triggerService.PostTriggerSamples;
+                }
+                
+                else if (msg.StartsWith("windowWidth:"))
+                {
+                    // Change the WindowWidth (in seconds) on request.
+                    // Substring the value following `:`
+                    _graphDataService.WindowWidth = Convert.ToDouble(msg[12..], CultureInfo.InvariantCulture);
                     _plotUiService.WindowWidth = _graphDataService.WindowWidth;
                 }
             });
@@ -320,17 +540,11 @@ namespace RealtimePlottingApp.ViewModels
                     // Define local function to handle property changes.
                     void Variable_PropertyChanged(object? sender, System.ComponentModel.PropertyChangedEventArgs e)
                     {
-                        if ((_graphDataService.IsFullHistory || _triggerService.PlotTriggerView) &&
-                            e.PropertyName == nameof(IVariableModel.IsChecked) || 
+                        if (e.PropertyName == nameof(IVariableModel.IsChecked) || 
                             e.PropertyName == nameof(IVariableModel.Name))
                         {
-                            // Request a UI update if a variable property changes in history mode,
-                            // since the active UI timer could be off and not handle it.
-                            Dispatcher.UIThread.InvokeAsync(() =>
-                            {
-                                UpdateLinePlot(null, null);
-                                UpdateBlockPlot(null, null);
-                            });
+                            // Request a UI update, since no new data might arrive to cause one (e.g. in history mode).
+                            _renderScheduler.Invalidate();
                         }
                     }
                 });
@@ -339,15 +553,15 @@ namespace RealtimePlottingApp.ViewModels
             MessageBus.Current.Listen<bool>("TrigChecked").Subscribe(trigEnabled =>
             {
                 // Only look for trigger occurances from here on forward.
-                _triggerService.EnableTrigger(_graphDataService.GraphData.XData.Count);
-                _plotUiService.SetTriggerLevel(_graphDataService.GraphData, true, 
+                _triggerService.EnableTrigger();
+                _plotUiService.SetTriggerLevel(_statisticsService, true, 
                     10, "Trigger", trigEnabled);
             });
             
             // Receive notice whenever trigger level is moved manually by mouse dragging.
             MessageBus.Current.Listen<string>("TriggerUpdate").Subscribe(_ =>
             {
-                _triggerService.OnTriggerMoved(_graphDataService.GraphData.XData.Count);
+                _triggerService.OnTriggerMoved();
             });
             
             // Receive notice whenever trigger mode has been updated:
@@ -360,6 +574,18 @@ namespace RealtimePlottingApp.ViewModels
                     _ => _triggerService.Mode // No change.
                 };
             });
+            
+            // Receive notice whenever trigger edge has been updated:
+            MessageBus.Current.Listen<string>("SelectedTriggerEdge").Subscribe(newEdge =>
+            {
+                _triggerService.Edge = newEdge switch
+                {
+                    "Rising Edge" => TriggerEdge.Rising,
+                    "Falling Edge" => TriggerEdge.Falling,
+                    "Either Edge" => TriggerEdge.Either,
+                    _ => _triggerService.Edge // No change.
+                };
+            });
         }
         
     }
@@ -23,6 +23,12 @@ namespace RealtimePlottingApp.ViewModels
             ToggleSidebarCommand = ReactiveCommand.Create(ToggleSidebar);
             ToggleLineGraphCommand = ReactiveCommand.Create(ToggleLineGraph);
             ToggleBlockDiagramCommand = ReactiveCommand.Create(ToggleBlockDiagram);
+            StartCaptureCommand = ReactiveCommand.Create(StartCapture);
+            StopCaptureCommand = ReactiveCommand.Create(StopCapture);
+            ReplayCaptureCommand = ReactiveCommand.Create<string>(ReplayCapture);
+            StopReplayCommand = ReactiveCommand.Create(StopReplay);
+            StartMetricsRecordingCommand = ReactiveCommand.Create(StartMetricsRecording);
+            StopMetricsRecordingCommand = ReactiveCommand.Create(StopMetricsRecording);
         }
         
         // Alternate constructor to pass a storageProvider
@@ -37,6 +43,12 @@ namespace RealtimePlottingApp.ViewModels
             ToggleSidebarCommand = ReactiveCommand.Create(ToggleSidebar);
             ToggleLineGraphCommand = ReactiveCommand.Create(ToggleLineGraph);
             ToggleBlockDiagramCommand = ReactiveCommand.Create(ToggleBlockDiagram);
+            StartCaptureCommand = ReactiveCommand.Create(StartCapture);
+            StopCaptureCommand = ReactiveCommand.Create(StopCapture);
+            ReplayCaptureCommand = ReactiveCommand.Create<string>(ReplayCapture);
+            StopReplayCommand = ReactiveCommand.Create(StopReplay);
+            StartMetricsRecordingCommand = ReactiveCommand.Create(StartMetricsRecording);
+            StopMetricsRecordingCommand = ReactiveCommand.Create(StopMetricsRecording);
         }
         
         // ICommand properties for data binding.
@@ -45,6 +57,16 @@ namespace RealtimePlottingApp.ViewModels
         public ICommand ToggleSidebarCommand { get; }
         public ICommand ToggleLineGraphCommand { get; }
         public ICommand ToggleBlockDiagramCommand { get; }
+        public ICommand StartCaptureCommand { get; }
+        public ICommand StopCaptureCommand { get; }
+        public ICommand ReplayCaptureCommand { get; }
+        public ICommand StopReplayCommand { get; }
+        public ICommand StartMetricsRecordingCommand { get; }
+        public ICommand StopMetricsRecordingCommand { get; }
+
+        // File type of capture files, for the file pickers.
+        private static readonly FilePickerFileType CaptureFileType = new("Capture Files") { Patterns = ["*.rpcap"] };
+        private static readonly FilePickerFileType CsvFileType = new("CSV Files") { Patterns = ["*.csv"] };
 
         // ==================== SAVECONFIG ==================== //
         
@@ -150,6 +172,114 @@ namespace RealtimePlottingApp.ViewModels
             }
         }
         
+        // ==================== STARTCAPTURE ==================== //
+        
+        // Command handler for recording the current, or next, session to a capture file.
+        private async void StartCapture()
+        {
+            try
+            {
+                string filePath = "capture.rpcap"; // Fallback
+                if (_storageProvider != null)
+                {
+                    // Open a save-file picker
+                    IStorageFile? file = await _storageProvider.SaveFilePickerAsync(new FilePickerSaveOptions
+                    {
+                        Title = "Record Capture File",
+                        DefaultExtension = "rpcap",
+                        FileTypeChoices = new List<FilePickerFileType> { CaptureFileType }
+                    });
+
+                    string? path = file?.TryGetLocalPath();
+                    if (path == null) return; // Operation cancelled by user
+                    filePath = path;
+                }
+
+                MessageBus.Current.SendMessage($"StartCapture:{filePath}");
+            }
+            catch (Exception e)
+            {
+                Console.WriteLine(e.Message);
+            }
+        }
+
+        // Command handler for finishing the capture file being recorded.
+        private void StopCapture()
+        {
+            MessageBus.Current.SendMessage("StopCapture");
+        }
+        
+        // ==================== REPLAYCAPTURE ==================== //
+        
+        // Command handler for replaying a capture file, at a multiple of real time or "max" speed.
+        private async void ReplayCapture(string speed)
+        {
+            try
+            {
+                if (_storageProvider == null) return; // Nothing sensible to fall back to.
+
+                // Open a load-file picker
+                IReadOnlyList<IStorageFile> files = await _storageProvider.OpenFilePickerAsync(new FilePickerOpenOptions
+                {
+                    Title = "Replay Capture File",
+                    AllowMultiple = false,  // Only allow selecting ONE file
+                    FileTypeFilter = new List<FilePickerFileType> { CaptureFileType }
+                });
+
+                string? filePath = files.Count > 0 ? files[0].TryGetLocalPath() : null;
+                if (filePath == null) return; // Operation is cancelled by user
+
+                MessageBus.Current.SendMessage($"ConnectReplay:Speed:{speed},File:{filePath}");
+            }
+            catch (Exception e)
+            {
+                Console.WriteLine(e.Message);
+            }
+        }
+
+        // Command handler for stopping a replay.
+        private void StopReplay()
+        {
+            MessageBus.Current.SendMessage("DisconnectReplay");
+        }
+        
+        // ==================== RECORDMETRICS ==================== //
+        
+        // Command handler for recording the pipeline metrics to a CSV file.
+        private async void StartMetricsRecording()
+        {
+            try
+            {
+                string filePath = "metrics.csv"; // Fallback
+                if (_storageProvider != null)
+                {
+                    // Open a save-file picker
+                    IStorageFile? file = await _storageProvider.SaveFilePickerAsync(new FilePickerSaveOptions
+                    {
+                        Title = "Record Metrics",
+                        DefaultExtension = "csv",
+                        FileTypeChoices = new List<FilePickerFileType> { CsvFileType }
+                    });
+
+                    string? path = file?.TryGetLocalPath();
+                    if (path == null) return; // Operation cancelled by user
+                    filePath = path;
+                }
+
+                MessageBus.Current.SendMessage($"StartMetricsRecording:{filePath}");
+            }
+            catch (Exception e)
+            {
+                Console.WriteLine(e.Message);
+            }
+        }
+
+        // Command handler for finishing the metrics file being recorded.
+        private void StopMetricsRecording()
+        {
+            MessageBus.Current.SendMessage("StopMetricsRecording");
+        }
+        
         // ==================== TOGGLESIDEBAR ==================== //
         
         // Command handler for toggling the sidebar.
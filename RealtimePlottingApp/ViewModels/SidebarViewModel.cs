@@ -2,6 +2,7 @@
 using System;
 using System.Collections.Generic;
 using System.Collections.ObjectModel;
+using System.Globalization;
 using System.Linq;
 using System.Runtime.InteropServices;
 using System.Text.RegularExpressions;
@@ -55,7 +56,7 @@ namespace RealtimePlottingApp.ViewModels
         public bool IsConnectReady => 
         (
             // Check UART has valid inputs, if selected.
-            (IsUartSelected && (IsValidComPortFormat(_comPortInput)) && (_baudRateInput > 0)) 
+            (IsUartSelected && (IsValidComPortFormat(_comPortInput)) && (_baudRateInput > 0) && (_timestampRateInput > 0)) 
                 ||
             // Check CAN has valid inputs, if selected.
             (IsCanSelected && _canInterfaceInput?.Length > 0 && _canIdFilter is > 0
@@ -79,20 +80,51 @@ namespace RealtimePlottingApp.ViewModels
             }
         }
 
-        // Variable Amount Slider.
-        private int? _variableAmountSlider = 75;
+        // Window Width Slider, the seconds of data to show.
+        private double? _windowWidthSlider = 5;
 
-        public int? VariableAmountSlider
+        public double? WindowWidthSlider
         {
-            get => _variableAmountSlider;
+            get => _windowWidthSlider;
             set
             {
-                if (value == null) return;
-                this.RaiseAndSetIfChanged(ref _variableAmountSlider, value);
-                MessageBus.Current.SendMessage($"variableAmount:{_variableAmountSlider}");
+                if (value is not > 0) return;
+                this.RaiseAndSetIfChanged(ref _windowWidthSlider, value);
+                MessageBus.Current.SendMessage(
+                    $"windowWidth:{_windowWidthSlider.Value.ToString(CultureInfo.InvariantCulture)}");
             }
         }
 
+        // History retention policy dropdown & limit input
+        private int _retentionModeDropdownIndex; // Unlimited default
+        
+        public int RetentionModeDropdownIndex
+        {
+            get => _retentionModeDropdownIndex;
+            set
+            {
+                this.RaiseAndSetIfChanged(ref _retentionModeDropdownIndex, value);
+                this.RaisePropertyChanged(nameof(RetentionLimitEnabled));
+                SendRetentionPolicy();
+            }
+        }
+        
+        private int? _retentionLimit = 100000;
+        
+        public int? RetentionLimit
+        {
+            get => _retentionLimit;
+            set
+            {
+                if (value == null) return;
+                this.RaiseAndSetIfChanged(ref _retentionLimit, value);
+                SendRetentionPolicy();
+            }
+        }
+        
+        // A limit is only meaningful for bounded policies.
+        public bool RetentionLimitEnabled => _retentionModeDropdownIndex != 0;
+        
         // Trigger Level enable checkbox
         private bool _trigChecked; // false default
 
@@ -133,6 +165,70 @@ namespace RealtimePlottingApp.ViewModels
             }
         }
         
+        // Trigger Edge combobox dropdown
+        private ComboBoxItem? _selectedTriggerEdge;
+
+        public ComboBoxItem? SelectedTriggerEdge
+        {
+            get => _selectedTriggerEdge;
+            set
+            {
+                // Update the value and send the new trigger edge on the bus as a string.
+                this.RaiseAndSetIfChanged(ref _selectedTriggerEdge, value);
+                MessageBus.Current.SendMessage(_selectedTriggerEdge?.Content?.ToString(),
+                    "SelectedTriggerEdge");
+            }
+        }
+        
+        private int _triggerEdgeDropdownIndex; // Rising edge default
+
+        public int TriggerEdgeDropdownIndex
+        {
+            get => _triggerEdgeDropdownIndex;
+            set => this.RaiseAndSetIfChanged(ref _triggerEdgeDropdownIndex, value);
+        }
+        
+        // Trigger hysteresis & pre/post-trigger sample inputs
+        private double? _triggerHysteresis = 0;
+
+        public double? TriggerHysteresis
+        {
+            get => _triggerHysteresis;
+            set
+            {
+                if (value == null) return;
+                this.RaiseAndSetIfChanged(ref _triggerHysteresis, value);
+                MessageBus.Current.SendMessage(
+                    $"triggerHysteresis:{_triggerHysteresis.Value.ToString(CultureInfo.InvariantCulture)}");
+            }
+        }
+        
+        private int? _preTriggerSamples = 0;
+
+        public int? PreTriggerSamples
+        {
+            get => _preTriggerSamples;
+            set
+            {
+                if (value == null) return;
+                this.RaiseAndSetIfChanged(ref _preTriggerSamples, value);
+                MessageBus.Current.SendMessage($"preTrigger:{_preTriggerSamples}");
+            }
+        }
+        
+        private int? _postTriggerSamples = 1000;
+
+        public int? PostTriggerSamples
+        {
+            get => _postTriggerSamples;
+            set
+            {
+                if (value == null) return;
+                this.RaiseAndSetIfChanged(ref _postTriggerSamples, value);
+                MessageBus.Current.SendMessage($"postTrigger:{_postTriggerSamples}");
+            }
+        }
+        
         // ========== CAN Data Bindings ========== //
         // CAN-Interface Input
         private string? _canInterfaceInput = "";
@@ -276,6 +372,20 @@ namespace RealtimePlottingApp.ViewModels
             }
         }
         
+        // Timestamp rate Input, the ticks per second of the sender's timestamp timer.
+        private double? _timestampRateInput = 1000;
+
+        public double? TimestampRateInput
+        {
+            get => _timestampRateInput;
+            set
+            {
+                // Allow the input field to be empty, but don't allow IsConnectReady to be true then.
+                this.RaiseAndSetIfChanged(ref _timestampRateInput, value);
+                this.RaisePropertyChanged(nameof(IsConnectReady));
+            }
+        }
+        
         // ========== CommInterface-independent Data Bindings ========== //
         // ConnectButton text
         private string _connectButtonText = "Connect";
@@ -306,7 +416,8 @@ namespace RealtimePlottingApp.ViewModels
             {
                 MessageBus.Current.SendMessage(
                     !_isConnected
-                        ? $"ConnectUart:ComPort:{_comPortInput},BaudRate:{_baudRateInput},DataSize:{_selectedDataSize?.Content},UniqueVars:{_uniqueVariableCount}"
+                        ? string.Create(CultureInfo.InvariantCulture,
+                            $"ConnectUart:ComPort:{_comPortInput},BaudRate:{_baudRateInput},DataSize:{_selectedDataSize?.Content},UniqueVars:{_uniqueVariableCount},TickRate:{_timestampRateInput}")
                         : "DisconnectUart");
             }
             else if (IsCanSelected)
@@ -330,6 +441,20 @@ namespace RealtimePlottingApp.ViewModels
         }
         
         // ---------- Private Helper Methods ---------- //
+        // Helper method to send the selected retention policy on the message bus, in the dropdown's order.
+        private void SendRetentionPolicy()
+        {
+            long limit = _retentionLimit ?? 0;
+            RetentionPolicy policy = _retentionModeDropdownIndex switch
+            {
+                1 => RetentionPolicy.LastSamples(limit),
+                2 => RetentionPolicy.LastSeconds(limit),
+                3 => RetentionPolicy.MemoryBudget(limit * 1024 * 1024), // Input is in megabytes
+                _ => RetentionPolicy.Unlimited
+            };
+            MessageBus.Current.SendMessage($"retention:{policy}");
+        }
+        
         // Helper method to validate COM-Port input format (Windows and Linux)
         private static bool IsValidComPortFormat(string? input)
         {
@@ -399,6 +524,17 @@ namespace RealtimePlottingApp.ViewModels
                     MessageBus.Current.SendMessage(Variables, "VariableList");
                 }
                 
+                // Replaying a capture, list the variables that were recorded.
+                else if (msg.StartsWith("ReplayConnected:UniqueVars:"))
+                {
+                    ObservableCollection<IVariableModel> newList = [];
+                    for (int i = 0; i < int.Parse(msg[27..]); i++)
+                        newList.Add(new VariableModel { Name = $"Var {i+1}" });
+
+                    Variables = newList;
+                    MessageBus.Current.SendMessage(Variables, "VariableList");
+                }
+                
                 // Disconnect successful, enable "Connect" button.
                 else if (msg.Equals("UARTDisconnected") || msg.Equals("CANDisconnected"))
                 {
@@ -427,6 +563,15 @@ namespace RealtimePlottingApp.ViewModels
                 ConfigManager.AddToConfig("BaudRate", BaudRateInput);
                 ConfigManager.AddToConfig("UniqueVars", UniqueVariableCount);
                 ConfigManager.AddToConfig("PayloadDataSize", DataSizeDropdownIndex);
+                ConfigManager.AddToConfig("TimestampRate", TimestampRateInput);
+                
+                // Save Plot Configuration:
+                ConfigManager.AddToConfig("RetentionMode", RetentionModeDropdownIndex);
+                ConfigManager.AddToConfig("RetentionLimit", RetentionLimit);
+                ConfigManager.AddToConfig("TriggerEdge", TriggerEdgeDropdownIndex);
+                ConfigManager.AddToConfig("TriggerHysteresis", TriggerHysteresis);
+                ConfigManager.AddToConfig("PreTriggerSamples", PreTriggerSamples);
+                ConfigManager.AddToConfig("PostTriggerSamples", PostTriggerSamples);
             });
             
             MessageBus.Current.Listen<string>("LoadConfigRequest").Subscribe(_ =>
@@ -508,6 +653,39 @@ namespace RealtimePlottingApp.ViewModels
                 {
                     Console.WriteLine($"Error loading Payload data size: {e.Message}");
                 }
+                
+                try
+                {
+                    // Configurations saved before the rate was configurable keep the default.
+                    TimestampRateInput = ConfigManager.LoadConfig<double?>("TimestampRate") ?? 1000;
+                }
+                catch (Exception e)
+                {
+                    Console.WriteLine($"Error loading Timestamp rate: {e.Message}");
+                }
+                
+                // Load Plot Configuration:
+                try
+                {
+                    RetentionLimit = ConfigManager.LoadConfig<int?>("RetentionLimit");
+                    RetentionModeDropdownIndex = ConfigManager.LoadConfig<int>("RetentionMode");
+                }
+                catch (Exception e)
+                {
+                    Console.WriteLine($"Error loading History retention: {e.Message}");
+                }
+                
+                try
+                {
+                    TriggerEdgeDropdownIndex = ConfigManager.LoadConfig<int>("TriggerEdge");
+                    TriggerHysteresis = ConfigManager.LoadConfig<double?>("TriggerHysteresis");
+                    PreTriggerSamples = ConfigManager.LoadConfig<int?>("PreTriggerSamples");
+                    PostTriggerSamples = ConfigManager.LoadConfig<int?>("PostTriggerSamples");
+                }
+                catch (Exception e)
+                {
+                    Console.WriteLine($"Error loading Trigger configuration: {e.Message}");
+                }
             });
         }
         
@@ -0,0 +1,107 @@
+/**********************************************************************************************************************
+ * Host-side mock of the STM32F4 LL DMA driver, for building and benchmarking the UART library on a PC.
+ *
+ * Only the functions used by uart.c are provided. An enabled stream does nothing until the test calls
+ * MockDMA_Complete(), which performs the whole memory to USART transfer at once, like the hardware
+ * would over time, and leaves it to the caller to invoke the transfer complete callback.
+ **********************************************************************************************************************/
+
+#ifndef __STM32F4xx_LL_DMA_H
+#define __STM32F4xx_LL_DMA_H
+
+#include <stdint.h>
+#include "stm32f4xx_ll_usart.h"
+
+typedef struct {
+    uintptr_t memoryAddress;
+    uintptr_t periphAddress;
+    uint32_t length;
+    uint32_t enabled;
+    uint32_t transfers;         // Transfers started on this stream
+} MockDMA_Stream;
+
+typedef struct {
+    MockDMA_Stream streams[8];
+} DMA_TypeDef;
+
+#define LL_DMA_STREAM_0 0U
+#define LL_DMA_STREAM_1 1U
+#define LL_DMA_STREAM_2 2U
+#define LL_DMA_STREAM_3 3U
+#define LL_DMA_STREAM_4 4U
+#define LL_DMA_STREAM_5 5U
+#define LL_DMA_STREAM_6 6U
+#define LL_DMA_STREAM_7 7U
+
+#define LL_DMA_DIRECTION_MEMORY_TO_PERIPH 1U
+#define LL_DMA_MEMORY_INCREMENT           1U
+#define LL_DMA_PERIPH_NOINCREMENT         0U
+#define LL_DMA_MDATAALIGN_BYTE            0U
+#define LL_DMA_PDATAALIGN_BYTE            0U
+
+/**********************************************************************************************************************
+* Mock control
+**********************************************************************************************************************/
+
+// Performs the enabled transfer of a stream into its USART, then disables the stream.
+// Returns 0 if the stream had no transfer in progress.
+static inline int MockDMA_Complete(DMA_TypeDef *DMAx, uint32_t Stream) {
+    MockDMA_Stream *stream = &DMAx->streams[Stream];
+    if (!stream->enabled)
+        return 0;
+
+    // The peripheral address is the USART's data register, which is the mocked USART's first member.
+    USART_TypeDef *usart = (USART_TypeDef *)stream->periphAddress;
+    const uint8_t *memory = (const uint8_t *)stream->memoryAddress;
+    for (uint32_t i = 0; i < stream->length; i++)
+        MockUSART_Transmit(usart, memory[i]);
+
+    stream->length = 0;
+    stream->enabled = 0;
+    return 1;
+}
+
+/**********************************************************************************************************************
+* LL API
+**********************************************************************************************************************/
+
+static inline void LL_DMA_SetDataTransferDirection(DMA_TypeDef *DMAx, uint32_t Stream, uint32_t Direction) {
+    (void)DMAx; (void)Stream; (void)Direction;
+}
+static inline void LL_DMA_SetMemoryIncMode(DMA_TypeDef *DMAx, uint32_t Stream, uint32_t IncMode) {
+    (void)DMAx; (void)Stream; (void)IncMode;
+}
+static inline void LL_DMA_SetPeriphIncMode(DMA_TypeDef *DMAx, uint32_t Stream, uint32_t IncMode) {
+    (void)DMAx; (void)Stream; (void)IncMode;
+}
+static inline void LL_DMA_SetMemorySize(DMA_TypeDef *DMAx, uint32_t Stream, uint32_t Size) {
+    (void)DMAx; (void)Stream; (void)Size;
+}
+static inline void LL_DMA_SetPeriphSize(DMA_TypeDef *DMAx, uint32_t Stream, uint32_t Size) {
+    (void)DMAx; (void)Stream; (void)Size;
+}
+static inline void LL_DMA_EnableIT_TC(DMA_TypeDef *DMAx, uint32_t Stream) { (void)DMAx; (void)Stream; }
+
+// Addresses are pointer-sized on the host, where they don't fit the target's 32 bits.
+static inline void LL_DMA_SetMemoryAddress(DMA_TypeDef *DMAx, uint32_t Stream, uintptr_t MemoryAddress) {
+    DMAx->streams[Stream].memoryAddress = MemoryAddress;
+}
+static inline void LL_DMA_SetPeriphAddress(DMA_TypeDef *DMAx, uint32_t Stream, uintptr_t PeriphAddress) {
+    DMAx->streams[Stream].periphAddress = PeriphAddress;
+}
+static inline void LL_DMA_SetDataLength(DMA_TypeDef *DMAx, uint32_t Stream, uint32_t NbData) {
+    DMAx->streams[Stream].length = NbData;
+}
+
+static inline void LL_DMA_EnableStream(DMA_TypeDef *DMAx, uint32_t Stream) {
+    DMAx->streams[Stream].enabled = 1;
+    DMAx->streams[Stream].transfers++;
+}
+static inline void LL_DMA_DisableStream(DMA_TypeDef *DMAx, uint32_t Stream) {
+    DMAx->streams[Stream].enabled = 0;
+}
+static inline uint32_t LL_DMA_IsEnabledStream(DMA_TypeDef *DMAx, uint32_t Stream) {
+    return DMAx->streams[Stream].enabled;
+}
+
+#endif //__STM32F4xx_LL_DMA_H
@@ -0,0 +1,84 @@
+/**********************************************************************************************************************
+ * Host-side mock of the STM32F4 LL USART driver, for building and benchmarking the UART library on a PC.
+ *
+ * Only the functions used by uart.c are provided. A mocked USART transmits into a caller-provided byte sink
+ * rather than a wire, is always ready to transmit, and receives command bytes queued with MockUSART_Receive().
+ **********************************************************************************************************************/
+
+#ifndef __STM32F4xx_LL_USART_H
+#define __STM32F4xx_LL_USART_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef struct {
+    volatile uint32_t DR;       // Data register, first so that its address is the USART's (see LL_USART_DMA_GetRegAddr)
+
+    uint8_t *txSink;            // Where transmitted bytes end up, NULL to discard them
+    size_t txCapacity;          // Size of txSink
+    size_t txCount;             // Bytes transmitted since the sink was set
+
+    uint8_t rxData[16];         // Received bytes not read yet
+    uint8_t rxHead, rxTail;
+} USART_TypeDef;
+
+#define LL_USART_DATAWIDTH_8B   0U
+#define LL_USART_PARITY_NONE    0U
+
+/**********************************************************************************************************************
+* Mock control
+**********************************************************************************************************************/
+
+static inline void MockUSART_SetSink(USART_TypeDef *USARTx, uint8_t *sink, size_t capacity) {
+    USARTx->txSink = sink;
+    USARTx->txCapacity = capacity;
+    USARTx->txCount = 0;
+}
+
+// Called for every byte leaving the USART, by the CPU or by DMA.
+static inline void MockUSART_Transmit(USART_TypeDef *USARTx, uint8_t value) {
+    if (USARTx->txSink != NULL && USARTx->txCount < USARTx->txCapacity)
+        USARTx->txSink[USARTx->txCount] = value;
+    USARTx->txCount++;
+}
+
+// Queues a byte as if it was received from the host application, such as an 'S' or 'R' command.
+static inline void MockUSART_Receive(USART_TypeDef *USARTx, uint8_t value) {
+    USARTx->rxData[USARTx->rxHead] = value;
+    USARTx->rxHead = (uint8_t)((USARTx->rxHead + 1) % sizeof(USARTx->rxData));
+}
+
+/**********************************************************************************************************************
+* LL API
+**********************************************************************************************************************/
+
+static inline void LL_USART_SetDataWidth(USART_TypeDef *USARTx, uint32_t DataWidth) { (void)USARTx; (void)DataWidth; }
+static inline void LL_USART_SetParity(USART_TypeDef *USARTx, uint32_t Parity) { (void)USARTx; (void)Parity; }
+static inline void LL_USART_Enable(USART_TypeDef *USARTx) { (void)USARTx; }
+static inline void LL_USART_EnableDMAReq_TX(USART_TypeDef *USARTx) { (void)USARTx; }
+static inline void LL_USART_ClearFlag_TC(USART_TypeDef *USARTx) { (void)USARTx; }
+
+static inline uint32_t LL_USART_IsActiveFlag_TXE(USART_TypeDef *USARTx) { (void)USARTx; return 1; }
+static inline uint32_t LL_USART_IsActiveFlag_TC(USART_TypeDef *USARTx) { (void)USARTx; return 1; }
+
+static inline uint32_t LL_USART_IsActiveFlag_RXNE(USART_TypeDef *USARTx) {
+    return USARTx->rxHead != USARTx->rxTail;
+}
+
+static inline uint8_t LL_USART_ReceiveData8(USART_TypeDef *USARTx) {
+    uint8_t value = USARTx->rxData[USARTx->rxTail];
+    USARTx->rxTail = (uint8_t)((USARTx->rxTail + 1) % sizeof(USARTx->rxData));
+    return value;
+}
+
+static inline void LL_USART_TransmitData8(USART_TypeDef *USARTx, uint8_t Value) {
+    USARTx->DR = Value;
+    MockUSART_Transmit(USARTx, Value);
+}
+
+// Pointer-sized on the host, where addresses don't fit the target's 32 bits.
+static inline uintptr_t LL_USART_DMA_GetRegAddr(USART_TypeDef *USARTx) {
+    return (uintptr_t)&USARTx->DR;
+}
+
+#endif //__STM32F4xx_LL_USART_H
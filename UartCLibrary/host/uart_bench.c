@@ -0,0 +1,210 @@
+/**********************************************************************************************************************
+ * Host-side benchmark of the UART library, built against the mocked LL drivers (see Makefile).
+ *
+ * Stores and flushes packets the way a sampling main loop would, in both the blocking and the DMA transmit
+ * modes and with both the legacy and the framed protocol, measures the CPU time spent inside the library
+ * per packet, and checks that the bytes which reach the (mocked) wire decode back to the stored values.
+ * Finally fills the buffer without flushing, and checks that the dropped values are counted and reported.
+ *
+ * In blocking mode the mocked USART is always ready, so the time a real MCU spins on TXE/TC is not measured.
+ * It is estimated from the baud rate instead: every byte (10 bits on the wire) keeps the CPU waiting.
+ **********************************************************************************************************************/
+
+#define _POSIX_C_SOURCE 199309L // clock_gettime
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "uart.h"
+
+#define VARIABLES     4        // Values stored per store call, like sampling 4 signals at once
+#define ITERATIONS    1000000  // Store calls per mode
+#define BAUD_RATE     921600   // For estimating the wire time of blocking transmission
+
+static USART_TypeDef usart;
+static DMA_TypeDef dma;
+static uint32_t timestamp;
+static uint8_t wire[ITERATIONS * (VARIABLES * UART_PAYLOAD_32 + 3 + UART_FRAME_TIMESTAMP_BYTES)];
+
+static double nowNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// Runs the hardware side of a DMA transfer in progress, returns the time spent in the completion callback.
+static double completeTransfer(void) {
+    if (!MockDMA_Complete(&dma, LL_DMA_STREAM_3))
+        return 0;
+    double start = nowNs();
+    UART_DMA_TxCompleteCallback();
+    return nowNs() - start;
+}
+
+// Stores and flushes ITERATIONS x VARIABLES packets, returns the bytes that reached the wire.
+static size_t run(int useDma, int framed, UART_PayloadSize payloadSize) {
+    memset(&usart, 0, sizeof(usart));
+    memset(&dma, 0, sizeof(dma));
+    MockUSART_SetSink(&usart, wire, sizeof(wire));
+
+    if (useDma)
+        UART_InitDMA(&usart, &dma, LL_DMA_STREAM_3, &timestamp, payloadSize);
+    else
+        UART_Init(&usart, &timestamp, payloadSize);
+    MockUSART_Receive(&usart, framed ? 'F' : 'S'); // The host application starts the stream
+    UART_FlushBuffer(); // Commands are received when flushing
+
+    uint32_t values[VARIABLES];
+    uint32_t *pointers[VARIABLES];
+    for (int v = 0; v < VARIABLES; v++)
+        pointers[v] = &values[v];
+
+    size_t stored = 0; // Packets
+    double libraryNs = 0;
+    for (uint32_t i = 0; i < ITERATIONS; i++) {
+        timestamp = i;
+        for (int v = 0; v < VARIABLES; v++)
+            values[v] = i * VARIABLES + v;
+
+        double start = nowNs();
+        int ok = UART_StoreData(pointers, VARIABLES);
+        UART_FlushBuffer();
+        libraryNs += nowNs() - start;
+        if (ok)
+            stored += VARIABLES;
+
+        // The DMA stream finishes its transfer before the next sample (at most one transfer per sample).
+        if (useDma)
+            libraryNs += completeTransfer();
+    }
+    while (useDma && UART_IsTransmitting())
+        libraryNs += completeTransfer();
+
+    double bytesPerPacket = (double)usart.txCount / stored;
+    printf("%-8s %-6s %2d-bit: %5.2f bytes/packet, %6.1f ns/packet in library", useDma ? "DMA" : "blocking",
+           framed ? "framed" : "legacy", payloadSize * 8, bytesPerPacket, libraryNs / stored);
+    if (useDma)
+        printf(", %u transfers\n", dma.streams[LL_DMA_STREAM_3].transfers);
+    else
+        printf(" + %.0f ns/packet waiting for the wire at %d baud\n", bytesPerPacket * 10 * 1e9 / BAUD_RATE, BAUD_RATE);
+    return usart.txCount;
+}
+
+static void fail(const char *message, size_t index) {
+    printf("  %s %zu\n", message, index);
+    exit(1);
+}
+
+// Reads a big-endian value of the given number of bytes.
+static uint32_t readBigEndian(const uint8_t *bytes, int count) {
+    uint32_t value = 0;
+    for (int b = 0; b < count; b++)
+        value = (value << 8) | bytes[b];
+    return value;
+}
+
+// Bit by bit CRC-8 (polynomial 0x07), independent of the library's table-driven one.
+static uint8_t crc8(const uint8_t *bytes, size_t length) {
+    uint8_t crc = 0;
+    for (size_t i = 0; i < length; i++) {
+        crc ^= bytes[i];
+        for (int bit = 0; bit < 8; bit++)
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+    }
+    return crc;
+}
+
+// Checks that the transmitted legacy packets are the stored values, in order, with the low byte of their timestamp.
+static void verifyLegacy(size_t bytes, UART_PayloadSize payloadSize) {
+    uint32_t mask = payloadSize == UART_PAYLOAD_32 ? 0xFFFFFFFFu : (1u << (payloadSize * 8)) - 1;
+    size_t packets = bytes / (payloadSize + 1);
+    if (packets != ITERATIONS * VARIABLES)
+        fail("packets transmitted:", packets);
+
+    for (size_t p = 0; p < packets; p++) {
+        const uint8_t *packet = &wire[p * (payloadSize + 1)];
+        if (readBigEndian(packet, payloadSize) != ((uint32_t)p & mask) || packet[payloadSize] != (uint8_t)(p / VARIABLES))
+            fail("corrupt packet", p);
+    }
+}
+
+// Checks that one frame per store call was transmitted, holding its values, timestamp and a valid CRC.
+static void verifyFramed(size_t bytes, UART_PayloadSize payloadSize) {
+    uint32_t mask = payloadSize == UART_PAYLOAD_32 ? 0xFFFFFFFFu : (1u << (payloadSize * 8)) - 1;
+    uint32_t timestampMask = UART_FRAME_TIMESTAMP_BYTES == 4 ? 0xFFFFFFFFu : 0xFFFFu;
+    uint8_t sizeCode = payloadSize == UART_PAYLOAD_8 ? 0 : payloadSize == UART_PAYLOAD_16 ? 1 : 2;
+    size_t frameSize = 3 + UART_FRAME_TIMESTAMP_BYTES + VARIABLES * payloadSize;
+    if (bytes != (size_t)ITERATIONS * frameSize)
+        fail("bytes transmitted:", bytes);
+
+    for (size_t f = 0; f < ITERATIONS; f++) {
+        const uint8_t *frame = &wire[f * frameSize];
+        const uint8_t *payloads = &frame[2 + UART_FRAME_TIMESTAMP_BYTES];
+        if (frame[0] != UART_FRAME_SYNC || frame[frameSize - 1] != crc8(frame, frameSize - 1))
+            fail("corrupt frame", f);
+        if (frame[1] != ((VARIABLES - 1) | (sizeCode << 5) | ((UART_FRAME_TIMESTAMP_BYTES == 4) << 7)) ||
+            readBigEndian(&frame[2], UART_FRAME_TIMESTAMP_BYTES) != (f & timestampMask))
+            fail("wrong header or timestamp in frame", f);
+        for (int v = 0; v < VARIABLES; v++) {
+            if (readBigEndian(&payloads[v * payloadSize], payloadSize) != ((uint32_t)(f * VARIABLES + v) & mask))
+                fail("wrong value in frame", f);
+        }
+    }
+}
+
+// Stores without flushing until the buffer overflows, then checks the overrun count and its status frame.
+static void verifyOverruns(UART_PayloadSize payloadSize) {
+    const int frameSize = 3 + UART_FRAME_TIMESTAMP_BYTES + VARIABLES * payloadSize;
+    const int stores = 2 * UART_TX_BUFFER_SIZE / frameSize;
+    memset(&usart, 0, sizeof(usart));
+    MockUSART_SetSink(&usart, wire, sizeof(wire));
+    UART_Init(&usart, &timestamp, payloadSize);
+    MockUSART_Receive(&usart, 'F');
+    UART_FlushBuffer();
+
+    uint32_t values[VARIABLES] = { 0 };
+    uint32_t *pointers[VARIABLES];
+    for (int v = 0; v < VARIABLES; v++)
+        pointers[v] = &values[v];
+
+    int stored = 0;
+    for (int i = 0; i < stores; i++)
+        stored += UART_StoreData(pointers, VARIABLES);
+    uint32_t overruns = UART_GetOverrunCount();
+    if (overruns != (uint32_t)(stores - stored) * VARIABLES)
+        fail("overrun count", overruns);
+
+    // The status frame is sent ahead of the first frame stored once there is room again.
+    UART_FlushBuffer();
+    size_t before = usart.txCount;
+    UART_StoreData(pointers, VARIABLES);
+    UART_FlushBuffer();
+    const uint8_t *status = &wire[before];
+    if (usart.txCount - before != (size_t)(7 + frameSize) || status[0] != UART_FRAME_SYNC ||
+        status[1] != 0x60 || readBigEndian(&status[2], 4) != overruns || status[6] != crc8(status, 6))
+        fail("missing or corrupt status frame, bytes:", usart.txCount - before);
+
+    printf("overruns: %d of %d frames stored with %d bytes of buffer, %u values dropped and reported\n",
+           stored, stores, UART_TX_BUFFER_SIZE, overruns);
+}
+
+int main(void) {
+    const UART_PayloadSize sizes[] = { UART_PAYLOAD_8, UART_PAYLOAD_16, UART_PAYLOAD_32 };
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+#ifdef UART_FIXED_PAYLOAD_SIZE
+        if (sizes[s] != UART_FIXED_PAYLOAD_SIZE)
+            continue; // The library only handles its compile-time payload size
+#endif
+        for (int useDma = 0; useDma <= 1; useDma++) {
+            verifyLegacy(run(useDma, 0, sizes[s]), sizes[s]);
+            verifyFramed(run(useDma, 1, sizes[s]), sizes[s]);
+        }
+    }
+#ifdef UART_FIXED_PAYLOAD_SIZE
+    verifyOverruns(UART_FIXED_PAYLOAD_SIZE);
+#else
+    verifyOverruns(UART_PAYLOAD_8);
+#endif
+    return 0;
+}
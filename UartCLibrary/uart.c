@@ -8,24 +8,49 @@
 * Private Defines
 **********************************************************************************************************************/
 /**
-  * @brief A payload containing up to 32 bits of data and a 8-bit timestamp.
-  *
-  * The data field always occupies 32 bits in memory, but only the lower 8, 16, or 32 bits are used,
-  * based on the selected payload size. The timestamp is always 8 bits.
+  * @brief The protocol that data is stored and transmitted with, as requested by the host's commands.
   */
-typedef struct {
-    uint32_t data; // MAX size of data
-    uint8_t timestamp;
-}UART_TimestampedData;
+typedef enum {
+    UART_MODE_STOPPED = 0, // 'R', or no start command received yet
+    UART_MODE_LEGACY,      // 'S'
+    UART_MODE_FRAMED,      // 'F'
+} UART_Mode;
+
+// Framed protocol: sync + header + timestamp + CRC around the payloads of one store call.
+#define UART_FRAME_OVERHEAD (3 + UART_FRAME_TIMESTAMP_BYTES)
+// Status frame: sync + header + 32-bit value + CRC.
+#define UART_STATUS_FRAME_BYTES 7
+// Header of the status frame reporting the overrun count (payload size code 3, status type 0).
+#define UART_STATUS_OVERRUNS_HEADER 0x60
+
+#define UART_TX_BUFFER_MASK (UART_TX_BUFFER_SIZE - 1)
+
+#if UART_TX_BUFFER_SIZE < 256 || (UART_TX_BUFFER_SIZE & UART_TX_BUFFER_MASK) != 0
+#error "UART_TX_BUFFER_SIZE must be a power of two of at least 256 bytes"
+#endif
+#if UART_FRAME_TIMESTAMP_BYTES != 2 && UART_FRAME_TIMESTAMP_BYTES != 4
+#error "UART_FRAME_TIMESTAMP_BYTES must be 2 or 4"
+#endif
+
+// Bytes per stored value. A constant when the payload size is fixed at compile time,
+// which lets the compiler drop the handling of the other sizes.
+#ifdef UART_FIXED_PAYLOAD_SIZE
+#define PAYLOAD_BYTES ((uint32_t)(UART_FIXED_PAYLOAD_SIZE))
+#else
+#define PAYLOAD_BYTES ((uint32_t)uartPayloadSize)
+#endif
 
 /**********************************************************************************************************************
 * Private Variables
 **********************************************************************************************************************/
 
-// Internal transmit buffer
-static UART_TimestampedData uartTxBuffer[UART_TX_BUFFER_SIZE];  // Transmit buffer
-static uint16_t uartTxHead;  // Head of the transmit buffer (Data write position)
-static uint16_t uartTxTail;  // Tail of the transmit buffer (Data read position)
+// Internal transmit buffer, holding packets and frames in their wire format.
+// The head and tail are free-running byte counters, which are masked to index the buffer.
+// Only UART_StoreData (the producer) writes the head, and only the flush functions and the DMA completion
+// (the consumer) write the tail, so each side may run in an interrupt that preempts the other.
+static uint8_t uartTxBuffer[UART_TX_BUFFER_SIZE];  // Transmit buffer
+static volatile uint32_t uartTxHead;  // Head of the transmit buffer (Data write position)
+static volatile uint32_t uartTxTail;  // Tail of the transmit buffer (Data read position)
 
 // Pointer to the currently used UART instance, so we can access it and its flags after initialization.
 static USART_TypeDef *selectedUART = NULL;
@@ -37,25 +62,58 @@ static volatile uint32_t *timeValue = NULL;
 // Variable to store the payload size selected by the user during initialization.
 static UART_PayloadSize uartPayloadSize;
 
-// Flag to control transmission (off by default)
-static uint8_t uartTransmitEnabled = 0;
+// Protocol requested by the host's latest command. Commands are processed by the consumer, each one
+// increments the epoch. The producer adopts the new protocol on its next store, and the bytes stored
+// before that are discarded by the consumer, so that the buffer never mixes protocols.
+static volatile uint8_t uartRequestedMode = UART_MODE_STOPPED;
+static volatile uint32_t uartCommandEpoch;
+
+// Producer side: the protocol data is stored with, the command epoch it was adopted at,
+// and the head at that moment, where the bytes of that protocol start.
+static volatile uint8_t uartStoreMode = UART_MODE_STOPPED;
+static volatile uint32_t uartStoreEpoch;
+static volatile uint32_t uartStoreStart;
+
+// Consumer side: the protocol and epoch of the bytes being transmitted.
+static uint8_t uartFlushMode = UART_MODE_STOPPED;
+static uint32_t uartFlushEpoch;
+
+// Values which could not be stored because the buffer was full, and the count last reported to the host.
+static volatile uint32_t uartOverruns;
+static uint32_t uartOverrunsReported;
+
+// DMA stream used for transmission, or NULL when transmitting byte by byte (initialized via UART_Init).
+static DMA_TypeDef *selectedDMA = NULL;
+static uint32_t selectedDMAStream;
+
+// The DMA stream reads straight from the buffer, whose bytes are freed once the transfer completes.
+static volatile uint32_t uartDmaLength;    // Bytes of the transfer in flight, 0 when idle
+static volatile uint8_t uartDmaFlushAll;   // Whether transfer completion continues until the buffer is empty
+static volatile uint32_t uartDmaFlushUntil; // Otherwise, the tail position to transfer up to
 
 /**********************************************************************************************************************
 * Private Function Prototypes
 **********************************************************************************************************************/
 
 static int UART_ProcessCommand(void);
+static int UART_PrepareFlush(void);
+static uint32_t UART_UnitLength(uint32_t position);
+static uint32_t UART_PutByte(uint32_t position, uint8_t value, uint8_t *crc);
+static uint32_t UART_PutValue(uint32_t position, uint32_t value, uint32_t bytes, uint8_t *crc);
+static uint8_t UART_Crc8Update(uint8_t crc, uint8_t value);
+static void UART_DMA_Start(void);
+static void UART_DMA_Abort(void);
 
 /**********************************************************************************************************************
 * Private Macros
 **********************************************************************************************************************/
 //----- Circular buffer macros -----//
-// "Returns" the next index, taking buffer wrap-around into account.
-#define BUFFER_NEXT(index) (((index) + 1) % UART_TX_BUFFER_SIZE)
-// "Returns" whether head is caught up to tail, representing a full buffer.
-#define BUFFER_IS_FULL() (BUFFER_NEXT(uartTxHead) == uartTxTail)
-// "Returns" whether head and tail is on same position, representing empty buffer.
-#define BUFFER_IS_EMPTY() (uartTxHead == uartTxTail)
+// Publishing a new head or tail must not be reordered before the bytes it covers are written or read,
+// and loading the other side's index must happen before accessing the bytes it covers.
+#define RING_LOAD_ACQUIRE(index) __atomic_load_n(&(index), __ATOMIC_ACQUIRE)
+#define RING_STORE_RELEASE(index, value) __atomic_store_n(&(index), (value), __ATOMIC_RELEASE)
+// "Returns" the buffer byte at a free-running position, taking buffer wrap-around into account.
+#define BUFFER_AT(position) (uartTxBuffer[(position) & UART_TX_BUFFER_MASK])
 
 /**********************************************************************************************************************
 * API Function Definitions
@@ -68,6 +126,7 @@ static int UART_ProcessCommand(void);
  *         by a timer interrupt, at the desired resolution.
  * @param  payloadSize: The size of the data payload to be timestamped and transmitted.
  *         Valid options are UART_PAYLOAD_8 (uint8_t), UART_PAYLOAD_16 (uint16_t), or UART_PAYLOAD_32 (uint32_t).
+ *         Ignored if UART_FIXED_PAYLOAD_SIZE is defined.
  */
 void UART_Init(USART_TypeDef *USARTx, uint32_t *timestampHolder, UART_PayloadSize payloadSize) {
     // Store initialized values in state.
@@ -75,6 +134,12 @@ void UART_Init(USART_TypeDef *USARTx, uint32_t *timestampHolder, UART_PayloadSiz
     timeValue = timestampHolder;
     uartPayloadSize = payloadSize;
     uartTxHead = 0; uartTxTail = 0;
+    uartRequestedMode = UART_MODE_STOPPED; uartCommandEpoch = 0;
+    uartStoreMode = UART_MODE_STOPPED; uartStoreEpoch = 0; uartStoreStart = 0;
+    uartFlushMode = UART_MODE_STOPPED; uartFlushEpoch = 0;
+    uartOverruns = 0; uartOverrunsReported = 0;
+    selectedDMA = NULL; // Transmit byte by byte unless initialized via UART_InitDMA
+    uartDmaLength = 0; uartDmaFlushAll = 0; uartDmaFlushUntil = 0;
 
     // Enforce data-width = 8, and disabled parity
     LL_USART_SetDataWidth(USARTx, LL_USART_DATAWIDTH_8B);
@@ -88,25 +153,63 @@ void UART_Init(USART_TypeDef *USARTx, uint32_t *timestampHolder, UART_PayloadSiz
     LL_USART_Enable(USARTx);
 }
 
+/**
+ * @brief  Initializes the specified USART like UART_Init, but transmits through a DMA stream.
+ *
+ * Flushing then only hands buffered bytes to the DMA stream and returns immediately,
+ * rather than waiting for every byte to be transmitted.
+ * The stream's channel, priority and NVIC interrupt are expected to be configured already (e.g. via CubeMX),
+ * and its interrupt handler must clear the transfer complete flag and call UART_DMA_TxCompleteCallback().
+ *
+ * @param  USARTx: A pointer to the USART instance (e.g., USART3).
+ * @param  DMAx: The DMA controller of the USART's TX stream (e.g., DMA1).
+ * @param  stream: The USART's TX stream (e.g., LL_DMA_STREAM_3).
+ * @param  timestampHolder: A pointer to a variable that is periodically incremented
+ *         by a timer interrupt, at the desired resolution.
+ * @param  payloadSize: The size of the data payload to be timestamped and transmitted.
+ *         Valid options are UART_PAYLOAD_8 (uint8_t), UART_PAYLOAD_16 (uint16_t), or UART_PAYLOAD_32 (uint32_t).
+ *         Ignored if UART_FIXED_PAYLOAD_SIZE is defined.
+ */
+void UART_InitDMA(USART_TypeDef *USARTx, DMA_TypeDef *DMAx, uint32_t stream,
+                  uint32_t *timestampHolder, UART_PayloadSize payloadSize) {
+    UART_Init(USARTx, timestampHolder, payloadSize);
+
+    // Memory to USART data register, one byte at a time. The transfer length is set per transfer.
+    LL_DMA_DisableStream(DMAx, stream);
+    while(LL_DMA_IsEnabledStream(DMAx, stream)) { /* Wait for a previous transfer to be aborted */ }
+    LL_DMA_SetDataTransferDirection(DMAx, stream, LL_DMA_DIRECTION_MEMORY_TO_PERIPH);
+    LL_DMA_SetMemoryIncMode(DMAx, stream, LL_DMA_MEMORY_INCREMENT);
+    LL_DMA_SetPeriphIncMode(DMAx, stream, LL_DMA_PERIPH_NOINCREMENT);
+    LL_DMA_SetMemorySize(DMAx, stream, LL_DMA_MDATAALIGN_BYTE);
+    LL_DMA_SetPeriphSize(DMAx, stream, LL_DMA_PDATAALIGN_BYTE);
+    LL_DMA_SetPeriphAddress(DMAx, stream, LL_USART_DMA_GetRegAddr(USARTx));
+    LL_DMA_EnableIT_TC(DMAx, stream);
+    LL_USART_EnableDMAReq_TX(USARTx);
+
+    selectedDMA = DMAx;
+    selectedDMAStream = stream;
+}
+
 /**
  * @brief  Buffers one or more data values to be transmitted over the selected USART.
  *
  * Only the lower 8, 16, or 32 bits of each data variable is used depending on the selected
- * payload size during initialization. The lowest 8 bits of the timestamp at the time
- * will be accompanied with each value of data that is stored. The order of the pointers
- * in the array defines the order in which the timestamped data packets are added and
- * transmitted from the internal circular buffer.
+ * payload size during initialization. The timestamp at the time of the call accompanies
+ * every value stored, and the values are sent as one frame when the framed protocol is used.
+ * The order of the pointers in the array defines the order in which the timestamped data
+ * packets are added and transmitted from the internal circular buffer.
  *
  * @param  dataArray: Array of pointers to data values to be timestamped and stored.
  *         The lower bits are used according to the selected payload size.
  *         The referenced values are expected to adhere to the selected payload size.
- * @param  n: The number of data pointers in the array.
+ * @param  n: The number of data pointers in the array, at most UART_FRAME_MAX_VARIABLES.
  *
  * @return 1 if all data values were successfully added to the buffer, or 0
  *         if there isn’t enough room, initialization has not been performed, or transmission is disabled.
  */
- // It must be the case that only the data on uartTxHead is changed to maintain circular buffer characteristics:
- // * forall i :: (0 <= i < uartTxBuffer.Length && i != old(uartTxHead)) ==> uartTxBuffer[i] == old(uartTxBuffer[i]))
+ // Only the bytes from uartTxHead onwards are written, and the head is published after them, so the consumer
+ // never sees a partially stored packet or frame:
+ // * forall p :: (old(uartTxTail) <= p < old(uartTxHead)) ==> BUFFER_AT(p) == old(BUFFER_AT(p))
 int UART_StoreData(uint32_t *dataArray[], size_t n) {
     if(selectedUART == NULL){
         // Initialization not done, don't store data,
@@ -114,118 +217,139 @@ int UART_StoreData(uint32_t *dataArray[], size_t n) {
         return 0;
     }
 
-    // Process any incoming command before taking action
-    UART_ProcessCommand();
-    if(!uartTransmitEnabled){
+    // Adopt the protocol of the host's latest command, which was processed when flushing.
+    // The bytes stored before this point are discarded by the consumer.
+    uint32_t epoch = RING_LOAD_ACQUIRE(uartCommandEpoch);
+    if(epoch != uartStoreEpoch){
+        uartStoreMode = uartRequestedMode;
+        uartStoreStart = uartTxHead;
+        RING_STORE_RELEASE(uartStoreEpoch, epoch);
+    }
+
+    if(uartStoreMode == UART_MODE_STOPPED){
         // Stop storing data if stop signal command been given
         return 0;
     }
 
-    // Calculate number of available slots in the circular buffer
-    size_t freeSlots;
-    if(uartTxHead >= uartTxTail){
-        freeSlots = UART_TX_BUFFER_SIZE - (uartTxHead - uartTxTail) - 1;
-    } else {
-        freeSlots = uartTxTail - uartTxHead - 1;
+    if(n == 0 || n > UART_FRAME_MAX_VARIABLES){
+        // A store call becomes a single frame, which has a limited number of variables.
+        return 0;
     }
 
-    // Check if there's enough room to construct one packet per data variable.
-    if(freeSlots < n){
-        return 0; // Not enough room
+    // Bytes needed: a frame, or a packet per value with the legacy protocol.
+    uint8_t framed = (uartStoreMode == UART_MODE_FRAMED);
+    uint32_t length = framed ? UART_FRAME_OVERHEAD + n * PAYLOAD_BYTES : n * (PAYLOAD_BYTES + 1);
+
+    // Report new overruns to the host ahead of the next frame, if there's room for it as well.
+    uint32_t overruns = uartOverruns;
+    uint8_t reportOverruns = framed && overruns != uartOverrunsReported;
+    if(reportOverruns){
+        length += UART_STATUS_FRAME_BYTES;
     }
 
-    // Loop through each pointer in dataArray to create packets.
+    // Check if there's enough room for the bytes, or else drop the values.
+    uint32_t head = uartTxHead;
+    uint32_t freeBytes = UART_TX_BUFFER_SIZE - (head - RING_LOAD_ACQUIRE(uartTxTail));
+    if(freeBytes < length && reportOverruns){
+        // Store the data without the report, rather than dropping it.
+        length -= UART_STATUS_FRAME_BYTES;
+        reportOverruns = 0;
+    }
+    if(freeBytes < length){
+        uartOverruns = overruns + n; // Not enough room
+        return 0;
+    }
+
+    // All variables of a store call share one timestamp.
+    uint32_t timestamp = *timeValue;
+    uint8_t crc = 0;
+
+    if(reportOverruns){
+        head = UART_PutByte(head, UART_FRAME_SYNC, &crc);
+        head = UART_PutByte(head, UART_STATUS_OVERRUNS_HEADER, &crc);
+        head = UART_PutValue(head, overruns, 4, &crc);
+        head = UART_PutByte(head, crc, NULL);
+        uartOverrunsReported = overruns;
+        crc = 0;
+    }
+
+    if(framed){
+        uint8_t sizeCode = (PAYLOAD_BYTES == 1) ? 0 : (PAYLOAD_BYTES == 2) ? 1 : 2;
+        head = UART_PutByte(head, UART_FRAME_SYNC, &crc);
+        head = UART_PutByte(head, (uint8_t)((n - 1) | (sizeCode << 5) | ((UART_FRAME_TIMESTAMP_BYTES == 4) << 7)), &crc);
+        head = UART_PutValue(head, timestamp, UART_FRAME_TIMESTAMP_BYTES, &crc);
+    }
+
+    // Loop through each pointer in dataArray to add its value in wire format, masked to the payload size.
     for(size_t i = 0; i < n; i++) {
-        // Have dataToAdd point to the next free buffer slot
-        UART_TimestampedData *dataToAdd = &uartTxBuffer[uartTxHead];
-        uint32_t dataValue = *dataArray[i];
-
-        // Mask the data according to selected payload size
-        switch (uartPayloadSize) {
-            case UART_PAYLOAD_8:
-                dataToAdd->data = dataValue & 0xFF;
-                break;
-            case UART_PAYLOAD_16:
-                dataToAdd->data = dataValue & 0xFFFF;
-                break;
-            default: // UART_PAYLOAD_32, don't mask.
-                dataToAdd->data = dataValue;
-                break;
+        head = UART_PutValue(head, *dataArray[i], PAYLOAD_BYTES, &crc);
+        if(!framed){
+            // Use 8 bits of a provided "timestamp variable" per packet.
+            head = UART_PutByte(head, (uint8_t)(timestamp & 0xFF), NULL);
         }
+    }
 
-        // Use 8 bits of a provided "timestamp variable".
-        dataToAdd->timestamp = (uint8_t)(*timeValue & 0xFF);
-
-        // Data added, move head forward:
-        uartTxHead = BUFFER_NEXT(uartTxHead);
+    if(framed){
+        // The CRC covers the whole frame, including the sync byte.
+        head = UART_PutByte(head, crc, NULL);
     }
 
+    // Data added, publish the new head:
+    RING_STORE_RELEASE(uartTxHead, head);
+
     return 1; // Data added, return success.
 }
 
 /**
- * @brief Flushes a single UART_TimestampedData packet from the TX buffer.
+ * @brief Flushes the oldest unit from the TX buffer.
  *
- * This function transmits one data packet from the buffer.
- * The packet format is:
- *    (8, 16, or 32 bits of data) followed by (8 bits of timestamp).
+ * The buffer holds bytes in their wire format, and a unit is what the negotiated protocol sends at once:
+ * a frame (or status frame) with the framed protocol, or a single value's packet with the legacy protocol.
+ * Without DMA, the unit's bytes are written to the USART and the function blocks until they are transmitted.
  *
  * @return 1 if the transmission was successful, or 0 if there is nothing in the buffer, or transmission is disabled.
  */
 int UART_FlushOne(void) {
-    // Check if there's any data to send
-    if (BUFFER_IS_EMPTY() || selectedUART == NULL) {
-        // Buffer is empty or initialization not done
+    if (selectedUART == NULL) {
+        // Initialization not done
         return 0;
     }
 
     // Process any incoming command before taking action
-    UART_ProcessCommand();
-    if(!uartTransmitEnabled){
+    if(!UART_PrepareFlush()){
         // Stop flushing data if stop signal command been given
         return 0;
     }
 
-    // Get the next packet in line to send
-    UART_TimestampedData packet = uartTxBuffer[uartTxTail];
-    uint8_t bytesToTransmit[uartPayloadSize + 1]; // Max 4 bytes data + 1 bytes timestamp.
-    uint8_t byteCount;
-
-    // Pack data to send based on payload size
-    switch(uartPayloadSize){
-        case UART_PAYLOAD_8:
-            bytesToTransmit[0] = packet.data & 0xFF;
-            byteCount = 1;
-            break;
-        case UART_PAYLOAD_16:
-            bytesToTransmit[0] = (packet.data >> 8) & 0xFF;
-            bytesToTransmit[1] = packet.data & 0xFF;
-            byteCount = 2;
-            break;
-        default: // UART_PAYLOAD_32
-            bytesToTransmit[0] = (packet.data >> 24) & 0xFF;
-            bytesToTransmit[1] = (packet.data >> 16) & 0xFF;
-            bytesToTransmit[2] = (packet.data >> 8) & 0xFF;
-            bytesToTransmit[3] = packet.data & 0xFF;
-            byteCount = 4;
-            break;
-    }
-
-    // Add the least significant byte of the timestamp
-    bytesToTransmit[byteCount++] = packet.timestamp & 0xFF;
-
-    // Transmit all bytes for this packet
-    for(int i = 0; i < byteCount; i++){
+    // Check if there's any data to send
+    uint32_t tail = uartTxTail;
+    if (RING_LOAD_ACQUIRE(uartTxHead) == tail) {
+        return 0;
+    }
+
+    // Hand the unit to the DMA stream, its bytes are freed once transmitted.
+    if(selectedDMA != NULL){
+        if(uartDmaLength == 0){
+            uartDmaFlushAll = 0;
+            uartDmaFlushUntil = tail + UART_UnitLength(tail);
+            UART_DMA_Start();
+        }
+        return 1;
+    }
+
+    // Transmit all bytes for this packet (or frame)
+    uint32_t length = UART_UnitLength(tail);
+    for(uint32_t i = 0; i < length; i++){
         int timeout = 5000;
         while(!LL_USART_IsActiveFlag_TXE(selectedUART)) { if (timeout-- <= 0) return 0; }
-        LL_USART_TransmitData8(selectedUART, bytesToTransmit[i]);
+        LL_USART_TransmitData8(selectedUART, BUFFER_AT(tail + i));
     }
 
     // Wait until transmission is fully done.
     while (!LL_USART_IsActiveFlag_TC(selectedUART)) { /* Wait until transmission is done */ }
 
     // Move the tail forward for the next package
-    uartTxTail = BUFFER_NEXT(uartTxTail);
+    RING_STORE_RELEASE(uartTxTail, tail + length);
 
     return 1; // Data sent, return success.
 }
@@ -233,9 +357,8 @@ int UART_FlushOne(void) {
 /**
  * @brief  Flushes the internal TX buffer by sending all its data over the USART.
  *
- * This function transmits every buffered data packet.
- * Each packet's format is:
- *    (8, 16, or 32 bits of data) followed by (8 bits of timestamp).
+ * This function transmits every buffered unit, i.e. frames or legacy packets depending on the negotiated
+ * protocol, until the buffer is empty. Without DMA, it blocks until the last byte has been transmitted.
  *
  * @return 1 if transmission was successful, or 0 if there is nothing to send, or transmission is disabled.
  *
@@ -243,58 +366,49 @@ int UART_FlushOne(void) {
  *       but works the same way otherwise, except that it flushes the entire buffer.
  */
 int UART_FlushBuffer(void) {
+    if (selectedUART == NULL) {
+        // Initialization not done
+        return 0;
+    }
+
+    // Process any incoming command before taking action
+    if(!UART_PrepareFlush()){
+        return 0;
+    }
+
     // Check if there's any data to send
-    if (BUFFER_IS_EMPTY() || selectedUART == NULL) {
-        // Buffer is empty or initialization not done
+    if (RING_LOAD_ACQUIRE(uartTxHead) == uartTxTail) {
         return 0;
     }
 
+    // Hand the buffer to the DMA stream, its completion continues until the buffer is empty.
+    if(selectedDMA != NULL){
+        uartDmaFlushAll = 1;
+        UART_DMA_Start();
+        return 1;
+    }
+
     // Send data until buffer is empty
-    while(!BUFFER_IS_EMPTY()){
+    uint32_t tail = uartTxTail;
+    while(RING_LOAD_ACQUIRE(uartTxHead) != tail){
         // Process any incoming command before taking action
-        UART_ProcessCommand();
-        if(!uartTransmitEnabled){
+        if(!UART_PrepareFlush()){
             // Stop flush loop if stop signal command been given
             return 0;
         }
+        tail = uartTxTail; // A new command discards the buffer
 
-        // Get the next packet in line to send
-        UART_TimestampedData packet = uartTxBuffer[uartTxTail];
-        uint8_t bytesToTransmit[uartPayloadSize + 1]; // Max 4 bytes data + 1 bytes timestamp
-        uint8_t byteCount;
-
-        // Pack data to send based on payload size
-        switch (uartPayloadSize) {
-            case UART_PAYLOAD_8:
-                bytesToTransmit[0] = packet.data & 0xFF;
-                byteCount = 1;
-                break;
-            case UART_PAYLOAD_16:
-                bytesToTransmit[0] = (packet.data >> 8) & 0xFF;
-                bytesToTransmit[1] = packet.data & 0xFF;
-                byteCount = 2;
-                break;
-            default: // UART_PAYLOAD_32
-                bytesToTransmit[0] = (packet.data >> 24) & 0xFF;
-                bytesToTransmit[1] = (packet.data >> 16) & 0xFF;
-                bytesToTransmit[2] = (packet.data >> 8) & 0xFF;
-                bytesToTransmit[3] = packet.data & 0xFF;
-                byteCount = 4;
-                break;
-        }
-
-        // Add the least significant byte of the timestamp
-        bytesToTransmit[byteCount++] = packet.timestamp & 0xFF;
-
-        // Transmit all bytes for this packet
-        for (int i = 0; i < byteCount; i++) {
+        // Transmit all bytes for this packet (or frame)
+        uint32_t length = UART_UnitLength(tail);
+        for (uint32_t i = 0; i < length; i++) {
             int timeout = 5000;
             while(!LL_USART_IsActiveFlag_TXE(selectedUART)) { if (timeout-- <= 0) return 0; }
-            LL_USART_TransmitData8(selectedUART, bytesToTransmit[i]);
+            LL_USART_TransmitData8(selectedUART, BUFFER_AT(tail + i));
         }
 
         // Move the tail forward, so we can send the next package until the buffer is empty
-        uartTxTail = BUFFER_NEXT(uartTxTail);
+        tail += length;
+        RING_STORE_RELEASE(uartTxTail, tail);
     }
 
     // Wait until transmission is fully done.
@@ -303,6 +417,47 @@ int UART_FlushBuffer(void) {
     return 1; // Data sent, return success.
 }
 
+/**
+ * @brief  Checks whether a DMA transfer is still in progress.
+ *
+ * @return 1 if packets are being transmitted by the DMA stream, 0 if it is idle or DMA is not used.
+ */
+int UART_IsTransmitting(void) {
+    return uartDmaLength != 0;
+}
+
+/**
+ * @brief  Returns the number of values that could not be stored because the buffer was full.
+ *
+ * @return The number of values dropped since initialization.
+ */
+uint32_t UART_GetOverrunCount(void) {
+    return uartOverruns;
+}
+
+/**
+ * @brief  Completes a DMA transfer, to be called from the TX stream's interrupt handler.
+ *
+ * Frees the transmitted bytes from the buffer, and starts the next transfer if a flush is still ongoing.
+ * The transfer complete flag must be cleared by the caller.
+ */
+void UART_DMA_TxCompleteCallback(void) {
+    uint32_t length = uartDmaLength;
+    if(length == 0){
+        // Transfer was aborted by a command, its bytes are discarded anyway.
+        return;
+    }
+
+    // Free the transmitted bytes.
+    RING_STORE_RELEASE(uartTxTail, uartTxTail + length);
+    uartDmaLength = 0;
+
+    // Continue flushing, unless a command arrived meanwhile, which the next flush handles.
+    if(uartFlushEpoch == RING_LOAD_ACQUIRE(uartCommandEpoch)){
+        UART_DMA_Start();
+    }
+}
+
 /**********************************************************************************************************************
 * Private Function Definitions
 **********************************************************************************************************************/
@@ -311,9 +466,12 @@ int UART_FlushBuffer(void) {
  * @brief Checks for received commands and processes them.
  *
  * Commands:\n
- *   'S' - Start transmission (set uartTransmitEnabled to 1)\n
- *   'R' - Reset transmission (set uartTransmitEnabled to 0 to pause transmission, and reset head/tail tx-pointers)\n
+ *   'S' - Start transmission of legacy packets\n
+ *   'F' - Start transmission of frames\n
+ *   'R' - Reset transmission (stop, and discard the buffered data)\n
  *
+ * Every command also discards the data buffered before it, which is done by the consumer
+ * once the producer has adopted the command (see UART_PrepareFlush).
  * This function should be called before transmitting/flushing data.
  *
  * @returns 1 if a command was processed, 0 if there was no command to process.
@@ -327,21 +485,162 @@ static int UART_ProcessCommand(void){
 
         switch(commandByte){
             case 'S': // Start transmission!
-                uartTransmitEnabled = 1;
+                uartRequestedMode = UART_MODE_LEGACY;
                 break;
-            case 'R': // Reset transmission (stop + reset buffer pointers)
-                uartTransmitEnabled = 0;
-                uartTxHead = 0;
-                uartTxTail = 0;
+            case 'F': // Start transmission, framed.
+                uartRequestedMode = UART_MODE_FRAMED;
+                break;
+            case 'R': // Reset transmission (stop + discard buffer)
+                uartRequestedMode = UART_MODE_STOPPED;
                 break;
             default:
                 // Do nothing, invalid command received.
-                break;
+                return 1;
         }
 
+        // Published after the requested mode, for the producer to adopt both.
+        RING_STORE_RELEASE(uartCommandEpoch, uartCommandEpoch + 1);
+
         // Command was received and processed.
         return 1;
     }
     // No command was received
     return 0;
 }
+
+/**
+ * @brief Processes incoming commands, and catches up with the protocol the producer stores data with.
+ *
+ * Once the producer has adopted a command, the bytes stored before it are discarded, along with any
+ * transfer of them in progress. Until then, nothing is transmitted.
+ *
+ * @returns 1 if buffered data may be transmitted, 0 if transmission is disabled.
+ */
+static int UART_PrepareFlush(void){
+    UART_ProcessCommand();
+
+    uint32_t storeEpoch = RING_LOAD_ACQUIRE(uartStoreEpoch);
+    if(storeEpoch != uartFlushEpoch){
+        UART_DMA_Abort();
+        RING_STORE_RELEASE(uartTxTail, uartStoreStart);
+        uartFlushMode = uartStoreMode;
+        uartFlushEpoch = storeEpoch;
+    }
+
+    return uartFlushEpoch == RING_LOAD_ACQUIRE(uartCommandEpoch) && uartFlushMode != UART_MODE_STOPPED;
+}
+
+/**
+ * @brief Returns the length of the packet or frame starting at the given buffer position.
+ */
+static uint32_t UART_UnitLength(uint32_t position){
+    if(uartFlushMode != UART_MODE_FRAMED){
+        return PAYLOAD_BYTES + 1;
+    }
+
+    uint8_t header = BUFFER_AT(position + 1);
+    uint32_t sizeCode = (header >> 5) & 0x3;
+    if(sizeCode == 3){
+        return UART_STATUS_FRAME_BYTES;
+    }
+    return 3 + ((header & 0x80) ? 4 : 2) + ((header & 0x1F) + 1) * (1u << sizeCode);
+}
+
+/**
+ * @brief Writes a byte at the given buffer position, optionally adding it to a CRC.
+ *
+ * @returns The position following the byte.
+ */
+static uint32_t UART_PutByte(uint32_t position, uint8_t value, uint8_t *crc){
+    BUFFER_AT(position) = value;
+    if(crc != NULL){
+        *crc = UART_Crc8Update(*crc, value);
+    }
+    return position + 1;
+}
+
+/**
+ * @brief Writes the lowest bytes of a value at the given buffer position in big-endian order,
+ *        adding them to a CRC.
+ *
+ * @returns The position following the value.
+ */
+static uint32_t UART_PutValue(uint32_t position, uint32_t value, uint32_t bytes, uint8_t *crc){
+    switch(bytes){
+        case 4:
+            position = UART_PutByte(position, (value >> 24) & 0xFF, crc);
+            position = UART_PutByte(position, (value >> 16) & 0xFF, crc);
+            /* fall through */
+        case 2:
+            position = UART_PutByte(position, (value >> 8) & 0xFF, crc);
+            /* fall through */
+        default:
+            return UART_PutByte(position, value & 0xFF, crc);
+    }
+}
+
+/**
+ * @brief Adds a byte to a CRC-8 (polynomial 0x07, initial value 0).
+ *
+ * Processes a nibble at a time, which keeps the lookup table at 16 bytes.
+ */
+static uint8_t UART_Crc8Update(uint8_t crc, uint8_t value){
+    static const uint8_t nibbleTable[16] = {
+        0x00, 0x07, 0x0E, 0x09, 0x1C, 0x1B, 0x12, 0x15, 0x38, 0x3F, 0x36, 0x31, 0x24, 0x23, 0x2A, 0x2D
+    };
+
+    crc ^= value;
+    crc = (uint8_t)(crc << 4) ^ nibbleTable[crc >> 4];
+    crc = (uint8_t)(crc << 4) ^ nibbleTable[crc >> 4];
+    return crc;
+}
+
+/**
+ * @brief Starts a DMA transfer of the oldest buffered bytes, unless one is already in progress.
+ *
+ * Transfers up to the end of the buffer's memory (continuing from its start on the next transfer),
+ * and at most UART_DMA_MAX_BYTES at a time, so that space is freed regularly. The bytes stay in
+ * the buffer until the transfer completes, so the tail is only advanced by UART_DMA_TxCompleteCallback().
+ */
+static void UART_DMA_Start(void){
+    // Only the flush and the completion of a transfer start transfers, so nothing can start one meanwhile.
+    if(uartDmaLength != 0){
+        return;
+    }
+
+    uint32_t tail = uartTxTail;
+    uint32_t end = uartDmaFlushAll ? RING_LOAD_ACQUIRE(uartTxHead) : uartDmaFlushUntil;
+    uint32_t length = end - tail;
+    if(length == 0 || length > UART_TX_BUFFER_SIZE){
+        return; // Nothing (left) to transfer
+    }
+
+    uint32_t contiguous = UART_TX_BUFFER_SIZE - (tail & UART_TX_BUFFER_MASK);
+    if(length > contiguous){
+        length = contiguous;
+    }
+    if(length > UART_DMA_MAX_BYTES){
+        length = UART_DMA_MAX_BYTES;
+    }
+
+    uartDmaLength = length;
+    LL_DMA_SetMemoryAddress(selectedDMA, selectedDMAStream, (uintptr_t)&BUFFER_AT(tail));
+    LL_DMA_SetDataLength(selectedDMA, selectedDMAStream, length);
+    LL_USART_ClearFlag_TC(selectedUART);
+    LL_DMA_EnableStream(selectedDMA, selectedDMAStream);
+}
+
+/**
+ * @brief Stops a DMA transfer in progress, if any, without freeing its bytes.
+ */
+static void UART_DMA_Abort(void){
+    if(selectedDMA == NULL){
+        return;
+    }
+
+    // Cleared first, so that the completion raised by disabling the stream is ignored.
+    uartDmaFlushAll = 0;
+    uartDmaLength = 0;
+    LL_DMA_DisableStream(selectedDMA, selectedDMAStream);
+    while(LL_DMA_IsEnabledStream(selectedDMA, selectedDMAStream)) { /* Wait for the stream to stop */ }
+}
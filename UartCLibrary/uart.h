@@ -10,26 +10,51 @@
  *
  * The following functionality is provided:
  * - Initialization of USART peripherals for asynchronous communication.
- * - Storage of timestamped data packets to be transmitted over UART.
- * - Flushing of stored data either one packet at a time or all at once.
+ * - Storage of timestamped data values to be transmitted over UART, as frames or legacy packets.
+ * - Flushing of stored data either one frame (or packet) at a time or all at once.
+ * - Optionally, non-blocking transmission through a DMA stream (see UART_InitDMA).
  *
  * Supports flexible payload sizes to be set during initialization (8, 16, or 32 bits), and
  * can operate with a timestamp that is periodically incremented by a timer interrupt.
  *
  * The UART communication is set up to transmit data in a circular buffer.
- * It only starts transmitting over TX after receiving an 'S' byte in the Read Data Register,
- * and stops + resets the internal buffer on receiving an 'R' byte.
+ * It only starts transmitting over TX after receiving a start byte in the Read Data Register,
+ * and stops + resets the internal buffer on receiving an 'R' byte. The start byte selects the protocol:
  *
- * Notes:
- * - No alignment byte is sent between packages, and as such, data should not be stored
+ * - 'S' (legacy): every value is sent as its own packet, followed by the lowest 8 bits of its timestamp:
+ *       (8, 16, or 32 bits of data) (lowest 8 bits of timestamp)
+ *   No alignment byte is sent between packages, and as such, data should not be stored
  *   in different orders (as indicated by the pointer array) on sequential stores,
  *   and preferably not be done in multiple separate interrupt handlers at once.
  *
+ * - 'F' (framed): the values of each store call are sent as one frame, sharing one timestamp:
+ *       (sync 0xA5) (header) (16 or 32 bits of timestamp) (n x 8, 16, or 32 bits of data) (CRC-8)
+ *   The header holds the variable count minus one in bits 0-4, the payload size in bits 5-6
+ *   (0 = 8, 1 = 16, 2 = 32 bits) and whether the timestamp is 32 bits in bit 7. The CRC-8
+ *   (polynomial 0x07, initial value 0) covers every byte of the frame before it, so a receiver
+ *   can find the next frame again after a lost or corrupted byte.
+ *   Values of variable i are sent at position i of every frame, as given by the pointer array.
+ *   A header with payload size 3 marks a status frame instead, which holds a 32-bit value:
+ *       (sync 0xA5) (0x60) (32 bits of overrun count) (CRC-8)
+ *   It is sent ahead of the next frame whenever values have been dropped because the buffer was full,
+ *   and holds the total number of values dropped since initialization.
+ *
+ * Notes:
+ * - Multi-byte fields are sent in big-endian order.
+ *
+ * - Data is buffered in its wire format, so the buffer holds e.g. 512 8-bit legacy packets with the
+ *   default size. Storing may be done from one interrupt handler while flushing is done from the main
+ *   loop (or vice versa), without disabling interrupts, as long as each is done from a single context.
+ *   Commands are received when flushing, and take effect on the next store.
+ *
+ * - Defining UART_FIXED_PAYLOAD_SIZE (1, 2 or 4) fixes the payload size at compile time,
+ *   which makes storing and flushing faster. The payload size given at initialization is then ignored.
+ *
  * - When a payload size is set (16 bits, for example), every variable stored is expected to
  *   be at the set size or lower.
  *
  * - The timestamp is assumed to be provided by an external timer interrupt
- *   and is used to timestamp data packets before transmission.
+ *   and is used to timestamp stored values before transmission.
  **********************************************************************************************************************/
 
 /* Define to prevent recursive inclusion ----------------------------------------------------------------------------*/
@@ -43,6 +68,7 @@
 #include <stdint.h>
 #include <stddef.h>
 #include "stm32f4xx_ll_usart.h"
+#include "stm32f4xx_ll_dma.h"
 
 /**********************************************************************************************************************
 * Typedefs
@@ -57,10 +83,28 @@ typedef enum { // Defines valid lengths of the data to timestamp and transmit
 * Defines
 **********************************************************************************************************************/
 
-/* Define the size of the internal transmit buffer */
-#define UART_TX_BUFFER_SIZE 128
+/* Define the size of the internal transmit buffer in bytes (a power of two of at least 256) */
+#ifndef UART_TX_BUFFER_SIZE
+#define UART_TX_BUFFER_SIZE 1024
+#endif
 //#define UART_RX_BUFFER_SIZE 128 // If we ever want to read more complex commands (>1byte size). Currently not needed.
 
+/* Define the number of timestamp bytes sent in each frame of the framed protocol (2 or 4) */
+#ifndef UART_FRAME_TIMESTAMP_BYTES
+#define UART_FRAME_TIMESTAMP_BYTES 2
+#endif
+
+/* Define the first byte of every frame of the framed protocol */
+#define UART_FRAME_SYNC 0xA5
+
+/* Define the maximum number of values in a frame, and thereby per store call */
+#define UART_FRAME_MAX_VARIABLES 32
+
+/* Define the maximum number of bytes handed to the DMA stream in one transfer */
+#ifndef UART_DMA_MAX_BYTES
+#define UART_DMA_MAX_BYTES 256
+#endif
+
 /**********************************************************************************************************************
 * API Function Declarations
 **********************************************************************************************************************/
@@ -72,51 +116,108 @@ typedef enum { // Defines valid lengths of the data to timestamp and transmit
  *         by a timer interrupt, at the desired resolution.
  * @param  payloadSize: The size of the data payload to be timestamped and transmitted.
  *         Valid options are UART_PAYLOAD_8 (uint8_t), UART_PAYLOAD_16 (uint16_t), or UART_PAYLOAD_32 (uint32_t).
+ *         Ignored if UART_FIXED_PAYLOAD_SIZE is defined.
  */
 void UART_Init(USART_TypeDef *USARTx, uint32_t *timestampHolder, UART_PayloadSize payloadSize);
 
+/**
+ * @brief  Initializes the specified USART like UART_Init, but transmits through a DMA stream.
+ *
+ * Flushing then only hands buffered bytes to the DMA stream and returns immediately,
+ * rather than waiting for every byte to be transmitted.
+ * The stream's channel, priority and NVIC interrupt are expected to be configured already (e.g. via CubeMX),
+ * and its interrupt handler must clear the transfer complete flag and call UART_DMA_TxCompleteCallback().
+ *
+ * @param  USARTx: A pointer to the USART instance (e.g., USART3).
+ * @param  DMAx: The DMA controller of the USART's TX stream (e.g., DMA1).
+ * @param  stream: The USART's TX stream (e.g., LL_DMA_STREAM_3).
+ * @param  timestampHolder: A pointer to a variable that is periodically incremented
+ *         by a timer interrupt, at the desired resolution.
+ * @param  payloadSize: The size of the data payload to be timestamped and transmitted.
+ *         Valid options are UART_PAYLOAD_8 (uint8_t), UART_PAYLOAD_16 (uint16_t), or UART_PAYLOAD_32 (uint32_t).
+ *         Ignored if UART_FIXED_PAYLOAD_SIZE is defined.
+ */
+void UART_InitDMA(USART_TypeDef *USARTx, DMA_TypeDef *DMAx, uint32_t stream,
+                  uint32_t *timestampHolder, UART_PayloadSize payloadSize);
+
 /**
  * @brief  Buffers one or more data values to be transmitted over the selected USART.
  *
  * Only the lower 8, 16, or 32 bits of each data variable is used depending on the selected
- * payload size during initialization. The lowest 8 bits of the timestamp at the time
- * will be accompanied with each value of data that is stored. The order of the pointers
- * in the array defines the order in which the timestamped data packets are added and
- * transmitted from the internal circular buffer.
+ * payload size during initialization. The timestamp at the time of the call accompanies
+ * every value stored, and the values are sent as one frame when the framed protocol is used.
+ * The order of the pointers in the array defines the order in which the timestamped data
+ * packets are added and transmitted from the internal circular buffer.
  *
  * @param  dataArray: Array of pointers to data values to be timestamped and stored.
  *         The lower bits are used according to the selected payload size.
  *         The referenced values are expected to adhere to the selected payload size.
- * @param  n: The number of data pointers in the array.
+ * @param  n: The number of data pointers in the array, at most UART_FRAME_MAX_VARIABLES.
  *
  * @return 1 if all data values were successfully added to the buffer, or 0
  *         if there isn’t enough room, initialization has not been performed, or transmission is disabled.
+ *
+ * @note Values which are not stored because there isn't enough room are counted, see UART_GetOverrunCount.
  */
 int UART_StoreData(uint32_t *dataArray[], size_t n);
 
 /**
- * @brief Flushes a single UART_TimestampedData packet from the TX buffer.
+ * @brief Flushes the oldest unit from the TX buffer.
  *
- * This function transmits one data packet from the buffer.
- * The packet format is:
- *    (8, 16, or 32 bits of data) followed by (8 bits of timestamp).
+ * The buffer holds bytes in their wire format, and a unit is what the negotiated protocol sends at once:
+ * a frame (or status frame) with the framed protocol, or a single value's packet with the legacy protocol.
+ * Without DMA, the unit's bytes are written to the USART and the function blocks until they are transmitted.
  *
  * @return 1 if the transmission was successful, or 0 if there is nothing in the buffer, or transmission is disabled.
+ *
+ * @note When initialized with UART_InitDMA, the unit is handed to the DMA stream and the function returns
+ *       without waiting. 1 is then returned if a transfer was started or is already in progress.
  */
 int UART_FlushOne(void);
 
 /**
  * @brief  Flushes the internal TX buffer by sending all its data over the USART.
  *
- * This function transmits every buffered data packet.
- * Each packet's format is:
- *    (8, 16, or 32 bits of data) followed by (8 bits of timestamp).
+ * This function transmits every buffered unit, i.e. frames or legacy packets depending on the negotiated
+ * protocol, until the buffer is empty. Without DMA, it blocks until the last byte has been transmitted.
  *
  * @return 1 if transmission was successful, or 0 if there is nothing to send, or transmission is disabled.
  *
  * @note This implementation does not call UART_FlushOne() to avoid the overhead of repeated function calls,
  *       but works the same way otherwise, except that it flushes the entire buffer.
+ *
+ * @note When initialized with UART_InitDMA, the function returns without waiting. The buffer is sent in
+ *       transfers of up to UART_DMA_MAX_BYTES bytes, each started from the previous one's completion,
+ *       and packets stored meanwhile are sent as well. 1 is returned if a transfer was started or is in progress.
  */
 int UART_FlushBuffer(void);
 
+/**
+ * @brief  Checks whether a DMA transfer is still in progress.
+ *
+ * @return 1 if packets are being transmitted by the DMA stream, 0 if it is idle or DMA is not used.
+ */
+int UART_IsTransmitting(void);
+
+/**
+ * @brief  Returns the number of values that could not be stored because the buffer was full.
+ *
+ * @return The number of values dropped since initialization.
+ */
+uint32_t UART_GetOverrunCount(void);
+
+/**
+ * @brief  Completes a DMA transfer, to be called from the TX stream's interrupt handler.
+ *
+ * Frees the transmitted bytes from the buffer, and starts the next transfer if a flush is still ongoing. The transfer complete flag must be cleared by the caller, e.g.:
+ *
+ *     void DMA1_Stream3_IRQHandler(void) {
+ *         if (LL_DMA_IsActiveFlag_TC3(DMA1)) {
+ *             LL_DMA_ClearFlag_TC3(DMA1);
+ *             UART_DMA_TxCompleteCallback();
+ *         }
+ *     }
+ */
+void UART_DMA_TxCompleteCallback(void);
+
 #endif //__UART_H
\ No newline at end of file